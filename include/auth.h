@@ -12,8 +12,9 @@
 #ifndef AUTH_H
 #define AUTH_H
 
+#include "credential_table.h"
+#include <cstddef>
 #include <string>
-#include <unordered_map>
 
 /**
  * @brief Класс аутентификации клиентов
@@ -22,19 +23,39 @@
  * - генерация 64-битной соли в виде 16 hex символов
  * - вычисление MD5 хэша по схеме salt+password
  * - верификация клиентских учетных данных
+ * 
+ * Дайджест, его hex-запись и сравнение с hex-хэшем клиента - общие для
+ * Authenticator и Session и не выделяют память.
  */
 class Authenticator {
 public:
+    /**
+     * @brief Длина MD5-дайджеста в байтах
+     */
+    static const size_t kDigestLength = 16;
+    
+
     /**
      * @brief Генерирует 64-битную соль в виде 16 hex символов
      * 
-     * @return std::string 16-символьная hex строка соли
+     * @return std::string 16-символьная hex строка соли (uppercase)
      * 
-     * @note Использует случайные числа через std::random_device
+     * @note Использует random_bytes(): CSPRNG ядра с буфером на поток
      * @warning Соль должна быть уникальной для каждой сессии
      */
     static std::string generate_salt_16();
     
+    /**
+     * @brief Заполняет буфер криптостойкими случайными байтами
+     * 
+     * @param out Буфер
+     * @param length Количество байт
+     * 
+     * @note Потокобезопасен: у каждого потока свой буфер байт getrandom()
+     * @throw std::runtime_error если getrandom() недоступен
+     */
+    static void random_bytes(unsigned char* out, size_t length);
+    
     /**
      * @brief Вычисляет MD5 хэш от конкатенации соли и пароля
      * 
@@ -48,22 +69,66 @@ public:
     static std::string calculate_md5_hash(const std::string& salt, 
                                           const std::string& password);
     
+    /**
+     * @brief Вычисляет MD5(salt + password) без склейки строк
+     * 
+     * @param salt Соль
+     * @param password Пароль
+     * @param digest Буфер для kDigestLength байт дайджеста
+     */
+    static void md5_digest(const std::string& salt, const std::string& password,
+                           unsigned char* digest);
+    
+    /**
+     * @brief Вычисляет MD5(salt + password) для пароля из CredentialTable
+     * 
+     * @param salt Соль
+     * @param password Пароль
+     * @param password_length Длина пароля
+     * @param digest Буфер для kDigestLength байт дайджеста
+     */
+    static void md5_digest(const std::string& salt, const char* password, size_t password_length,
+                           unsigned char* digest);
+    
+    /**
+     * @brief Записывает байты в hex по таблице
+     * 
+     * @param data Байты
+     * @param length Количество байт
+     * @param out Буфер для 2 * length символов (без завершающего нуля)
+     * @param uppercase Регистр букв
+     */
+    static void hex_encode(const unsigned char* data, size_t length, char* out, bool uppercase = true);
+    
+    /**
+     * @brief Сравнивает hex-запись с дайджестом без учета регистра
+     * 
+     * @param digest Дайджест (kDigestLength байт)
+     * @param hex Hex-запись от клиента
+     * @return bool true если hex - запись этого дайджеста в любом регистре
+     * 
+     * @note Время сравнения не зависит от позиции первого расхождения
+     */
+    static bool digest_matches(const unsigned char* digest, const std::string& hex);
+    
     /**
      * @brief Проверяет аутентификационные данные клиента
      * 
      * @param login Логин клиента
      * @param received_hash Хэш, полученный от клиента
      * @param salt Соль, использованная при аутентификации
-     * @param clients База данных клиентов (логин -> пароль)
+     * @param clients База данных клиентов (логин -> пароль); словарь
+     *        std::unordered_map передается как CredentialTable(clients)
      * @return bool true если аутентификация успешна, иначе false
      * 
      * @note Сравнивает полученный хэш с вычисленным MD5(salt + stored_password)
+     *       без учета регистра hex-цифр
      * @throw Ничего не выбрасывает, возвращает false при ошибках
      */
     static bool verify_client(const std::string& login, 
                               const std::string& received_hash, 
                               const std::string& salt, 
-                              const std::unordered_map<std::string, std::string>& clients);
+                              const CredentialTable& clients);
 };
 
 #endif
@@ -0,0 +1,192 @@
+/**
+ * @file auth_batch.h
+ * @brief Пакетная проверка аутентификации многобуферным MD5
+ *
+ * Определяет:
+ * - Md5Batch - MD5 нескольких независимых сообщений одновременно: каждое
+ *   сообщение занимает свою 32-битную дорожку SIMD-регистра (SSE2 - 4,
+ *   AVX2 - 8, AVX-512F - 16 сообщений), и все 64 шага сжатия выполняются
+ *   над всеми дорожками сразу;
+ * - AuthBatcher - стадию проверки, которая собирает ожидающие проверки
+ *   сессий одного событийного цикла и проверяет их одним пакетом, когда
+ *   пакет заполнен или истек срок ожидания самой старой проверки.
+ *
+ * При массовом переподключении клиентов (например, после перезапуска
+ * сервера) MD5 на каждое подключение становится узким местом; пакет
+ * из 8-16 хэшей стоит немногим дороже одного.
+ *
+ * @see auth_batch.cpp
+ */
+
+#ifndef AUTH_BATCH_H
+#define AUTH_BATCH_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Сообщение для Md5Batch: MD5(salt + password)
+ */
+struct Md5Input {
+    const std::string* salt;      ///< Соль (первая часть сообщения)
+    const char* password;         ///< Пароль (вторая часть сообщения)
+    size_t password_length;       ///< Длина пароля
+};
+
+/**
+ * @brief Многобуферный MD5
+ *
+ * @code
+ * std::vector<Md5Input> inputs = ...;
+ * std::vector<unsigned char> digests(inputs.size() * 16);
+ * Md5Batch::digest(inputs.data(), inputs.size(), digests.data());
+ * @endcode
+ *
+ * @note Сообщения могут быть любой длины: сообщения из разного числа
+ *       блоков обрабатываются в одном пакете, дайджест каждой дорожки
+ *       снимается после ее последнего блока
+ */
+class Md5Batch {
+public:
+    /**
+     * @brief Максимальная ширина пакета
+     */
+    static const size_t kMaxLanes = 16;
+
+    /**
+     * @brief Ширина пакета, поддерживаемая процессором
+     *
+     * @return size_t 16 (AVX-512F), 8 (AVX2), 4 (SSE2) или 1
+     */
+    static size_t lanes();
+
+    /**
+     * @brief Вычисляет дайджесты сообщений
+     *
+     * @param inputs Сообщения
+     * @param count Количество сообщений
+     * @param digests Буфер для count * 16 байт дайджестов
+     * @param lanes Ширина пакета: 1 (OpenSSL по одному сообщению), 4, 8, 16;
+     *        0 - lanes(). Неподдерживаемая процессором ширина уменьшается
+     */
+    static void digest(const Md5Input* inputs, size_t count, unsigned char* digests, size_t lanes = 0);
+};
+
+/**
+ * @brief Пакетная проверка учетных данных для одного событийного цикла
+ *
+ * Сессия вместо немедленной проверки ставит ее в очередь (submit()) и
+ * приостанавливает разбор протокола. Цикл ждет событий не дольше
+ * timeout_ms(), а после обработки событий, если пакет готов (due()),
+ * проверяет его (flush()) и возобновляет сессии с результатами.
+ *
+ * @code
+ * int ready = loop.wait(events, max_events, batcher.timeout_ms());
+ * // ... обработка событий, сессии вызывают submit()
+ * if (batcher.due()) {
+ *     for (const AuthBatcher::Result& result : batcher.flush()) {
+ *         // возобновление сессии result.client
+ *     }
+ * }
+ * @endcode
+ *
+ * @warning Не потокобезопасен: принадлежит одному событийному циклу
+ */
+class AuthBatcher {
+public:
+    /**
+     * @brief Результат проверки
+     */
+    struct Result {
+        int client;      ///< Сокет сессии
+        bool success;    ///< Хэш клиента совпал с MD5(salt + password)
+    };
+
+private:
+    /**
+     * @brief Ожидающая проверка
+     *
+     * @note Строки принадлежат сессии и базе клиентов и живут, пока
+     *       проверка не выполнена или не отменена
+     */
+    struct Request {
+        int client;                   ///< Сокет сессии
+        const std::string* hash;      ///< Хэш от клиента
+    };
+
+    size_t batch_;                                     ///< Размер пакета
+    std::chrono::microseconds deadline_;               ///< Максимальное ожидание проверки
+    std::chrono::steady_clock::time_point oldest_;     ///< Время постановки самой старой проверки
+    std::vector<Request> pending_;                     ///< Ожидающие проверки
+    std::vector<Md5Input> inputs_;                     ///< Сообщения ожидающих проверок
+    std::vector<unsigned char> digests_;               ///< Дайджесты пакета
+    std::vector<Result> results_;                      ///< Результаты последнего flush()
+    uint64_t batches_;                                 ///< Выполнено пакетов
+    uint64_t verified_;                                ///< Выполнено проверок
+
+public:
+    /**
+     * @brief Конструктор
+     *
+     * @param deadline Максимальное время ожидания проверки в очереди
+     * @param batch Размер пакета (0 - Md5Batch::lanes())
+     */
+    explicit AuthBatcher(std::chrono::microseconds deadline, size_t batch = 0);
+
+    /**
+     * @brief Ставит проверку в очередь
+     *
+     * @param client Сокет сессии (по нему возвращается результат)
+     * @param salt Соль
+     * @param password Пароль из базы клиентов
+     * @param password_length Длина пароля
+     * @param hash Хэш от клиента (32 hex символа в любом регистре)
+     */
+    void submit(int client, const std::string& salt, const char* password, size_t password_length,
+                const std::string& hash);
+    
+    /**
+     * @brief Ставит проверку в очередь
+     */
+    void submit(int client, const std::string& salt, const std::string& password, const std::string& hash) {
+        submit(client, salt, password.data(), password.size(), hash);
+    }
+
+    /**
+     * @brief Отменяет проверку закрываемой сессии
+     *
+     * @param client Сокет сессии
+     */
+    void cancel(int client);
+
+    /**
+     * @brief Таймаут ожидания событий для цикла
+     *
+     * @return int -1 если очередь пуста, иначе миллисекунды до истечения
+     *         срока самой старой проверки (с округлением вверх)
+     */
+    int timeout_ms() const;
+
+    /**
+     * @brief Пора ли выполнять проверку: пакет заполнен или срок истек
+     */
+    bool due() const;
+
+    /**
+     * @brief Проверяет все ожидающие запросы
+     *
+     * @return const std::vector<Result>& Результаты в порядке постановки
+     *         (действительны до следующего вызова flush())
+     */
+    const std::vector<Result>& flush();
+
+    size_t pending() const { return pending_.size(); }   ///< Ожидающих проверок
+    size_t batch() const { return batch_; }               ///< Размер пакета
+    uint64_t batches() const { return batches_; }         ///< Выполнено пакетов
+    uint64_t verified() const { return verified_; }       ///< Выполнено проверок
+};
+
+#endif // AUTH_BATCH_H
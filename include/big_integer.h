@@ -0,0 +1,151 @@
+/**
+ * @file big_integer.h
+ * @brief Целые произвольной точности для точного произведения
+ *
+ * Определяет класс BigInteger (знак и модуль из 64-битных слов) и
+ * ExactProductAccumulator - потоковое точное произведение элементов
+ * по дереву произведений:
+ * - элементы упаковываются в 64-битные листья, пока их произведение
+ *   помещается в слово;
+ * - листья попарно перемножаются как в двоичном счетчике: на стеке
+ *   хранятся частичные произведения, и два произведения одного уровня
+ *   сразу объединяются. Поэтому сомножители всегда близки по длине,
+ *   а память пропорциональна длине результата;
+ * - длинные сомножители перемножаются алгоритмом Карацубы.
+ *
+ * @see big_integer.cpp
+ */
+
+#ifndef BIG_INTEGER_H
+#define BIG_INTEGER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Целое произвольной точности
+ *
+ * @note Поддерживается только то, что нужно точному произведению:
+ *       умножение, сравнение, десятичная запись и двоичное кодирование
+ */
+class BigInteger {
+public:
+    typedef std::vector<uint64_t> Limbs;   ///< Модуль, младшие слова первыми
+
+private:
+    Limbs limbs_;      ///< Модуль без старших нулевых слов (пусто для 0)
+    bool negative_;    ///< Знак (для 0 всегда false)
+
+    void normalize();  ///< Убирает старшие нулевые слова
+
+public:
+    /**
+     * @brief Ноль
+     */
+    BigInteger() : negative_(false) {}
+
+    /**
+     * @brief Значение 64-битного целого
+     */
+    explicit BigInteger(int64_t value);
+
+    /**
+     * @brief Число по модулю и знаку
+     *
+     * @param limbs Модуль, младшие слова первыми (старшие нули допустимы)
+     * @param negative Знак
+     */
+    BigInteger(Limbs limbs, bool negative);
+
+    bool is_zero() const { return limbs_.empty(); }           ///< Равно ли нулю
+    bool negative() const { return negative_; }               ///< Отрицательно ли
+    const Limbs& limbs() const { return limbs_; }             ///< Слова модуля
+    size_t bit_length() const;                                ///< Битовая длина модуля (0 для нуля)
+
+    /**
+     * @brief Произведение
+     *
+     * @details
+     * Сомножители короче kKaratsubaThreshold слов перемножаются в столбик,
+     * длиннее - алгоритмом Карацубы; сильно неравные по длине - частями
+     * длины меньшего сомножителя.
+     */
+    friend BigInteger operator*(const BigInteger& a, const BigInteger& b);
+
+    bool operator==(const BigInteger& other) const {
+        return negative_ == other.negative_ && limbs_ == other.limbs_;
+    }
+    bool operator!=(const BigInteger& other) const { return !(*this == other); }
+
+    /**
+     * @brief Десятичная запись
+     *
+     * @note Квадратична по длине: для логов и тестов, не для горячего пути
+     */
+    std::string to_string() const;
+
+    /**
+     * @brief Дописывает число в формате протокола
+     *
+     * @param out Буфер вывода
+     *
+     * @details
+     * [размер:int32][модуль: |размер| байт, младшие первыми]. Знак размера -
+     * знак числа, у нуля размер 0. Порядок байт машинный, как и у
+     * остальных чисел протокола.
+     *
+     * @throw std::runtime_error если модуль длиннее INT32_MAX байт
+     *        (размер не помещается в поле int32)
+     */
+    void encode(std::string& out) const;
+
+    /**
+     * @brief Порог алгоритма Карацубы в 64-битных словах
+     */
+    static const size_t kKaratsubaThreshold = 32;
+};
+
+/**
+ * @brief Точное произведение потока целых элементов
+ *
+ * @tparam T int32_t или int64_t
+ *
+ * @code
+ * ExactProductAccumulator<int32_t> acc;
+ * acc.add(chunk1, count1);
+ * acc.add(chunk2, count2);
+ * BigInteger product = acc.result();
+ * @endcode
+ *
+ * @note Для пустой последовательности результат 0, как и у остальных операций
+ */
+template <typename T>
+class ExactProductAccumulator {
+private:
+    /**
+     * @brief Частичное произведение на стеке дерева
+     */
+    struct Node {
+        BigInteger::Limbs limbs;  ///< Модуль
+        unsigned level;           ///< Сколько попарных объединений в нем
+    };
+
+    std::vector<Node> stack_;     ///< Уровни строго убывают от дна к вершине
+    uint64_t leaf_;               ///< Текущий лист
+    bool negative_;               ///< Нечетное количество отрицательных элементов
+    bool zero_;                   ///< Встретился 0
+    bool empty_;                  ///< Элементов еще не было
+
+    void push(BigInteger::Limbs limbs);  ///< Добавляет лист и объединяет равные уровни
+
+public:
+    ExactProductAccumulator() : leaf_(1), negative_(false), zero_(false), empty_(true) {}
+
+    void add(const char* data, size_t count);  ///< Добавляет элементы (без выравнивания)
+    bool decided() const { return zero_; }     ///< Результат окончателен (встретился 0)
+    BigInteger result() const;                 ///< Точное произведение
+};
+
+#endif // BIG_INTEGER_H
@@ -0,0 +1,96 @@
+/**
+ * @file bounded_queue.h
+ * @brief Потокобезопасная очередь ограниченной емкости
+ *
+ * Определяет шаблон BoundedQueue, через который поток приема подключений
+ * передает клиентские сокеты рабочим потокам. Ограничение емкости дает
+ * обратное давление: при перегрузке рабочих потоков прием новых
+ * подключений притормаживается, а не копится в памяти без границ.
+ */
+
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+/**
+ * @brief Очередь FIFO ограниченной емкости
+ *
+ * @tparam T Тип элементов очереди
+ *
+ * @note Все методы потокобезопасны
+ */
+template <typename T>
+class BoundedQueue {
+private:
+    std::deque<T> items_;              ///< Элементы очереди
+    size_t capacity_;                  ///< Максимальное количество элементов
+    mutable std::mutex mutex_;         ///< Защищает items_
+    std::condition_variable not_full_; ///< Сигнал освобождения места
+
+public:
+    /**
+     * @brief Конструктор очереди
+     *
+     * @param capacity Максимальное количество элементов (не меньше 1)
+     */
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {}
+
+    /**
+     * @brief Добавляет элемент, ожидая освобождения места
+     *
+     * @param item Элемент
+     */
+    void push(const T& item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this] { return items_.size() < capacity_; });
+        items_.push_back(item);
+    }
+
+    /**
+     * @brief Добавляет элемент без ожидания
+     *
+     * @param item Элемент
+     * @return bool false если очередь заполнена
+     */
+    bool try_push(const T& item) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (items_.size() >= capacity_) {
+            return false;
+        }
+        items_.push_back(item);
+        return true;
+    }
+
+    /**
+     * @brief Извлекает элемент без ожидания
+     *
+     * @param item Сюда записывается извлеченный элемент
+     * @return bool false если очередь пуста
+     */
+    bool try_pop(T& item) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (items_.empty()) {
+                return false;
+            }
+            item = items_.front();
+            items_.pop_front();
+        }
+        not_full_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Возвращает текущее количество элементов
+     */
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+};
+
+#endif // BOUNDED_QUEUE_H
@@ -0,0 +1,95 @@
+/**
+ * @file byte_buffer.h
+ * @brief Буфер приема без лишних копирований
+ *
+ * Определяет класс ByteBuffer - непрерывный буфер байт с позициями чтения
+ * и записи. recv() пишет прямо в свободный хвост буфера (prepare()/commit()),
+ * разбор читает данные на месте (data()/size()) и отмечает разобранное
+ * через consume(), которое только сдвигает позицию чтения.
+ *
+ * Данные переносятся в начало буфера лишь тогда, когда в хвосте не хватает
+ * места, и переносится при этом только неразобранный остаток, поэтому
+ * прием больших векторов не превращается в квадратичное число копирований,
+ * как при std::string::erase(0, n) на каждом поле.
+ *
+ * @see byte_buffer.cpp
+ */
+
+#ifndef BYTE_BUFFER_H
+#define BYTE_BUFFER_H
+
+#include <cstddef>
+#include <memory>
+
+/**
+ * @brief Непрерывный буфер с позициями чтения и записи
+ *
+ * @warning Указатели, полученные от data() и prepare(), действительны только
+ *          до следующего вызова prepare() или append()
+ */
+class ByteBuffer {
+private:
+    std::unique_ptr<char[]> storage_;  ///< Память буфера
+    size_t capacity_;                  ///< Размер памяти
+    size_t begin_;                     ///< Позиция чтения
+    size_t end_;                       ///< Позиция записи
+
+    ByteBuffer(const ByteBuffer&);                ///< Копирование запрещено
+    ByteBuffer& operator=(const ByteBuffer&);     ///< Присваивание запрещено
+
+public:
+    /**
+     * @brief Создает пустой буфер (память выделяется при первой записи)
+     */
+    ByteBuffer();
+
+    const char* data() const { return storage_.get() + begin_; } ///< Неразобранные данные
+    size_t size() const { return end_ - begin_; }                ///< Количество неразобранных байт
+    bool empty() const { return begin_ == end_; }                ///< Нет неразобранных данных
+    size_t writable() const { return capacity_ - end_; }         ///< Свободное место в хвосте
+
+    /**
+     * @brief Обеспечивает не меньше length свободных байт в хвосте
+     *
+     * @param length Требуемое свободное место
+     * @return char* Начало свободного места (для recv())
+     *
+     * @details
+     * Если места не хватает, сначала переносит неразобранные данные в начало
+     * буфера, а если и этого мало - выделяет память большего размера
+     * (не менее чем вдвое).
+     */
+    char* prepare(size_t length);
+
+    /**
+     * @brief Отмечает length байт, записанных после prepare(), как принятые
+     *
+     * @param length Количество записанных байт (не больше writable())
+     */
+    void commit(size_t length) { end_ += length; }
+
+    /**
+     * @brief Дописывает данные в конец буфера
+     *
+     * @param data Данные
+     * @param length Количество байт
+     */
+    void append(const char* data, size_t length);
+
+    /**
+     * @brief Отбрасывает length разобранных байт из начала
+     *
+     * @param length Количество байт (не больше size())
+     *
+     * @note Когда буфер опустошается, позиции сбрасываются в начало, а память
+     *       большого буфера (после приема крупного вектора) освобождается
+     */
+    void consume(size_t length);
+
+    /**
+     * @brief Отбрасывает все данные
+     */
+    void clear();
+};
+
+#endif // BYTE_BUFFER_H
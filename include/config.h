@@ -9,6 +9,13 @@
  * - порт сервера
  * - файл базы данных клиентов
  * - файл логов
+ * - количество рабочих потоков
+ * - количество шардов SO_REUSEPORT
+ * - транспорт ввода-вывода (epoll или io_uring)
+ * - вычислительное ядро произведения
+ * - кэш результатов (объем и размещение)
+ * - пакетная проверка аутентификации
+ * - источник соли (клиент или сервер)
  * 
  * @see config.cpp
  */
@@ -16,6 +23,7 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include <cstddef>
 #include <string>
 
 /**
@@ -25,6 +33,7 @@
  * - путь к файлу базы данных клиентов
  * - путь к файлу логов
  * - порт для прослушивания подключений
+ * - количество рабочих потоков для обслуживания сессий
  * 
  * @note Все поля имеют значения по умолчанию
  */
@@ -32,6 +41,14 @@ struct ServerConfig {
     std::string client_db_file = "/etc/vealc.conf"; ///< Файл базы данных клиентов
     std::string log_file = "/var/log/vealc.log";    ///< Файл логов сервера
     int port = 33333;                               ///< Порт сервера (по умолчанию 33333)
+    int threads = 0;                                ///< Рабочие потоки (0 - все в основном потоке)
+    int shards = 0;                                 ///< Шарды SO_REUSEPORT (0 - режим выключен)
+    std::string io_backend = "epoll";              ///< Транспорт ввода-вывода: epoll или uring
+    std::string kernel = "auto";                    ///< Ядро произведения (auto - по возможностям CPU)
+    size_t cache_mb = 0;                            ///< Объем кэша результатов в МБ (0 - кэш выключен)
+    std::string cache_placement = "worker";         ///< Размещение кэша: worker или global
+    int auth_batch_us = 0;                          ///< Срок пакетной проверки MD5 в мкс (0 - выключена)
+    std::string salt_source = "client";             ///< Кто выбирает соль: client или server (вызов-ответ)
     
     /**
      * @brief Парсит аргументы командной строки
@@ -46,6 +63,17 @@ struct ServerConfig {
      * -p PORT         Установить порт сервера
      * -c, -d FILE     Указать файл конфигурации клиентов
      * -l FILE         Указать файл логов
+     * -t THREADS      Количество рабочих потоков
+     * -s SHARDS       Количество шардов SO_REUSEPORT (имеет приоритет над -t)
+     * -b BACKEND      Транспорт ввода-вывода: epoll или uring
+     * -k KERNEL       Ядро произведения: auto, scalar, unrolled, simd, avx2, avx512
+     *                 (simd и avx* - если поддерживаются процессором)
+     * -r MB           Объем кэша результатов (0 - выключен)
+     * -R PLACEMENT    Размещение кэша: worker (свой у потока) или global (общий)
+     * -a USEC         Срок пакетной проверки аутентификации (0 - выключена;
+     *                 только транспорт epoll)
+     * -S SOURCE       Источник соли: client (в запросе клиента) или server
+     *                 (сервер выдает соль при подключении)
      * 
      * @throw std::invalid_argument при неверном формате аргументов
      */
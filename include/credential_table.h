@@ -0,0 +1,138 @@
+/**
+ * @file credential_table.h
+ * @brief Компактная таблица учетных данных клиентов
+ *
+ * Определяет класс CredentialTable - хэш-таблицу логин -> пароль с
+ * открытой адресацией, рассчитанную на миллионы записей:
+ * - логины и пароли лежат подряд в одной строке-арене, без отдельной
+ *   строки в куче на каждое значение;
+ * - слот таблицы - 8 байт (тег хэша логина и смещение записи), в одной
+ *   строке кэша 8 слотов; линейное пробирование обычно заканчивается
+ *   в той же строке, а арена читается только при совпадении тега;
+ * - после загрузки таблица только читается и разделяется потоками
+ *   без блокировок.
+ *
+ * @see credential_table.cpp
+ */
+
+#ifndef CREDENTIAL_TABLE_H
+#define CREDENTIAL_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Таблица учетных данных (логин -> пароль)
+ *
+ * @code
+ * CredentialTable clients;
+ * clients.insert("user", "P@ssW0rd");
+ * CredentialTable::View password;
+ * if (clients.find("user", password)) {
+ *     Authenticator::md5_digest(salt, password.data, password.size, digest);
+ * }
+ * @endcode
+ *
+ * @note Повторная вставка логина заменяет пароль, как operator[] у
+ *       std::unordered_map (старая запись остается в арене)
+ * @warning Не потокобезопасна для вставки: заполняется до запуска
+ *          обслуживающих потоков. Ссылки View действительны до следующей вставки
+ */
+class CredentialTable {
+public:
+    /**
+     * @brief Пароль внутри арены (без завершающего нуля)
+     */
+    struct View {
+        const char* data;   ///< Начало
+        size_t size;        ///< Длина в байтах
+
+        std::string to_string() const { return std::string(data, size); }  ///< Копия для логов
+    };
+
+    /**
+     * @brief Максимальная длина логина и пароля в байтах
+     */
+    static const size_t kMaxLength = 65535;
+
+private:
+    /**
+     * @brief Слот таблицы
+     *
+     * @note tag == 0 - пустой слот (у занятого младший бит тега всегда 1)
+     */
+    struct Slot {
+        uint32_t tag;       ///< Старшие биты хэша логина
+        uint32_t offset;    ///< Смещение записи в арене
+    };
+
+    std::vector<char> arena_;   ///< Записи [длина логина:u16][длина пароля:u16][логин][пароль]
+    std::vector<Slot> slots_;   ///< Слоты, размер - степень двойки
+    size_t size_;               ///< Количество логинов
+
+    size_t locate(const char* login, size_t length, uint64_t hash) const;  ///< Слот логина или пустой слот
+    void grow();                                                             ///< Удваивает таблицу
+
+public:
+    /**
+     * @brief Пустая таблица
+     */
+    CredentialTable();
+
+    /**
+     * @brief Таблица из словаря логин -> пароль
+     *
+     * @param clients Словарь
+     *
+     * @note Явный: Session, Worker и UringLoop хранят ссылку на таблицу,
+     *       и неявное преобразование словаря оставило бы ссылку на
+     *       временный объект
+     */
+    explicit CredentialTable(const std::unordered_map<std::string, std::string>& clients);
+
+    /**
+     * @brief Добавляет или заменяет запись
+     *
+     * @param login Логин
+     * @param login_length Длина логина
+     * @param password Пароль
+     * @param password_length Длина пароля
+     *
+     * @throw std::invalid_argument если логин или пароль длиннее kMaxLength
+     * @throw std::length_error если арена превысила бы 4 ГБ
+     */
+    void insert(const char* login, size_t login_length, const char* password, size_t password_length);
+
+    /**
+     * @brief Добавляет или заменяет запись
+     */
+    void insert(const std::string& login, const std::string& password) {
+        insert(login.data(), login.size(), password.data(), password.size());
+    }
+
+    /**
+     * @brief Ищет пароль по логину
+     *
+     * @param login Логин
+     * @param password Пароль, если логин найден
+     * @return bool true если логин есть в таблице
+     */
+    bool find(const std::string& login, View& password) const;
+
+    /**
+     * @brief Освобождает запас памяти арены после загрузки
+     */
+    void shrink_to_fit() { arena_.shrink_to_fit(); }
+
+    size_t size() const { return size_; }   ///< Количество логинов
+
+    /**
+     * @brief Память таблицы в байтах (арена и слоты)
+     */
+    size_t memory_bytes() const;
+};
+
+#endif // CREDENTIAL_TABLE_H
@@ -0,0 +1,89 @@
+/**
+ * @file event_loop.h
+ * @brief Обертка над epoll для событийного цикла сервера
+ *
+ * Определяет класс EventLoop - тонкую обертку над epoll(7), через которую
+ * сервер ожидает готовности слушающего сокета и клиентских сокетов.
+ * Диспетчеризация событий выполняется владельцем цикла (см. Server).
+ *
+ * @note Дескрипторы регистрируются в режиме edge-triggered (EPOLLET),
+ *       поэтому обработчик обязан вычитывать/записывать до EAGAIN
+ * @see event_loop.cpp
+ */
+
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <cstdint>
+#include <sys/epoll.h>
+
+/**
+ * @brief Событийный цикл на основе epoll
+ *
+ * Хранит дескриптор epoll и предоставляет методы регистрации
+ * дескрипторов и ожидания событий. Не владеет зарегистрированными
+ * дескрипторами - их закрытие остается на вызывающей стороне.
+ *
+ * @warning Класс не является потокобезопасным
+ */
+class EventLoop {
+private:
+    int epoll_fd_;                                   ///< Дескриптор epoll
+
+    EventLoop(const EventLoop&);                     ///< Копирование запрещено
+    EventLoop& operator=(const EventLoop&);          ///< Присваивание запрещено
+
+public:
+    /**
+     * @brief Создает экземпляр epoll
+     *
+     * @throw std::runtime_error если epoll_create1() завершился ошибкой
+     */
+    EventLoop();
+
+    /**
+     * @brief Закрывает дескриптор epoll
+     */
+    ~EventLoop();
+
+    /**
+     * @brief Регистрирует дескриптор в цикле
+     *
+     * @param fd Дескриптор
+     * @param events Маска событий (EPOLLIN, EPOLLOUT, EPOLLET, ...)
+     *
+     * @throw std::runtime_error при ошибке epoll_ctl()
+     */
+    void add(int fd, uint32_t events);
+
+    /**
+     * @brief Удаляет дескриптор из цикла
+     *
+     * @param fd Дескриптор
+     *
+     * @note Ошибки игнорируются - дескриптор мог быть уже закрыт
+     */
+    void remove(int fd);
+
+    /**
+     * @brief Ожидает готовности зарегистрированных дескрипторов
+     *
+     * @param events Массив для записи готовых событий
+     * @param max_events Размер массива
+     * @param timeout_ms Таймаут в миллисекундах (-1 - ждать бесконечно)
+     * @return int Количество готовых событий (0 при таймауте или EINTR)
+     *
+     * @throw std::runtime_error при ошибке epoll_wait()
+     */
+    int wait(struct epoll_event* events, int max_events, int timeout_ms);
+};
+
+/**
+ * @brief Переводит дескриптор в неблокирующий режим
+ *
+ * @param fd Дескриптор
+ * @throw std::runtime_error при ошибке fcntl()
+ */
+void set_nonblocking(int fd);
+
+#endif // EVENT_LOOP_H
@@ -10,11 +10,16 @@
  * - Автоматическое добавление временных меток
  * - Поддержка как полных строк, так и добавления к существующей строке
  * - Разделение на обычные логи и ошибки
+ * - Потокобезопасность: один логгер разделяется рабочими потоками сервера
+ * - Буферизованный режим для шардов: файл открыт постоянно, строки
+ *   копятся в собственном буфере логгера и дописываются пачками
  */
 
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <chrono>
+#include <mutex>
 #include <string>
 
 /**
@@ -22,21 +27,53 @@
  * 
  * Предоставляет методы для логирования сообщений с временными метками
  * и уровнем важности. Поддерживает одновременную запись в файл и вывод в консоль.
+ * 
+ * @note Методы потокобезопасны: запись каждого сообщения выполняется под мьютексом
  */
 class Logger {
 private:
     std::string log_file_;          ///< Путь к файлу логов
+    std::mutex mutex_;              ///< Сериализует записи из разных потоков
     std::string get_current_time(); ///< Получает текущее время в формате строки
     
+    const bool buffered_;           ///< Буферизованный режим (без вывода в консоль)
+    int fd_;                        ///< Открытый файл логов в буферизованном режиме (-1 - нет)
+    std::string buffer_;            ///< Еще не записанные строки
+    std::chrono::steady_clock::time_point flush_at_; ///< Срок записи буфера
+    
+    void write_buffer();            ///< Записывает буфер в файл (под mutex_)
+    
 public:
+    /**
+     * @brief Интервал, через который буфер записывается в файл
+     */
+    static const int kFlushIntervalMs = 100;
+    
+    /**
+     * @brief Размер буфера, при котором он записывается сразу
+     */
+    static const size_t kFlushBytes = 64 * 1024;
+    
     /**
      * @brief Конструктор логгера
      * 
      * @param filename Путь к файлу для записи логов
+     * @param buffered Буферизованный режим: файл открыт до уничтожения логгера,
+     *                 записи копятся в буфере и не выводятся в консоль
      * 
      * @note Файл открывается в режиме добавления (append)
+     * @note В буферизованном режиме буфер записывается одним write(), поэтому
+     *       несколько логгеров одного файла не разрывают строки друг друга
+     */
+    Logger(const std::string& filename, bool buffered = false);
+    
+    /**
+     * @brief Деструктор: записывает остаток буфера и закрывает файл
      */
-    Logger(const std::string& filename);
+    ~Logger();
+    
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
     
     /**
      * @brief Записывает сообщение в лог
@@ -71,6 +108,19 @@ public:
      * Использует тот же формат, что и log()
      */
     void log_error(const std::string& error, bool critical = false);
+    
+    /**
+     * @brief Записывает накопленный буфер в файл
+     */
+    void flush();
+    
+    /**
+     * @brief Время до записи буфера для таймаута событийного цикла
+     * 
+     * @return int Миллисекунды (0 - пора вызвать flush()), -1 если буфер пуст
+     *         или логгер не буферизованный
+     */
+    int flush_timeout_ms();
 };
 
 #endif // LOGGER_H
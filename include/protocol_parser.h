@@ -0,0 +1,325 @@
+/**
+ * @file protocol_parser.h
+ * @brief Инкрементальный разбор протокола клиента
+ *
+ * Определяет класс ProtocolParser - конечный автомат, который разбирает
+ * поток байт от клиента:
+ * [логин][16 hex соль][32 hex хэш][количество][размер1][элементы1]...
+ *
+ * Количество 0xFFFFFFFF (kExtendedHeader) открывает расширенный заголовок,
+ * в котором клиент объявляет тип элементов и операцию для всех векторов
+ * запроса: [0xFFFFFFFF][тип:u8][операция:u8][резерв:u16][количество]...
+ * Без него элементы - int32, операция - произведение (исходный протокол).
+ * Для скалярного произведения (Operation::Dot) элементы вектора - пары
+ * a0 b0 a1 b1 ..., поэтому размер каждого вектора должен быть четным:
+ * нечетный размер завершает разбор событием BadHeader. Так же отклоняется
+ * вектор точного произведения (Operation::ExactProduct), результат
+ * которого может превысить kMaxExactProductBytes.
+ *
+ * Разбор не выполняет ввод-вывод: данные передаются через feed() порциями
+ * любого размера, а next() выдает очередное событие, как только для него
+ * накоплено достаточно байт. Поэтому один и тот же разбор используется
+ * блокирующим режимом, событийным циклом epoll и транспортом io_uring.
+ *
+ * @see protocol_parser.cpp
+ */
+
+#ifndef PROTOCOL_PARSER_H
+#define PROTOCOL_PARSER_H
+
+#include "byte_buffer.h"
+#include "result_cache.h"
+#include "types.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Конечный автомат разбора протокола
+ *
+ * Типичное использование:
+ * @code
+ * parser.feed(data, length);
+ * ProtocolParser::Event event;
+ * while ((event = parser.next()) != ProtocolParser::Event::NeedMore) {
+ *     // обработка события
+ * }
+ * @endcode
+ *
+ * @note Порядок байт чисел не преобразуется (как и в остальном сервере)
+ * @warning Экземпляр не является потокобезопасным
+ */
+class ProtocolParser {
+public:
+    /**
+     * @brief Значение поля количества, за которым следует расширенный заголовок
+     */
+    static const uint32_t kExtendedHeader = 0xFFFFFFFFu;
+
+    /**
+     * @brief Соль и хэш должны начинаться в первых kCredentialsSearchLimit
+     *        байтах (то есть это ограничение длины логина)
+     */
+    static const size_t kCredentialsSearchLimit = 150;
+
+    /**
+     * @brief Наибольший размер точного произведения в байтах
+     *
+     * Модуль произведения не длиннее суммы длин сомножителей, поэтому
+     * вектор ExactProduct, в котором размер × размер элемента больше
+     * этого значения, отклоняется еще до приема элементов: иначе один
+     * вектор занимал бы память и процессор без предела.
+     */
+    static const size_t kMaxExactProductBytes = 1 << 20;
+
+    /**
+     * @brief Этап разбора
+     */
+    enum class Stage {
+        Auth,         ///< Ожидание логина, соли и хэша
+        VectorCount,  ///< Ожидание количества векторов
+        VectorSize,   ///< Ожидание размера очередного вектора
+        VectorData,   ///< Ожидание элементов вектора
+        Done          ///< Разбор завершен
+    };
+
+    /**
+     * @brief Результат очередного шага разбора
+     */
+    enum class Event {
+        NeedMore,        ///< Данных недостаточно (или разбор завершен)
+        Credentials,     ///< Разобраны логин, соль и хэш
+        BadCredentials,  ///< 48 hex символов не начинаются в первых kCredentialsSearchLimit байтах
+        VectorCount,     ///< Принято количество векторов
+        BadHeader,       ///< Неизвестный тип элементов или операция в расширенном заголовке,
+                         ///< либо размер вектора, недопустимый для операции
+        VectorSize,      ///< Принят размер очередного вектора
+        Elements,        ///< Порция элементов потокового вектора (см. elements())
+        Vector           ///< Принят очередной вектор целиком
+    };
+
+private:
+    ByteBuffer buffer_;              ///< Принятые, но еще не разобранные байты
+    Stage stage_;                    ///< Текущий этап
+    size_t scanned_;                 ///< Сколько байт буфера уже просмотрено в этапе Auth
+    size_t run_start_;               ///< Начало текущей серии hex символов
+    size_t run_length_;              ///< Длина текущей серии (0 - серии нет)
+    size_t credentials_offset_;      ///< Позиция соли в исходном буфере
+    std::string login_;              ///< Логин
+    std::string salt_;               ///< Соль (16 hex)
+    std::string hash_;               ///< Хэш (32 hex)
+    uint32_t vector_count_;          ///< Объявленное количество векторов
+    ElementType element_type_;       ///< Тип элементов векторов запроса
+    size_t element_size_;            ///< Размер элемента в байтах
+    Operation operation_;            ///< Операция над векторами запроса
+    uint32_t vectors_parsed_;        ///< Количество полностью принятых векторов
+    uint32_t vector_size_;           ///< Размер текущего вектора
+    size_t vector_filled_;           ///< Сколько байт элементов уже принято
+    uint32_t stream_threshold_;      ///< Векторы длиннее этого не материализуются
+    uint32_t key_threshold_;         ///< Векторы не короче этого получают ключ кэша
+    bool keyed_;                     ///< Ключ текущего вектора накапливается при приеме
+    ResultCache::KeyHasher key_hasher_; ///< Ключ кэша текущего вектора
+    bool streaming_;                 ///< Текущий вектор разбирается потоково
+    bool skipping_;                  ///< Остаток потокового вектора отбрасывается
+    const char* chunk_;              ///< Порция элементов потокового вектора
+    size_t chunk_count_;             ///< Количество элементов в порции
+    size_t pending_consume_;         ///< Байты порции, отбрасываемые при следующем next()
+    std::vector<int32_t> vector_;    ///< Текущий (или последний принятый) вектор
+
+    Event parse_credentials();       ///< Поиск 48 hex символов
+    Event parse_vector_count();      ///< Количество векторов (и расширенный заголовок)
+    uint32_t take_uint32();          ///< Извлекает 32-битное число из буфера
+
+public:
+    /**
+     * @brief Создает разбор в начальном состоянии (Auth)
+     *
+     * @param stream_threshold Векторы, в которых больше элементов, разбираются
+     *        потоково: память под них не выделяется, а элементы выдаются
+     *        порциями событием Elements прямо из буфера приема. Так память
+     *        сессии не зависит от объявленного клиентом размера вектора.
+     *        Векторы с типом элементов, отличным от int32, или с операцией,
+     *        отличной от произведения, разбираются потоково всегда.
+     * @param key_threshold Материализуемые векторы не короче этого получают
+     *        ключ кэша результатов (vector_key()): он накапливается по мере
+     *        копирования элементов в вектор, без отдельного прохода
+     */
+    explicit ProtocolParser(uint32_t stream_threshold = UINT32_MAX, uint32_t key_threshold = UINT32_MAX);
+
+    /**
+     * @brief Добавляет принятые байты
+     *
+     * @param data Данные
+     * @param length Количество байт
+     */
+    void feed(const char* data, size_t length);
+
+    /**
+     * @brief Буфер неразобранных данных для приема без промежуточной копии
+     *
+     * @details
+     * Сокетный транспорт принимает данные прямо в буфер разбора:
+     * @code
+     * ByteBuffer& input = parser.input();
+     * ssize_t n = recv(fd, input.prepare(chunk), input.writable(), 0);
+     * if (n > 0) input.commit(n);
+     * @endcode
+     */
+    ByteBuffer& input() { return buffer_; }
+
+    /**
+     * @brief Сколько байт можно принять прямо в память текущего вектора
+     *
+     * @return size_t Оставшиеся байты элементов, если разбор ждет элементы
+     *         и буфер пуст; иначе 0
+     *
+     * @details
+     * После размера вектора память под элементы выделяется сразу. Уже
+     * принятые байты переносятся в нее из буфера один раз, а остаток
+     * транспорт принимает прямо в вектор, минуя ByteBuffer:
+     * @code
+     * size_t capacity = parser.direct_capacity();
+     * ssize_t n = recv(fd, parser.direct_area(), capacity, 0);
+     * if (n > 0) parser.commit_direct(n);
+     * @endcode
+     * Размер приема ограничен остатком вектора, поэтому байты следующего
+     * поля в вектор не попадают.
+     */
+    size_t direct_capacity() const;
+
+    /**
+     * @brief Адрес, с которого продолжается прием элементов вектора
+     *
+     * @note Действителен, только если direct_capacity() > 0
+     */
+    char* direct_area();
+
+    /**
+     * @brief Отмечает length байт, принятых по адресу direct_area()
+     *
+     * @param length Количество байт (не больше direct_capacity())
+     */
+    void commit_direct(size_t length);
+
+    /**
+     * @brief Выполняет один шаг разбора
+     *
+     * @return Event Событие или NeedMore, если для следующего шага данных
+     *         недостаточно
+     *
+     * @details
+     * В этапе Auth просматриваются только новые байты: поиск 48 hex
+     * символов подряд продолжается с места, где остановился прошлый вызов.
+     * BadCredentials выдается, когда серия уже не может начаться в первых
+     * kCredentialsSearchLimit байтах.
+     *
+     * @throw std::bad_alloc если не удалось выделить память под вектор
+     *        (память выделяется при разборе размера вектора)
+     */
+    Event next();
+
+    /**
+     * @brief Отбрасывает оставшиеся элементы текущего потокового вектора
+     *
+     * @details
+     * Вызывается после события Elements, когда результат вектора уже
+     * известен. Дальнейшие байты вектора отбрасываются из буфера целиком,
+     * без событий Elements и без разбора элементов; вектор, как обычно,
+     * завершается событием Vector.
+     *
+     * @note Для непотокового вектора и вне этапа VectorData ничего не делает
+     */
+    void skip_vector();
+
+    /**
+     * @brief Отбрасываются ли оставшиеся элементы текущего вектора
+     */
+    bool skipping() const { return skipping_; }
+
+    /**
+     * @brief Прекращает разбор (например, после отказа в аутентификации)
+     */
+    void finish();
+
+    /**
+     * @brief Проверяет, завершен ли разбор
+     */
+    bool finished() const { return stage_ == Stage::Done; }
+
+    /**
+     * @brief Возвращает текущий этап
+     */
+    Stage stage() const { return stage_; }
+
+    /**
+     * @brief Сколько байт уже просмотрено при поиске соли+хэша
+     */
+    size_t scanned() const { return scanned_; }
+
+    /**
+     * @brief Позиция, с которой начинались соль и хэш (длина логина)
+     */
+    size_t credentials_offset() const { return credentials_offset_; }
+
+    const std::string& login() const { return login_; }     ///< Логин
+    const std::string& salt() const { return salt_; }       ///< Соль
+    const std::string& hash() const { return hash_; }       ///< Хэш
+
+    uint32_t vector_count() const { return vector_count_; }     ///< Объявленное количество векторов
+    ElementType element_type() const { return element_type_; }  ///< Тип элементов векторов запроса
+    Operation operation() const { return operation_; }          ///< Операция над векторами запроса
+    uint32_t vectors_parsed() const { return vectors_parsed_; } ///< Принято векторов
+    uint32_t vector_size() const { return vector_size_; }       ///< Размер текущего вектора
+
+    /**
+     * @brief Последний принятый вектор (действителен до следующего next())
+     *
+     * @note Для потокового вектора пуст - его элементы выдаются через elements()
+     */
+    const std::vector<int32_t>& vector() const { return vector_; }
+
+    /**
+     * @brief Ключ кэша результатов последнего принятого вектора
+     *
+     * @param key Сюда записывается ключ (равен ResultCache::make_key() элементов)
+     * @return bool false если ключ не вычислялся (вектор потоковый или
+     *         короче key_threshold)
+     *
+     * @note Действителен после события Vector, до следующего next()
+     */
+    bool vector_key(ResultCache::Key& key) const;
+
+    /**
+     * @brief Разбирается ли текущий (последний) вектор потоково
+     */
+    bool streaming() const { return streaming_; }
+
+    /**
+     * @brief Порция элементов после события Elements
+     *
+     * @return const char* Элементы по element_size(element_type()) байт
+     *         без выравнивания (действительны до следующего next())
+     */
+    const char* elements() const { return chunk_; }
+
+    /**
+     * @brief Количество элементов в порции после события Elements
+     */
+    size_t element_count() const { return chunk_count_; }
+
+    /**
+     * @brief Количество принятых, но не разобранных байт
+     */
+    size_t buffered() const { return buffer_.size(); }
+
+    /**
+     * @brief Начало неразобранных данных (для логирования)
+     *
+     * @param length Максимальная длина
+     * @return std::string Не более length первых байт буфера
+     */
+    std::string preview(size_t length) const;
+};
+
+#endif // PROTOCOL_PARSER_H
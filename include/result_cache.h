@@ -0,0 +1,200 @@
+/**
+ * @file result_cache.h
+ * @brief Кэш результатов для повторяющихся векторов
+ *
+ * Определяет класс ResultCache - LRU-кэш произведений, адресуемый
+ * содержимым вектора: ключ - быстрый некриптографический 64-битный хэш
+ * байт элементов и их количество. Клиенты, повторно присылающие те же
+ * векторы (повторы запросов, веерные задания), получают результат без
+ * вычисления произведения.
+ *
+ * Размещение выбирает сервер:
+ * - worker - у каждого рабочего потока свой кэш из одного шарда
+ *   (мьютекс не разделяется между потоками);
+ * - global - один кэш на сервер, разбитый на шарды по битам хэша,
+ *   чтобы потоки редко ждали друг друга.
+ *
+ * @see result_cache.cpp
+ */
+
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief LRU-кэш произведений с ограничением памяти
+ *
+ * Типичное использование (ключ можно также накапливать по мере приема
+ * элементов, см. KeyHasher):
+ * @code
+ * ResultCache::Key key = ResultCache::make_key(data, count);
+ * int32_t product;
+ * if (!cache.find(key, product)) {
+ *     product = VectorProcessor::calculate_product(data, count);
+ *     cache.insert(key, product);
+ * }
+ * @endcode
+ *
+ * @note Все методы потокобезопасны
+ * @warning Совпадение ключа не сравнивает сами элементы: два разных
+ *          вектора одной длины с одинаковым 64-битным хэшем получат
+ *          один результат (вероятность порядка n^2 / 2^65 для n записей)
+ */
+class ResultCache {
+public:
+    /**
+     * @brief Ключ записи
+     */
+    struct Key {
+        uint64_t hash;      ///< Хэш байт элементов
+        uint32_t count;     ///< Количество элементов
+
+        bool operator==(const Key& other) const { return hash == other.hash && count == other.count; }
+    };
+
+    /**
+     * @brief Счетчики обращений
+     */
+    struct Stats {
+        uint64_t hits;      ///< Найдено в кэше
+        uint64_t misses;    ///< Не найдено
+        uint64_t evictions; ///< Вытеснено из-за ограничения памяти
+        size_t entries;     ///< Записей сейчас
+    };
+
+    /**
+     * @brief Примерный размер одной записи вместе со служебными структурами
+     */
+    static const size_t kEntryBytes = 96;
+
+    /**
+     * @brief Инкрементальное вычисление ключа
+     *
+     * Дает тот же ключ, что make_key(), для байт, поданных в update()
+     * порциями любого размера, - например, по мере приема вектора из сети,
+     * пока байты еще в кэше процессора.
+     *
+     * @code
+     * ResultCache::KeyHasher hasher;
+     * hasher.update(part1, length1);
+     * hasher.update(part2, length2);
+     * ResultCache::Key key = hasher.key(); // == make_key(all, count)
+     * @endcode
+     */
+    class KeyHasher {
+    private:
+        uint64_t secret_[4];    ///< Константы дорожек с начальным значением процесса
+        uint64_t lanes_[4];     ///< Состояние четырех дорожек
+        char tail_[64];         ///< Неполный 64-байтный блок
+        size_t tail_length_;    ///< Байт в tail_
+        uint64_t length_;       ///< Всего байт
+
+    public:
+        KeyHasher();                                    ///< Пустой ключ
+        void reset();                                   ///< Начинает новый ключ
+        void update(const void* data, size_t length);   ///< Добавляет байты элементов
+        Key key() const;                                ///< Ключ поданных байт (по 4 на элемент)
+    };
+
+private:
+    struct KeyHash {
+        size_t operator()(const Key& key) const { return static_cast<size_t>(key.hash); }
+    };
+
+    struct Entry {
+        Key key;            ///< Ключ
+        int32_t result;     ///< Произведение
+    };
+
+    /**
+     * @brief Независимая часть кэша со своим мьютексом и списком LRU
+     */
+    struct Shard {
+        std::mutex mutex;                                            ///< Защищает поля шарда
+        std::list<Entry> lru;                                        ///< От недавних к давним
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index; ///< Поиск по ключу
+        size_t capacity;                                             ///< Максимум записей шарда
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;  ///< Шарды (количество - степень двойки)
+    std::atomic<uint64_t> hits_;                  ///< Попадания
+    std::atomic<uint64_t> misses_;                ///< Промахи
+    std::atomic<uint64_t> evictions_;             ///< Вытеснения
+
+    Shard& shard_for(const Key& key);             ///< Шард по старшим битам хэша
+
+    ResultCache(const ResultCache&);              ///< Копирование запрещено
+    ResultCache& operator=(const ResultCache&);   ///< Присваивание запрещено
+
+public:
+    /**
+     * @brief Создает пустой кэш
+     *
+     * @param memory_bytes Ограничение памяти (делится между шардами поровну,
+     *        в каждом шарде не меньше одной записи)
+     * @param shards Количество шардов; округляется вверх до степени двойки
+     */
+    explicit ResultCache(size_t memory_bytes, size_t shards = 1);
+
+    /**
+     * @brief Вычисляет ключ для элементов вектора
+     *
+     * @param data Байты элементов
+     * @param count Количество элементов по 4 байта
+     * @return Key Ключ записи
+     */
+    static Key make_key(const void* data, size_t count);
+
+    /**
+     * @brief Быстрый некриптографический хэш
+     *
+     * @param data Данные
+     * @param length Длина в байтах
+     * @param seed Начальное значение
+     * @return uint64_t Хэш
+     *
+     * @details
+     * Блоки по 64 байта обрабатываются в четырех независимых дорожках
+     * (по 16 байт на дорожку) умножением 64x64->128 со сверткой половин,
+     * поэтому скорость ограничена пропускной способностью умножителя,
+     * а не задержкой. Остаток короче 64 байт сворачивается блоками по 16.
+     */
+    static uint64_t hash(const void* data, size_t length, uint64_t seed = 0);
+
+    /**
+     * @brief Ищет результат и отмечает запись как недавнюю
+     *
+     * @param key Ключ
+     * @param result Сюда записывается результат при попадании
+     * @return bool true при попадании
+     */
+    bool find(const Key& key, int32_t& result);
+
+    /**
+     * @brief Добавляет (или обновляет) результат, вытесняя давние записи
+     *
+     * @param key Ключ
+     * @param result Результат
+     */
+    void insert(const Key& key, int32_t result);
+
+    /**
+     * @brief Текущие счетчики
+     */
+    Stats stats() const;
+
+    /**
+     * @brief Количество шардов
+     */
+    size_t shard_count() const { return shards_.size(); }
+};
+
+#endif // RESULT_CACHE_H
@@ -6,7 +6,8 @@
  * Отвечает за инициализацию, настройку сокета, загрузку конфигурации,
  * прием клиентских подключений и создание сессий для их обработки.
  * 
- * @note Сервер работает в бесконечном цикле, принимая новые подключения
+ * @note Сервер работает в бесконечном событийном цикле на основе epoll,
+ *       обслуживая множество подключений одновременно
  * @see server.cpp
  */
 
@@ -16,8 +17,11 @@
 #include "types.h"
 #include "config.h"
 #include "logger.h"
-#include <unordered_map>
+#include "result_cache.h"
+#include "worker.h"
+#include <memory>
 #include <string>
+#include <vector>
 
 /**
  * @brief Основной класс TCP сервера
@@ -29,15 +33,46 @@
  * - Создание сессий для обработки клиентских запросов
  * - Ведение журнала событий
  * 
- * @note Использует блокирующие системные вызовы
- * @warning Обрабатывает только одно подключение одновременно (последовательно)
+ * @note Использует неблокирующие сокеты и epoll в режиме edge-triggered:
+ *       медленный клиент не задерживает обработку остальных
+ * @note При config.threads > 0 сессии обслуживает пул рабочих потоков,
+ *       а основной поток только принимает подключения
+ * @note При config.shards > 0 сервер открывает несколько слушающих сокетов
+ *       с SO_REUSEPORT, каждый со своим потоком, логгером и копией базы клиентов
  */
 class Server {
 private:
+    /**
+     * @brief Шард сервера в режиме SO_REUSEPORT
+     * 
+     * Все, что нужно шарду на горячем пути, принадлежит только ему:
+     * логгер, копия базы клиентов, слушающий сокет и событийный цикл.
+     * Логгер шарда буферизованный: держит файл логов открытым, не пишет
+     * в консоль и дописывает файл пачками по сроку из событийного цикла.
+     */
+    struct Shard {
+        Logger logger;                                       ///< Собственный буферизованный логгер шарда
+        CredentialTable clients;                             ///< Копия базы клиентов
+        int listen_fd;                                       ///< Слушающий сокет шарда
+        bool owns_listen_fd;                                 ///< Закрывать ли listen_fd в деструкторе
+        std::unique_ptr<Worker> worker;                      ///< Событийный цикл шарда
+        
+        Shard(const std::string& log_file,
+              const CredentialTable& clients,
+              int listen_fd, bool owns_listen_fd)
+            : logger(log_file, true), clients(clients), listen_fd(listen_fd),
+              owns_listen_fd(owns_listen_fd) {}
+        ~Shard();
+    };
+    
     ServerConfig config_;                                ///< Конфигурация сервера
     Logger logger_;                                      ///< Логгер для записи событий
-    std::unordered_map<std::string, std::string> clients_; ///< База данных клиентов
+    CredentialTable clients_;                            ///< База данных клиентов
     int server_fd_;                                      ///< Дескриптор серверного сокета
+    std::vector<std::unique_ptr<ResultCache>> caches_;   ///< Кэши результатов (переживают Worker)
+    std::vector<std::unique_ptr<Worker>> workers_;       ///< Пул рабочих потоков
+    size_t next_worker_;                                 ///< Следующий Worker для round-robin
+    std::vector<std::unique_ptr<Shard>> shards_;         ///< Шарды в режиме SO_REUSEPORT
     
     /**
      * @brief Загружает базу данных клиентов из файла
@@ -48,6 +83,23 @@ private:
      */
     void load_clients();
     
+    /**
+     * @brief Активирует вычислительное ядро произведения из конфигурации
+     * 
+     * @throw std::runtime_error если ядро неизвестно или не поддерживается
+     */
+    void select_kernel();
+    
+    /**
+     * @brief Кэш результатов для очередного цикла обслуживания сессий
+     * 
+     * @param serving Сколько циклов обслуживают сессии
+     * @return ResultCache* nullptr если кэш выключен; при размещении global -
+     *         один общий шардированный кэш, при worker - новый кэш
+     *         с долей serving общего объема
+     */
+    ResultCache* cache_for_worker(size_t serving);
+    
     /**
      * @brief Настраивает серверный сокет
      * 
@@ -58,14 +110,42 @@ private:
      */
     void setup_socket();
     
+    /**
+     * @brief Создает неблокирующий слушающий сокет на порту сервера
+     * 
+     * @return int Дескриптор сокета
+     * @throw std::runtime_error при ошибках системных вызовов
+     */
+    int create_listener();
+    
+    /**
+     * @brief Запускает шарды SO_REUSEPORT и обслуживает последний в текущем потоке
+     * 
+     * @param queue_capacity Емкость очереди входящих сокетов Worker
+     * @param issue_salt Режим вызов-ответ: соль выдает сервер
+     */
+    void run_shards(size_t queue_capacity, bool issue_salt);
+    
     /**
      * @brief Принимает входящие подключения
      * 
-     * Бесконечный цикл, который принимает новые подключения
-     * и создает для каждого экземпляр Session для обработки.
+     * Бесконечный событийный цикл: принимает новые подключения
+     * и обслуживает их сессии в основном потоке либо передает
+     * их пулу рабочих потоков.
      */
     void accept_connections();
     
+    /**
+     * @brief Передает принятый сокет рабочему потоку
+     * 
+     * @param client_socket Неблокирующий сокет клиента
+     * 
+     * @details
+     * Выбирает Worker по кругу; если его очередь заполнена, пробует
+     * остальные, а если заполнены все - ждет освобождения места.
+     */
+    void dispatch(int client_socket);
+    
 public:
     /**
      * @brief Конструктор сервера
@@ -5,44 +5,88 @@
  * Определяет класс Session, который обрабатывает отдельные клиентские подключения.
  * Реализует полный цикл обработки: аутентификация, прием данных, вычисления, отправка результатов.
  * 
- * @note Каждое подключение обрабатывается в отдельном потоке/сессии
+ * @note Сессия может работать как в блокирующем режиме (handle()), так и
+ *       под управлением событийного цикла сервера (on_event()) или внешнего
+ *       транспорта, который сам выполняет ввод-вывод (feed() / take_output())
  * @see session.cpp
  */
 
 #ifndef SESSION_H
 #define SESSION_H
 
+#include "credential_table.h"
+#include "protocol_parser.h"
+#include "vector_processor.h"
 #include <string>
-#include <unordered_map>
 #include <vector>
 #include <cstdint>
 
 class Logger;
+class ResultCache;
+class AuthBatcher;
 
 /**
  * @brief Класс обработки клиентской сессии
  * 
  * Обрабатывает полный цикл взаимодействия с клиентом:
- * 1. Прием и проверка аутентификационных данных
+ * 1. Прием и проверка аутентификационных данных (в режиме вызов-ответ
+ *    сервер сначала отправляет клиенту соль, и клиент должен подписать именно ее)
  * 2. Прием векторов для обработки
  * 3. Вычисление произведений элементов векторов
  * 4. Отправка результатов обратно клиенту
  * 
- * @warning Класс не является потокобезопасным, должен использоваться по одной сессии на поток
+ * Протокол разбирается конечным автоматом ProtocolParser: каждый вызов
+ * process_input() продвигает сессию настолько, насколько позволяют уже
+ * принятые данные, поэтому сессию можно приостановить и продолжить при
+ * поступлении новых байт.
+ * 
+ * @warning Экземпляр не является потокобезопасным: каждая сессия обслуживается
+ *          одним потоком. База клиентов разделяется между потоками только для чтения,
+ *          Logger потокобезопасен
  */
 class Session {
 private:
     int client_socket;                                     ///< Сокет клиента
-    std::unordered_map<std::string, std::string>& clients; ///< Ссылка на базу клиентов
+    bool socket_io;                                        ///< Сессия сама выполняет recv/send
+    const CredentialTable& clients;                        ///< Ссылка на базу клиентов (только чтение)
     Logger& logger;                                        ///< Ссылка на логгер
+    ResultCache* cache;                                    ///< Кэш результатов (nullptr - выключен)
+    AuthBatcher* auth_batcher;                             ///< Пакетная проверка MD5 (nullptr - сразу)
+    bool auth_pending;                                     ///< Проверка стоит в пакете, разбор приостановлен
+    bool read_more;                                        ///< Бюджет чтения исчерпан раньше EAGAIN
+    bool input_blocked;                                    ///< Чтение остановлено неотправленным выводом
+    std::string issued_salt;                               ///< Соль, выданная сервером (пусто - выбирает клиент)
     
-    // Буфер для приема данных
-    std::string receive_buffer;                            ///< Буфер накопленных данных
+    ProtocolParser parser;                                 ///< Разбор входящего потока
+    TypedReduction reduction;                              ///< Операция над потоковым вектором
+    std::vector<int32_t> sample;                           ///< Первые элементы потокового вектора int32 (для лога)
+    std::string send_buffer;                               ///< Накопленные результаты и ответы, ожидающие отправки
     
     // Приватные методы
-    void receive_to_buffer();                              ///< Принимает данные в буфер
-    std::string extract_from_buffer_until_non_hex();       ///< Извлекает hex символы до не-hex
-    std::string extract_from_buffer_exact(size_t length);  ///< Извлекает точное количество байт
+    size_t receive_to_buffer(size_t limit = SIZE_MAX);     ///< Принимает данные в буфер
+    bool flush_send_buffer(bool more = false);             ///< Отправляет накопленные данные
+    void process_input();                                  ///< Продвигает разбор протокола
+    bool output_blocked() const;                           ///< Вывод достиг порога, чтение приостановлено
+    void process_auth();                                   ///< Проверяет разобранные учетные данные
+    void process_elements();                               ///< Сворачивает порцию потокового вектора
+    void process_vector();                                 ///< Вычисляет и отправляет результат
+    int32_t cached_product(const std::vector<int32_t>& vector_data); ///< Произведение через кэш
+    void fail(const std::string& error);                   ///< Завершает сессию с ошибкой
+    void finish_vectors();                                 ///< Логирует завершение сессии
+    
+    /**
+     * @brief Ищет пароль клиента и проверяет формат соли и хэша
+     * 
+     * @param login Логин клиента
+     * @param salt Соль для хэширования
+     * @param received_hash Полученный хэш от клиента
+     * @param password Пароль из базы
+     * @return bool true если логин найден и формат верен
+     */
+    bool find_password(const std::string& login,
+                       const std::string& salt,
+                       const std::string& received_hash,
+                       CredentialTable::View& password);
     
     /**
      * @brief Проверяет аутентификацию клиента
@@ -56,13 +100,13 @@ private:
                               const std::string& salt, 
                               const std::string& received_hash);
     
-    void process_vectors();                                 ///< Основная логика обработки векторов
-    uint32_t receive_uint32();                              ///< Принимает 32-битное беззнаковое число
-    std::vector<int32_t> receive_vector(uint32_t size);     ///< Принимает вектор заданного размера
-    void send_uint32(uint32_t value);                       ///< Отправляет 32-битное беззнаковое число
-    void send_int32(int32_t value);                         ///< Отправляет 32-битное знаковое число
-    std::string calculate_md5(const std::string& data);     ///< Вычисляет MD5 хэш
-    int32_t calculate_vector_product(const std::vector<int32_t>& vector); ///< Вычисляет произведение вектора
+    void complete_auth(bool success);                      ///< Отправляет итог проверки клиенту
+    
+    void send_int32(int32_t value);                         ///< Ставит 32-битное число в очередь отправки
+    void send_result(const char* data, size_t length);      ///< Ставит результат в очередь отправки
+
+    Session(const Session&);                                ///< Копирование запрещено
+    Session& operator=(const Session&);                     ///< Присваивание запрещено
 
 public:
     /**
@@ -71,25 +115,122 @@ public:
      * @param client_socket Сокет подключенного клиента
      * @param clients База данных клиентов
      * @param logger Логгер для записи событий
+     * @param socket_io true - сессия сама читает и пишет сокет;
+     *        false - ввод-вывод выполняет внешний транспорт через feed() и take_output()
+     * @param cache Кэш результатов, общий с другими сессиями (nullptr - без кэша)
+     * @param auth_batcher Пакетная проверка событийного цикла этой сессии
+     *        (nullptr - MD5 вычисляется сразу). Только для on_event()
+     * @param issue_salt true - режим вызов-ответ: сессия ставит в очередь
+     *        отправки соль "<16 hex>\n", и клиент должен вернуть ее в запросе
+     * 
+     * @note Выданная соль уходит клиенту при первой отправке: в начале
+     *       handle(), по первому EPOLLOUT в on_event() или через take_output()
      */
-    Session(int client_socket, std::unordered_map<std::string, std::string>& clients, Logger& logger);
+    Session(int client_socket, const CredentialTable& clients, Logger& logger,
+            bool socket_io = true, ResultCache* cache = nullptr, AuthBatcher* auth_batcher = nullptr,
+            bool issue_salt = false);
     
     /**
-     * @brief Основной метод обработки сессии
+     * @brief Деструктор сессии
+     * 
+     * Закрывает клиентский сокет, если он еще открыт и сессия им владеет (socket_io),
+     * и снимает с пакетной проверки ее ожидающий запрос.
+     */
+    ~Session();
+    
+    /**
+     * @brief Основной метод обработки сессии в блокирующем режиме
      * 
      * Запускает обработку клиентской сессии. Выполняет аутентификацию,
      * прием данных, вычисления и отправку результатов.
      * 
      * @note Автоматически закрывает сокет при завершении
-     * @throw std::exception при критических ошибках обработки
+     * @note Сокет должен быть блокирующим
      */
     void handle();
     
+    /**
+     * @brief Обрабатывает событие готовности сокета
+     * 
+     * @param events Маска событий epoll (EPOLLIN, EPOLLOUT, EPOLLHUP, ...)
+     * @return bool true если сессия продолжается, false если ее можно закрыть
+     * 
+     * @details
+     * Вычитывает доступные данные до EAGAIN, но не больше фиксированного
+     * бюджета, продвигает разбор протокола и дописывает отложенный вывод.
+     * Если клиент не читает результаты и вывод копится, чтение и разбор
+     * приостанавливаются до EPOLLOUT.
+     * Используется событийным циклом сервера с неблокирующими сокетами
+     * в режиме edge-triggered.
+     * 
+     * @note Если бюджет исчерпан, input_pending() возвращает true: epoll
+     *       не сообщит об оставшихся данных повторно, и цикл должен сам
+     *       вызвать on_event(EPOLLIN) снова
+     */
+    bool on_event(uint32_t events);
+    
+    /**
+     * @brief Проверяет, остались ли в сокете непрочитанные данные
+     * 
+     * @return bool true если последний on_event() остановил чтение
+     *         по исчерпании бюджета, а не по EAGAIN
+     */
+    bool input_pending() const;
+    
+    /**
+     * @brief Возобновляет сессию после пакетной проверки
+     * 
+     * @param success Результат проверки из AuthBatcher::flush()
+     * @return bool true если сессия продолжается, false если ее можно закрыть
+     * 
+     * @details
+     * Отправляет клиенту "OK\n" или "err\n", разбирает данные, принятые
+     * во время ожидания, и дочитывает сокет, как on_event(EPOLLIN).
+     */
+    bool on_auth_verified(bool success);
+    
+    /**
+     * @brief Передает сессии принятые внешним транспортом данные
+     * 
+     * @param data Принятые байты
+     * @param length Количество байт
+     * 
+     * @note Ошибки протокола переводят сессию в завершенное состояние
+     */
+    void feed(const char* data, size_t length);
+    
+    /**
+     * @brief Сообщает сессии, что клиент закрыл соединение или произошла ошибка приема
+     * 
+     * @param error Текст ошибки для лога
+     */
+    void on_receive_closed(const std::string& error);
+    
+    /**
+     * @brief Забирает данные, накопленные для отправки клиенту
+     * 
+     * @param out Строка, в конец которой дописываются данные
+     * 
+     * @note Используется внешним транспортом (socket_io == false)
+     */
+    void take_output(std::string& out);
+    
+    /**
+     * @brief Проверяет, завершен ли разбор протокола
+     * 
+     * @return bool true если новых данных от клиента сессия больше не ждет
+     */
+    bool finished() const;
+    
     /**
      * @brief Отправляет текстовые данные клиенту
      * 
      * @param text Текст для отправки
      * @return bool true если отправка успешна, false при ошибке
+     * 
+     * @note На неблокирующем сокете неотправленный остаток сохраняется
+     *       в буфере и дописывается при следующем событии EPOLLOUT
+     * @note При внешнем транспорте данные только накапливаются в буфере
      */
     bool send_text(const std::string& text);
 };
@@ -0,0 +1,119 @@
+/**
+ * @file task_pool.h
+ * @brief Пул потоков с перехватом задач (work stealing)
+ *
+ * Определяет класс TaskPool, на котором выполняются параллельные
+ * вычисления VectorProcessor. У каждого потока пула своя очередь задач:
+ * поток берет задачи с конца своей очереди, а когда она пуста - перехватывает
+ * их с начала чужих. Поэтому задачи разной длины распределяются между
+ * потоками сами, без центральной очереди.
+ *
+ * @see task_pool.cpp
+ */
+
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Пул потоков с перехватом задач
+ *
+ * Типичное использование:
+ * @code
+ * std::vector<std::function<void()>> tasks;
+ * tasks.push_back([&]() { ... });
+ * TaskPool::shared().run(tasks); // возвращается, когда выполнены все задачи
+ * @endcode
+ *
+ * @note run() можно вызывать одновременно из нескольких потоков;
+ *       вызывающий поток тоже выполняет задачи, пока ждет свои
+ */
+class TaskPool {
+private:
+    struct Batch;
+
+    /**
+     * @brief Задача вместе с пакетом, которому она принадлежит
+     */
+    struct Task {
+        const std::function<void()>* body;   ///< Тело задачи (принадлежит вызывающему run())
+        Batch* batch;                        ///< Пакет для учета завершения
+    };
+
+    /**
+     * @brief Очередь задач одного потока
+     */
+    struct Queue {
+        std::mutex mutex;                    ///< Защищает tasks
+        std::deque<Task> tasks;              ///< Свои задачи - с конца, перехват - с начала
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_; ///< Очереди потоков пула
+    std::vector<std::thread> threads_;       ///< Потоки пула
+    std::atomic<size_t> pending_;            ///< Задачи в очередях
+    std::atomic<size_t> next_queue_;         ///< Очередь для следующей раздачи
+    std::atomic<bool> stop_;                 ///< Флаг остановки
+    std::mutex sleep_mutex_;                 ///< Для ожидания задач потоками пула
+    std::condition_variable wake_;           ///< Сигнал о новых задачах
+
+    bool take(size_t home, Task& task);      ///< Своя задача или перехват чужой
+    void execute(const Task& task);          ///< Выполняет задачу и учитывает ее в пакете
+    void worker_loop(size_t index);          ///< Цикл потока пула
+
+    TaskPool(const TaskPool&);               ///< Копирование запрещено
+    TaskPool& operator=(const TaskPool&);    ///< Присваивание запрещено
+
+public:
+    /**
+     * @brief Создает пул
+     *
+     * @param threads Количество потоков пула; 0 - задачи выполняются
+     *        в вызывающем потоке
+     */
+    explicit TaskPool(size_t threads);
+
+    /**
+     * @brief Останавливает потоки пула
+     *
+     * @warning Вызывающие run() к этому моменту должны завершиться
+     */
+    ~TaskPool();
+
+    /**
+     * @brief Количество потоков пула (без вызывающего)
+     */
+    size_t size() const { return threads_.size(); }
+
+    /**
+     * @brief Выполняет задачи и ждет их завершения
+     *
+     * @param tasks Задачи; порядок выполнения не определен
+     *
+     * @details
+     * Задачи раздаются по очередям потоков по кругу. Пока задачи пакета не
+     * завершены, вызывающий поток сам выполняет задачи из очередей.
+     *
+     * @note Исключение из задачи не перехватывается: задачи не должны бросать
+     */
+    void run(const std::vector<std::function<void()>>& tasks);
+
+    /**
+     * @brief Общий пул процесса
+     *
+     * @return TaskPool& Пул из hardware_concurrency() - 1 потоков
+     *         (вызывающий поток - еще один исполнитель), создается при
+     *         первом обращении
+     */
+    static TaskPool& shared();
+};
+
+#endif // TASK_POOL_H
@@ -5,6 +5,9 @@
  * Определяет основные типы данных, используемые в проекте:
  * - Vector для работы с целочисленными векторами
  * - ByteArray для работы с бинарными данными
+ * - Span - невладеющее представление непрерывного массива
+ * - ElementType - тип элементов векторов в запросе
+ * - Operation - операция над векторами запроса
  * 
  * @version 1.0
  * @date 2024
@@ -13,6 +16,7 @@
 #ifndef TYPES_H
 #define TYPES_H
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -31,4 +35,101 @@ using Vector = std::vector<int32_t>;
  */
 using ByteArray = std::vector<uint8_t>;
 
+/**
+ * @brief Невладеющее представление непрерывного массива
+ * 
+ * Аналог std::span (C++20) для C++11: указатель и количество элементов.
+ * Позволяет передавать части одного общего буфера без копирования
+ * и без выделения памяти под каждую часть.
+ * 
+ * @tparam T Тип элементов (const T - только для чтения)
+ * 
+ * @warning Не продлевает время жизни данных
+ */
+template <typename T>
+class Span {
+private:
+    T* data_;      ///< Первый элемент
+    size_t size_;  ///< Количество элементов
+
+public:
+    /**
+     * @brief Пустое представление
+     */
+    Span() : data_(nullptr), size_(0) {}
+    
+    /**
+     * @brief Представление size элементов начиная с data
+     */
+    Span(T* data, size_t size) : data_(data), size_(size) {}
+    
+    /**
+     * @brief Представление всего std::vector (в том числе const T из const вектора)
+     */
+    template <typename U>
+    Span(std::vector<U>& vector) : data_(vector.data()), size_(vector.size()) {}
+    
+    template <typename U>
+    Span(const std::vector<U>& vector) : data_(vector.data()), size_(vector.size()) {}
+    
+    T* data() const { return data_; }            ///< Первый элемент
+    size_t size() const { return size_; }        ///< Количество элементов
+    bool empty() const { return size_ == 0; }    ///< Пусто ли представление
+    T* begin() const { return data_; }           ///< Начало (для range-based for)
+    T* end() const { return data_ + size_; }     ///< Конец
+    T& operator[](size_t index) const { return data_[index]; } ///< Элемент без проверки границ
+    
+    /**
+     * @brief Часть представления
+     * 
+     * @param offset Первый элемент части
+     * @param count Количество элементов части
+     * @return Span<T> Представление [offset, offset + count)
+     */
+    Span<T> subspan(size_t offset, size_t count) const { return Span<T>(data_ + offset, count); }
+};
+
+/**
+ * @brief Тип элементов векторов запроса
+ * 
+ * Передается клиентом в расширенном заголовке запроса (см. ProtocolParser).
+ * Результат каждого вектора имеет тот же тип и размер, что и его элементы.
+ */
+enum class ElementType : uint8_t {
+    Int32 = 0,    ///< int32, накопление в int64 с насыщением до int32 (исходный протокол)
+    Int64 = 1,    ///< int64, накопление в __int128 с насыщением до int64
+    Float32 = 2,  ///< float, накопление в double
+    Float64 = 3   ///< double
+};
+
+/**
+ * @brief Размер элемента в байтах
+ * 
+ * @param type Тип элементов
+ * @return size_t 4 или 8
+ */
+inline size_t element_size(ElementType type) {
+    return (type == ElementType::Int64 || type == ElementType::Float64) ? 8 : 4;
+}
+
+/**
+ * @brief Операция над каждым вектором запроса
+ * 
+ * Передается клиентом в расширенном заголовке запроса (см. ProtocolParser).
+ * Результат имеет тип элементов; целочисленные результаты приводятся
+ * к диапазону типа с насыщением. Исключение - ExactProduct: результат -
+ * целое произвольной длины (см. BigInteger::encode). Для пустого вектора
+ * результат 0.
+ */
+enum class Operation : uint8_t {
+    Product = 0,  ///< Произведение (исходный протокол)
+    Sum = 1,      ///< Сумма
+    Min = 2,      ///< Минимум
+    Max = 3,      ///< Максимум
+    L1 = 4,       ///< Сумма модулей
+    L2 = 5,       ///< Евклидова норма (для целых - округленная)
+    Dot = 6,      ///< Скалярное произведение пар: элементы a0 b0 a1 b1 ...
+    ExactProduct = 7  ///< Точное произведение без насыщения (только целые, см. BigInteger)
+};
+
 #endif
@@ -0,0 +1,110 @@
+/**
+ * @file uring_loop.h
+ * @brief Транспорт на основе io_uring
+ *
+ * Определяет класс UringLoop - альтернативу epoll-циклу Worker, в которой
+ * прием подключений, чтение и запись выполняются через io_uring:
+ * - многоразовый accept (IORING_ACCEPT_MULTISHOT) на слушающем сокете;
+ * - чтение в зарегистрированные буферы (IORING_OP_READ_FIXED);
+ * - отправка результатов (IORING_OP_SEND), последняя отправка связывается
+ *   с закрытием сокета (IOSQE_IO_LINK).
+ *
+ * Кольца создаются напрямую системными вызовами, без liburing.
+ *
+ * @note Требует ядро Linux 5.19+ для многоразового accept; на более старых
+ *       ядрах accept переустанавливается после каждого подключения
+ * @see uring_loop.cpp
+ */
+
+#ifndef URING_LOOP_H
+#define URING_LOOP_H
+
+#include "session.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Logger;
+class ResultCache;
+
+/**
+ * @brief Однопоточный цикл обслуживания сессий через io_uring
+ *
+ * Сессии работают во внешнем режиме ввода-вывода: UringLoop передает им
+ * принятые байты через Session::feed() и забирает результаты через
+ * Session::take_output().
+ *
+ * @warning Класс не является потокобезопасным
+ */
+class UringLoop {
+private:
+    struct Ring;                                         ///< Кольца io_uring (детали в .cpp)
+    struct Connection;                                   ///< Состояние одного подключения
+
+    const CredentialTable& clients_;                     ///< База клиентов (только чтение)
+    Logger& logger_;                                     ///< Логгер
+    ResultCache* cache_;                                 ///< Кэш результатов сессий (nullptr - нет)
+    bool issue_salt_;                                    ///< Сессии выдают клиентам соль
+    std::unique_ptr<Ring> ring_;                         ///< Кольца io_uring
+    int listen_fd_;                                      ///< Слушающий сокет
+    bool multishot_accept_;                              ///< Поддерживается ли многоразовый accept
+    char* fixed_buffers_;                                ///< Зарегистрированные буферы приема
+    std::vector<int> free_buffers_;                      ///< Свободные индексы буферов
+    std::vector<std::unique_ptr<Connection>> connections_; ///< Подключения по идентификатору
+    std::vector<uint32_t> free_ids_;                     ///< Свободные идентификаторы
+
+    void submit_accept();                                ///< Ставит в очередь accept
+    void submit_recv(Connection& conn);                  ///< Ставит в очередь чтение
+    void flush(Connection& conn);                        ///< Отправляет вывод или закрывает
+    void on_accept(int32_t res, uint32_t flags);         ///< Завершение accept
+    void on_recv(Connection& conn, int32_t res);         ///< Завершение чтения
+    void on_send(Connection& conn, int32_t res);         ///< Завершение отправки
+    void on_close(Connection& conn, int32_t res);        ///< Завершение закрытия
+    void release(Connection& conn);                      ///< Освобождает подключение
+    char* buffer_of(Connection& conn);                   ///< Буфер приема подключения
+
+    UringLoop(const UringLoop&);                         ///< Копирование запрещено
+    UringLoop& operator=(const UringLoop&);              ///< Присваивание запрещено
+
+public:
+    /**
+     * @brief Создает кольца и регистрирует буферы приема
+     *
+     * @param clients База данных клиентов
+     * @param logger Логгер для записи событий
+     * @param cache Кэш результатов для сессий (nullptr - без кэша)
+     * @param issue_salt Режим вызов-ответ: соль выдает сервер (см. Session)
+     *
+     * @throw std::runtime_error если io_uring недоступен
+     *
+     * @note Если зарегистрировать буферы не удалось (например, из-за
+     *       RLIMIT_MEMLOCK), чтение выполняется через IORING_OP_RECV
+     */
+    UringLoop(const CredentialTable& clients, Logger& logger,
+              ResultCache* cache = nullptr, bool issue_salt = false);
+
+    /**
+     * @brief Закрывает подключения, освобождает кольца и буферы
+     */
+    ~UringLoop();
+
+    /**
+     * @brief Проверяет, что ядро поддерживает все нужные операции io_uring
+     *
+     * @return bool true если io_uring доступен и поддерживает accept,
+     *         read_fixed, recv, send и close
+     */
+    static bool supported();
+
+    /**
+     * @brief Обслуживает подключения к слушающему сокету до ошибки кольца
+     *
+     * @param listen_fd Слушающий сокет
+     *
+     * @throw std::runtime_error при ошибке io_uring_enter()
+     */
+    void run(int listen_fd);
+};
+
+#endif // URING_LOOP_H
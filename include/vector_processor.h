@@ -6,6 +6,26 @@
  * с контролем переполнения. Предоставляет статические методы для работы
  * как с отдельными векторами, так и с коллекциями векторов.
  * 
+ * Произведение вычисляется сменным вычислительным ядром (ProductKernel):
+ * - scalar   - эталонная поэлементная реализация
+ * - unrolled - блоки по 8 элементов без проверок, пока сумма битовых длин
+ *              (clz) гарантирует отсутствие 64-битного переполнения
+ * - simd     - тот же быстрый путь на SSE2 блоками по 8 элементов
+ * - avx2     - частичные произведения в 4 дорожках AVX2 с оценкой
+ *              битового бюджета блока вместо проверки каждого элемента
+ * - avx512   - то же на AVX-512F: 8 дорожек, блоки по 16 элементов
+ * Все ядра дают побитово одинаковый результат. Ядро выбирается при
+ * старте по возможностям процессора и может быть задано явно (-k).
+ * 
+ * Для элементов int64, float и double (объявляются клиентом в расширенном
+ * заголовке запроса) - BasicVectorProcessor<T> и BasicProductAccumulator<T>;
+ * потоковую свертку любого типа выполняет TypedReduction.
+ * Кроме произведения, в реестре операций (ReductionKernel) собраны сумма,
+ * минимум, максимум, нормы L1/L2 и скалярное произведение пар для всех
+ * типов; сессия выбирает операцию по заголовку запроса (TypedReduction).
+ * Для целых там же точное произведение без насыщения (ExactProduct,
+ * см. big_integer.h).
+ * 
  * @note Все методы статические - не требуется создание экземпляра класса
  * @see vector_processor.cpp
  */
@@ -13,10 +33,53 @@
 #ifndef VECTOR_PROCESSOR_H
 #define VECTOR_PROCESSOR_H
 
+#include "big_integer.h"
 #include "types.h"
+#include <cstddef>
 #include <cstdint>
+#include <string>
+#include <type_traits>
 #include <vector>
 
+class TaskPool;
+struct ReductionKernel;
+
+/**
+ * @brief Состояние свертки произведения
+ * 
+ * Общий формат, с которым работают все ядра: непрерывная свертка
+ * может быть продолжена любым ядром на следующей порции элементов.
+ */
+struct ProductState {
+    int64_t product;      ///< Текущее 64-битное произведение (1 для пустой последовательности)
+    bool saturated;       ///< Произошло 64-битное переполнение, результат известен
+    int32_t saturation;   ///< Результат при переполнении (INT32_MAX или INT32_MIN)
+};
+
+/**
+ * @brief Вычислительное ядро произведения
+ */
+struct ProductKernel {
+    const char* name;     ///< Имя ядра (для -k и логов)
+    
+    /**
+     * @brief Проверяет, поддерживает ли процессор это ядро
+     */
+    bool (*supported)();
+    
+    /**
+     * @brief Сворачивает count элементов в state
+     * 
+     * @param state Состояние (не должно быть saturated)
+     * @param data Элементы по 4 байта, выравнивание не требуется
+     * @param count Количество элементов
+     * 
+     * @note При переполнении устанавливает state.saturated и сразу возвращается;
+     *       так же сразу возвращается, как только произведение стало 0
+     */
+    void (*fold)(ProductState& state, const void* data, size_t count);
+};
+
 /**
  * @brief Класс для векторных вычислений
  * 
@@ -45,6 +108,31 @@ public:
      */
     static int32_t calculate_product(const Vector& vector);
     
+    /**
+     * @brief Вычисляет произведение элементов массива
+     * 
+     * @param data Элементы по 4 байта, выравнивание не требуется
+     * @param count Количество элементов
+     * @return int32_t Произведение (см. calculate_product(const Vector&))
+     */
+    static int32_t calculate_product(const void* data, size_t count);
+    
+    /**
+     * @brief Вычисляет произведение элементов массива на заданном пуле
+     * 
+     * @param data Элементы по 4 байта, выравнивание не требуется
+     * @param count Количество элементов
+     * @param pool Пул потоков
+     * @return int32_t Произведение, побитово совпадающее с последовательной сверткой
+     * 
+     * @details
+     * Массив из reduction_threshold() и более элементов сворачивается
+     * параллельно по частям (см. ProductAccumulator::add_parallel()),
+     * более короткий - активным ядром в вызывающем потоке.
+     * calculate_product(data, count) использует TaskPool::shared().
+     */
+    static int32_t calculate_product(const void* data, size_t count, TaskPool& pool);
+    
     /**
      * @brief Вычисляет произведения для коллекции векторов
      * 
@@ -55,9 +143,521 @@ public:
      * Применяет calculate_product() к каждому вектору в коллекции.
      * Сохраняет порядок результатов соответствующим порядку входных векторов.
      * 
+     * Если элементов в коллекции не меньше parallel_threshold(), векторы
+     * обрабатываются параллельно на TaskPool::shared().
+     * 
      * @note Время выполнения: O(total_elements), где total_elements - сумма размеров всех векторов
      */
     static std::vector<int32_t> multiply_vectors(const std::vector<Vector>& vectors);
+    
+    /**
+     * @brief Вычисляет произведения для коллекции векторов на заданном пуле
+     * 
+     * @param vectors Коллекция векторов для обработки
+     * @param pool Пул потоков
+     * @return std::vector<int32_t> Произведения в порядке входных векторов
+     * 
+     * @details
+     * Коллекция делится на непрерывные диапазоны векторов с примерно равным
+     * количеством элементов. Диапазонов в несколько раз больше, чем
+     * исполнителей: потоки, закончившие раньше, перехватывают оставшиеся, так
+     * что векторы сильно разной длины не создают перекоса. Каждая задача
+     * пишет результаты в свои позиции, поэтому порядок сохраняется.
+     * Меньше parallel_threshold() элементов обрабатываются последовательно.
+     */
+    static std::vector<int32_t> multiply_vectors(const std::vector<Vector>& vectors, TaskPool& pool);
+    
+    /**
+     * @brief Вычисляет произведения для пакета в плоском формате (CSR)
+     * 
+     * @param elements Элементы всех векторов подряд
+     * @param offsets Границы векторов: вектор i - элементы
+     *        [offsets[i], offsets[i + 1]); записей на одну больше, чем векторов
+     * @param results Сюда записывается произведение каждого вектора
+     * 
+     * @details
+     * В отличие от multiply_vectors(const std::vector<Vector>&) не требует
+     * отдельного выделения памяти под каждый вектор: весь пакет - три
+     * непрерывных массива, принадлежащих вызывающей стороне. Параллельная
+     * обработка - как у multiply_vectors() (порог parallel_threshold()).
+     * 
+     * @code
+     * std::vector<int32_t> elements = {1, 2, 3, 4, 5};
+     * std::vector<size_t> offsets = {0, 2, 2, 5};   // {1, 2}, {}, {3, 4, 5}
+     * std::vector<int32_t> results(3);
+     * VectorProcessor::multiply_vectors(elements, offsets, results); // {2, 0, 60}
+     * @endcode
+     * 
+     * @throw std::invalid_argument если offsets.size() != results.size() + 1,
+     *        границы убывают или выходят за elements
+     */
+    static void multiply_vectors(Span<const int32_t> elements, Span<const size_t> offsets,
+                                 Span<int32_t> results);
+    
+    /**
+     * @brief То же на заданном пуле потоков
+     */
+    static void multiply_vectors(Span<const int32_t> elements, Span<const size_t> offsets,
+                                 Span<int32_t> results, TaskPool& pool);
+    
+    /**
+     * @brief Задает порог параллельной свертки одного вектора
+     * 
+     * @param elements Минимальный размер вектора, начиная с которого его
+     *        произведение вычисляется параллельно (по умолчанию 4M элементов)
+     * 
+     * @warning Не потокобезопасен: вызывается при старте, до запуска рабочих потоков
+     */
+    static void set_reduction_threshold(size_t elements);
+    
+    /**
+     * @brief Возвращает порог параллельной свертки одного вектора (в элементах)
+     */
+    static size_t reduction_threshold();
+    
+    /**
+     * @brief Задает порог параллельной обработки
+     * 
+     * @param elements Минимальное суммарное количество элементов, начиная
+     *        с которого коллекция обрабатывается параллельно
+     * 
+     * @warning Не потокобезопасен: вызывается при старте, до запуска рабочих потоков
+     */
+    static void set_parallel_threshold(size_t elements);
+    
+    /**
+     * @brief Возвращает порог параллельной обработки (в элементах)
+     */
+    static size_t parallel_threshold();
+    
+    /**
+     * @brief Возвращает активное ядро
+     * 
+     * @note До вызова select_kernel() активно лучшее ядро для этого процессора
+     */
+    static const ProductKernel& kernel();
+    
+    /**
+     * @brief Выбирает активное ядро
+     * 
+     * @param name Имя ядра или "auto" - лучшее из поддерживаемых
+     * @return bool false если ядро неизвестно или не поддерживается процессором
+     * 
+     * @warning Не потокобезопасен: вызывается при старте, до запуска рабочих потоков
+     */
+    static bool select_kernel(const std::string& name);
+    
+    /**
+     * @brief Возвращает все ядра, собранные в программе
+     * 
+     * @return std::vector<const ProductKernel*> Ядра от эталонного к самому быстрому
+     */
+    static std::vector<const ProductKernel*> kernels();
+    
+    /**
+     * @brief Ищет операцию в реестре
+     * 
+     * @param operation Операция
+     * @param type Тип элементов
+     * @return const ReductionKernel* Реализация или nullptr, если такой
+     *         операции для этого типа нет
+     */
+    static const ReductionKernel* reduction(Operation operation, ElementType type);
+    
+    /**
+     * @brief Возвращает все операции реестра
+     */
+    static std::vector<const ReductionKernel*> reductions();
+    
+    /**
+     * @brief Точное произведение элементов без насыщения
+     * 
+     * @param vector Вектор
+     * @return BigInteger Произведение (0 для пустого вектора)
+     * 
+     * @details
+     * Дерево произведений с попарным объединением и умножением Карацубы
+     * (см. ExactProductAccumulator): вектор из тысяч элементов - это
+     * результат в десятки килобит, который считается за миллисекунды.
+     */
+    static BigInteger exact_product(const std::vector<int32_t>& vector);
+    
+private:
+    /**
+     * @brief Реализация multiply_vectors() для коллекции
+     * 
+     * @param workers Пул потоков или nullptr - общий пул, который
+     *        создается только если коллекция не меньше parallel_threshold()
+     */
+    static std::vector<int32_t> multiply_collection(const std::vector<Vector>& vectors, TaskPool* workers);
+    
+    /**
+     * @brief Реализация multiply_vectors() для плоского формата
+     */
+    static void multiply_flat(Span<const int32_t> elements, Span<const size_t> offsets,
+                              Span<int32_t> results, TaskPool* workers);
+};
+
+/**
+ * @brief Типы накопления и результата произведения для типа элементов
+ * 
+ * @tparam T Тип элементов
+ */
+template <typename T>
+struct ProductTraits;
+
+/// int32: накопление в int64, насыщение до int32
+template <>
+struct ProductTraits<int32_t> {
+    typedef int64_t Accumulator;
+    typedef int32_t Result;
+};
+
+/// int64: накопление в __int128, насыщение до int64
+template <>
+struct ProductTraits<int64_t> {
+    typedef __int128 Accumulator;
+    typedef int64_t Result;
+};
+
+/// float: накопление в double, результат округляется до float
+template <>
+struct ProductTraits<float> {
+    typedef double Accumulator;
+    typedef float Result;
+};
+
+/// double: накопление в double
+template <>
+struct ProductTraits<double> {
+    typedef double Accumulator;
+    typedef double Result;
+};
+
+/**
+ * @brief Потоковое вычисление произведения для элементов типа T
+ * 
+ * @tparam T Тип элементов
+ * @tparam Accumulator Тип промежуточного произведения
+ * @tparam Floating Выбор реализации: целочисленная с насыщением или
+ *         с плавающей точкой
+ * 
+ * Реализации выбираются при компиляции:
+ * - BasicProductAccumulator<int32_t> (ProductAccumulator) - сменные ядра
+ *   VectorProcessor, параллельная свертка;
+ * - целочисленная - те же правила насыщения, что и для int32: при выходе
+ *   |произведения| за пределы Accumulator результат фиксируется как
+ *   максимум или минимум T по знакам сомножителей, остальные элементы
+ *   игнорируются; в конце результат приводится к диапазону T;
+ * - с плавающей точкой - произведение по правилам IEEE 754 в 8 дорожках:
+ *   элемент с номером i умножается в дорожку i % 8, дорожки объединяются
+ *   в фиксированном порядке. Скалярная и SIMD-реализации выполняют одни и
+ *   те же умножения, поэтому результат от реализации не зависит.
+ * 
+ * Для пустой последовательности результат 0.
+ */
+template <typename T, typename Accumulator = typename ProductTraits<T>::Accumulator,
+          bool Floating = std::is_floating_point<T>::value>
+class BasicProductAccumulator;
+
+/**
+ * @brief Потоковое вычисление произведения int32
+ * 
+ * Сворачивает элементы в произведение по мере их поступления, не требуя
+ * хранить вектор целиком. Результат совпадает с VectorProcessor::calculate_product()
+ * для той же последовательности элементов, в том числе при переполнении.
+ * 
+ * @code
+ * ProductAccumulator acc;
+ * acc.add(chunk1, count1);
+ * acc.add(chunk2, count2);
+ * int32_t product = acc.result();
+ * @endcode
+ */
+template <>
+class BasicProductAccumulator<int32_t, int64_t, false> {
+private:
+    ProductState state_;  ///< Состояние свертки
+    bool empty_;          ///< Элементов еще не было
+
+public:
+    /**
+     * @brief Создает аккумулятор для пустой последовательности
+     */
+    BasicProductAccumulator() { reset(); }
+    
+    /**
+     * @brief Начинает новую последовательность
+     */
+    void reset();
+    
+    /**
+     * @brief Добавляет один элемент
+     * 
+     * @param value Элемент
+     * 
+     * @note После переполнения последующие элементы игнорируются
+     */
+    void add(int32_t value);
+    
+    /**
+     * @brief Добавляет элементы активным ядром
+     * 
+     * @param data Элементы (по 4 байта, без выравнивания)
+     * @param count Количество элементов
+     */
+    void add(const char* data, size_t count);
+    
+    /**
+     * @brief Добавляет элементы, сворачивая их части параллельно
+     * 
+     * @param data Элементы (по 4 байта, без выравнивания)
+     * @param count Количество элементов
+     * @param pool Пул потоков
+     * 
+     * @details
+     * Каждая часть сворачивается независимо: точное произведение части,
+     * либо признак того, что в ней есть 0 или переполнение. Точные
+     * частичные произведения объединяются умножением с той же проверкой
+     * переполнения, что и при поэлементной свертке; часть с нулем или
+     * переполнением сворачивается заново от накопленного произведения.
+     * Результат побитово совпадает с add(data, count).
+     */
+    void add_parallel(const char* data, size_t count, TaskPool& pool);
+    
+    /**
+     * @brief Возвращает произведение, приведенное к диапазону int32
+     * 
+     * @return int32_t 0 для пустой последовательности, INT32_MAX/INT32_MIN
+     *         при переполнении
+     */
+    int32_t result() const;
+    
+    /**
+     * @brief Проверяет, что результат уже не зависит от следующих элементов
+     * 
+     * @return bool true, если произошло переполнение или произведение стало 0
+     * 
+     * @details
+     * После переполнения элементы игнорируются (знак насыщения фиксируется в
+     * момент переполнения), а нулевое произведение не меняется. Поэтому
+     * вызывающая сторона может не передавать оставшиеся элементы.
+     */
+    bool decided() const;
+};
+
+/**
+ * @brief Аккумулятор произведения int32 (исходный протокол)
+ */
+typedef BasicProductAccumulator<int32_t> ProductAccumulator;
+
+/**
+ * @brief Целочисленное произведение с насыщением (int64 с накоплением в __int128)
+ * 
+ * @details
+ * Как и ядра int32, блок из 4 элементов умножается без проверок, если
+ * сумма их битовых длин гарантирует отсутствие переполнения Accumulator;
+ * иначе элементы проходят поэлементную проверку с делением.
+ */
+template <typename T, typename Accumulator>
+class BasicProductAccumulator<T, Accumulator, false> {
+private:
+    Accumulator product_; ///< Текущее произведение
+    bool saturated_;      ///< Произошло переполнение
+    T saturation_;        ///< Результат при переполнении
+    bool empty_;          ///< Элементов еще не было
+    
+    bool step(T value);   ///< Один элемент с проверкой; false при переполнении
+
+public:
+    BasicProductAccumulator() { reset(); }
+    
+    void reset();                                ///< Начинает новую последовательность
+    void add(T value);                           ///< Добавляет один элемент
+    void add(const char* data, size_t count);    ///< Добавляет элементы (без выравнивания)
+    T result() const;                            ///< Произведение в диапазоне T
+    bool decided() const;                        ///< Переполнение или 0
+};
+
+/**
+ * @brief Произведение с плавающей точкой в 8 дорожках
+ * 
+ * @details
+ * SIMD-реализация (AVX) выбирается при старте по возможностям процессора
+ * и дает тот же результат, что и скалярная.
+ */
+template <typename T, typename Accumulator>
+class BasicProductAccumulator<T, Accumulator, true> {
+public:
+    static const size_t kLanes = 8;              ///< Количество дорожек
+
+private:
+    Accumulator lanes_[kLanes];                  ///< Произведения дорожек
+    size_t position_;                            ///< Дорожка следующего элемента
+    bool empty_;                                 ///< Элементов еще не было
+
+public:
+    BasicProductAccumulator() { reset(); }
+    
+    void reset();                                ///< Начинает новую последовательность
+    void add(T value);                           ///< Добавляет один элемент
+    void add(const char* data, size_t count);    ///< Добавляет элементы (без выравнивания)
+    T result() const;                            ///< Произведение, приведенное к T
+    
+    /**
+     * @brief Результат уже не зависит от следующих элементов
+     * 
+     * @return bool true, если в какой-либо дорожке NaN
+     * 
+     * @note Ноль не окончателен: 0 * inf = NaN
+     */
+    bool decided() const;
+};
+
+/**
+ * @brief Вычисление произведений для элементов типа T
+ * 
+ * @tparam T Тип элементов (int32_t, int64_t, float, double)
+ * 
+ * @note Для int32_t результат совпадает с VectorProcessor::calculate_product()
+ */
+template <typename T>
+class BasicVectorProcessor {
+public:
+    typedef typename ProductTraits<T>::Result Result;
+    
+    /**
+     * @brief Произведение элементов вектора
+     */
+    static Result calculate_product(const std::vector<T>& vector) {
+        return calculate_product(vector.data(), vector.size());
+    }
+    
+    /**
+     * @brief Произведение count элементов по 4 или 8 байт без выравнивания
+     */
+    static Result calculate_product(const void* data, size_t count) {
+        BasicProductAccumulator<T> accumulator;
+        accumulator.add(static_cast<const char*>(data), count);
+        return accumulator.result();
+    }
+};
+
+/**
+ * @brief Память под состояние любой операции реестра
+ * 
+ * Состояние конкретной операции (аккумулятор для своего типа элементов)
+ * размещается в storage функцией ReductionKernel::reset; остальные
+ * функции операции знают его тип при компиляции.
+ */
+struct ReductionState {
+    alignas(16) unsigned char storage[96];  ///< Аккумулятор операции
+};
+
+/**
+ * @brief Операция реестра для одного типа элементов
+ * 
+ * Как и ProductKernel, это таблица указателей на функции, собранных для
+ * конкретных операции и типа: выбор выполняется один раз на порцию
+ * элементов, внутри add() цикл по элементам без косвенных вызовов.
+ */
+struct ReductionKernel {
+    Operation operation;  ///< Операция
+    ElementType type;     ///< Тип элементов (и результата)
+    const char* name;     ///< Имя операции (для логов)
+    
+    void (*reset)(ReductionState& state);                                ///< Начинает новый вектор
+    void (*destroy)(ReductionState& state);                              ///< Освобождает состояние
+    void (*add)(ReductionState& state, const char* data, size_t count);  ///< Добавляет элементы
+    bool (*decided)(const ReductionState& state);                        ///< Результат окончателен
+    
+    /**
+     * @brief Дописывает результат в формате протокола
+     * 
+     * @details
+     * Машинное представление element_size(type) байт; для ExactProduct -
+     * целое с префиксом длины (BigInteger::encode).
+     */
+    void (*result)(const ReductionState& state, std::string& out);
+    
+    std::string (*format)(const ReductionState& state);                  ///< Результат для лога
+};
+
+/**
+ * @brief Операция над вектором, выбранная во время выполнения
+ * 
+ * Используется сессией: операция и тип элементов объявляются клиентом в
+ * заголовке запроса, реализация берется из реестра VectorProcessor.
+ * 
+ * @code
+ * TypedReduction reduction(Operation::Sum, ElementType::Int64);
+ * reduction.add(chunk, count);
+ * std::string result;
+ * reduction.result(result);
+ * @endcode
+ */
+class TypedReduction {
+private:
+    const ReductionKernel* kernel_;  ///< Операция из реестра
+    ReductionState state_;           ///< Ее состояние
+    
+    TypedReduction(const TypedReduction&);             ///< Копирование запрещено
+    TypedReduction& operator=(const TypedReduction&);  ///< Присваивание запрещено
+
+public:
+    /**
+     * @brief Создает операцию для пустой последовательности
+     * 
+     * @throw std::invalid_argument если операции нет в реестре
+     */
+    explicit TypedReduction(Operation operation = Operation::Product,
+                            ElementType type = ElementType::Int32) : kernel_(nullptr) {
+        reset(operation, type);
+    }
+    
+    ~TypedReduction() { kernel_->destroy(state_); }
+    
+    /**
+     * @brief Начинает новую последовательность
+     * 
+     * @param operation Операция
+     * @param type Тип элементов
+     * @throw std::invalid_argument если операции нет в реестре
+     */
+    void reset(Operation operation, ElementType type);
+    
+    /**
+     * @brief Начинает новую последовательность для той же операции
+     */
+    void reset() {
+        kernel_->destroy(state_);
+        kernel_->reset(state_);
+    }
+    
+    const ReductionKernel& kernel() const { return *kernel_; }  ///< Выбранная операция
+    ElementType type() const { return kernel_->type; }          ///< Тип элементов
+    
+    /**
+     * @brief Добавляет count элементов (по element_size(type()) байт)
+     */
+    void add(const char* data, size_t count) { kernel_->add(state_, data, count); }
+    
+    /**
+     * @brief Результат уже не зависит от следующих элементов
+     */
+    bool decided() const { return kernel_->decided(state_); }
+    
+    /**
+     * @brief Дописывает результат в формате протокола
+     * 
+     * @param out Буфер вывода
+     */
+    void result(std::string& out) const { kernel_->result(state_, out); }
+    
+    /**
+     * @brief Результат в текстовом виде (для лога)
+     */
+    std::string result_string() const { return kernel_->format(state_); }
 };
 
 #endif
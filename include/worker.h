@@ -0,0 +1,145 @@
+/**
+ * @file worker.h
+ * @brief Рабочий поток с собственным событийным циклом
+ *
+ * Определяет класс Worker - событийный цикл epoll вместе с набором
+ * обслуживаемых им сессий. Сервер создает один Worker (однопоточный режим)
+ * или пул из нескольких Worker, каждый в своем потоке.
+ *
+ * @see worker.cpp
+ */
+
+#ifndef WORKER_H
+#define WORKER_H
+
+#include "auth_batch.h"
+#include "bounded_queue.h"
+#include "event_loop.h"
+#include "session.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class Logger;
+class ResultCache;
+
+/**
+ * @brief Событийный цикл с набором клиентских сессий
+ *
+ * Источники подключений:
+ * - собственный слушающий сокет (listen_on()) - подключения принимаются
+ *   в потоке этого Worker;
+ * - очередь входящих сокетов (submit()) - подключения передаются из
+ *   другого потока через BoundedQueue с пробуждением через eventfd.
+ *
+ * С пакетной проверкой аутентификации сессии ставят MD5 в общий для
+ * Worker AuthBatcher; цикл ждет событий не дольше срока самой старой
+ * проверки и проверяет пакет, когда он заполнен или срок истек.
+ *
+ * @note Сессии Worker создаются, обслуживаются и закрываются только в его
+ *       собственном потоке; из других потоков допустимы лишь submit() и stop()
+ */
+class Worker {
+private:
+    const CredentialTable& clients_;                     ///< База клиентов (только чтение)
+    Logger& logger_;                                     ///< Логгер
+    ResultCache* cache_;                                 ///< Кэш результатов сессий (nullptr - нет)
+    std::unique_ptr<AuthBatcher> auth_;                  ///< Пакетная проверка MD5 (пусто - выключена)
+    bool issue_salt_;                                    ///< Сессии выдают клиентам соль
+    EventLoop loop_;                                     ///< Событийный цикл (epoll)
+    std::unordered_map<int, std::unique_ptr<Session>> sessions_; ///< Активные сессии по сокету
+    std::vector<int> ready_;                             ///< Сессии, исчерпавшие бюджет чтения
+    std::vector<int> serving_;                           ///< Обслуживаемая часть ready_
+    BoundedQueue<int> inbox_;                            ///< Сокеты, переданные другим потоком
+    int wake_fd_;                                        ///< eventfd для пробуждения цикла
+    int listen_fd_;                                      ///< Слушающий сокет (-1 если нет)
+    std::function<void(int)> handoff_;                   ///< Куда передавать принятые сокеты
+    std::atomic<bool> stop_;                             ///< Флаг остановки цикла
+    std::thread thread_;                                 ///< Поток, если запущен через start()
+
+    void accept_pending();                               ///< Принимает ожидающие подключения
+    void drain_inbox();                                  ///< Забирает сокеты из очереди
+    void adopt(int client_socket);                       ///< Создает сессию для сокета
+    void close_session(int client_socket);               ///< Закрывает сессию
+    void settle(int client_socket, Session& session, bool alive); ///< Закрывает сессию или ставит в ready_
+    void verify_batch();                                 ///< Проверяет пакет и возобновляет сессии
+
+    Worker(const Worker&);                               ///< Копирование запрещено
+    Worker& operator=(const Worker&);                    ///< Присваивание запрещено
+
+public:
+    /**
+     * @brief Конструктор
+     *
+     * @param clients База данных клиентов
+     * @param logger Логгер для записи событий
+     * @param queue_capacity Емкость очереди входящих сокетов
+     * @param cache Кэш результатов для сессий этого Worker (nullptr - без кэша)
+     * @param auth_batch_us Срок пакетной проверки аутентификации в мкс
+     *        (0 - MD5 вычисляется сессией сразу)
+     * @param issue_salt Режим вызов-ответ: соль выдает сервер (см. Session)
+     *
+     * @throw std::runtime_error если не удалось создать epoll или eventfd
+     */
+    Worker(const CredentialTable& clients, Logger& logger,
+           size_t queue_capacity, ResultCache* cache = nullptr, int auth_batch_us = 0,
+           bool issue_salt = false);
+
+    /**
+     * @brief Останавливает поток (если запущен) и закрывает все сессии
+     */
+    ~Worker();
+
+    /**
+     * @brief Регистрирует слушающий сокет в цикле этого Worker
+     *
+     * @param listen_fd Неблокирующий слушающий сокет
+     * @param handoff Обработчик принятых сокетов; если пуст, сессии
+     *        создаются в этом же Worker
+     */
+    void listen_on(int listen_fd, std::function<void(int)> handoff = std::function<void(int)>());
+
+    /**
+     * @brief Передает клиентский сокет в очередь Worker
+     *
+     * @param client_socket Неблокирующий сокет клиента
+     * @param wait Ждать освобождения места, если очередь заполнена
+     * @return bool false если очередь заполнена и wait == false
+     *
+     * @note Потокобезопасен
+     */
+    bool submit(int client_socket, bool wait);
+
+    /**
+     * @brief Выполняет событийный цикл в текущем потоке до вызова stop()
+     */
+    void run();
+
+    /**
+     * @brief Запускает run() в отдельном потоке
+     *
+     * @param cpu Номер ядра, за которым закрепляется поток (-1 - не закреплять)
+     */
+    void start(int cpu = -1);
+
+    /**
+     * @brief Просит цикл завершиться и дожидается потока
+     *
+     * @note Потокобезопасен
+     */
+    void stop();
+};
+
+/**
+ * @brief Закрепляет текущий поток за ядром процессора
+ *
+ * @param cpu Номер ядра
+ * @return bool false если закрепить не удалось
+ */
+bool pin_to_cpu(int cpu);
+
+#endif // WORKER_H
@@ -3,7 +3,7 @@
  * @brief Реализация методов аутентификации
  * 
  * Содержит реализацию методов класса Authenticator:
- * - генерация случайной соли
+ * - генерация случайной соли из буферизованного источника getrandom()
  * - вычисление MD5 хэшей
  * - проверка учетных данных клиентов
  * 
@@ -12,9 +12,95 @@
 
 #include "../include/auth.h"
 #include <openssl/md5.h>
-#include <sstream>
-#include <iomanip>
-#include <random>
+#include <sys/random.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+const char kHexLower[] = "0123456789abcdef";
+const char kHexUpper[] = "0123456789ABCDEF";
+
+/**
+ * @brief Буфер случайных байт потока
+ * 
+ * @details
+ * Заполняется одним вызовом getrandom() (CSPRNG ядра) на 4 КБ, то есть
+ * на 512 солей. Выданные байты сразу затираются, чтобы уже
+ * использованные соли нельзя было восстановить из памяти процесса.
+ * 
+ * @note Буфер свой у каждого потока, блокировки не нужны. После fork()
+ *       дочерний процесс получил бы копию буфера; сервер не создает
+ *       процессов
+ */
+class RandomPool {
+private:
+    unsigned char buffer_[4096];  ///< Случайные байты
+    size_t position_;             ///< Первый невыданный байт
+
+    /**
+     * @brief Заполняет буфер заново
+     * 
+     * @throw std::runtime_error если getrandom() недоступен
+     */
+    void refill() {
+        size_t filled = 0;
+        while (filled < sizeof(buffer_)) {
+            ssize_t result = getrandom(buffer_ + filled, sizeof(buffer_) - filled, 0);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error("getrandom failed");
+            }
+            filled += static_cast<size_t>(result);
+        }
+        position_ = 0;
+    }
+
+public:
+    RandomPool() : position_(sizeof(buffer_)) {}
+
+    ~RandomPool() {
+        memset(buffer_, 0, sizeof(buffer_));
+    }
+
+    /**
+     * @brief Выдает length случайных байт
+     */
+    void read(unsigned char* out, size_t length) {
+        while (length > 0) {
+            if (position_ == sizeof(buffer_)) {
+                refill();
+            }
+            size_t chunk = std::min(length, sizeof(buffer_) - position_);
+            memcpy(out, buffer_ + position_, chunk);
+            memset(buffer_ + position_, 0, chunk);
+            position_ += chunk;
+            out += chunk;
+            length -= chunk;
+        }
+    }
+};
+
+thread_local RandomPool random_pool;
+
+/**
+ * @brief Значение hex-цифры или 0xFF для прочих символов
+ */
+inline unsigned hex_value(char c) {
+    unsigned char u = static_cast<unsigned char>(c);
+    unsigned digit = static_cast<unsigned char>(u - '0');
+    if (digit < 10) {
+        return digit;
+    }
+    unsigned letter = static_cast<unsigned char>((u | 0x20) - 'a');
+    return letter < 6 ? letter + 10 : 0xFF;
+}
+
+} // namespace
 
 /**
  * @brief Генерирует 64-битную соль в виде 16 hex символов
@@ -23,22 +109,35 @@
  * 
  * @details
  * Алгоритм:
- * 1. Создает генератор случайных чисел на основе std::random_device
- * 2. Генерирует 64-битное случайное число
- * 3. Конвертирует в hex строку с заполнением нулями
+ * 1. Берет 8 байт из буфера случайных байт потока (random_bytes())
+ * 2. Записывает их в hex по таблице
  * 
- * @note Использует Mersenne Twister для генерации псевдослучайных чисел
+ * @throw std::runtime_error если getrandom() недоступен
  */
 std::string Authenticator::generate_salt_16() {
-    std::random_device rd;
-    std::mt19937_64 gen(rd());
-    std::uniform_int_distribution<uint64_t> dis;
-    
-    uint64_t salt = dis(gen);
+    unsigned char salt[8];
+    random_bytes(salt, sizeof(salt));
     
-    std::stringstream ss;
-    ss << std::hex << std::uppercase << std::setw(16) << std::setfill('0') << salt;
-    return ss.str();
+    char hex[2 * sizeof(salt)];
+    hex_encode(salt, sizeof(salt), hex);
+    return std::string(hex, sizeof(hex));
+}
+
+/**
+ * @brief Криптостойкие случайные байты
+ * 
+ * @param out Буфер
+ * @param length Количество байт
+ * 
+ * @details
+ * Байты берутся из буфера потока, который пополняется getrandom()
+ * порциями по 4 КБ: системный вызов приходится на сотни солей, а не
+ * на каждую.
+ * 
+ * @throw std::runtime_error если getrandom() недоступен
+ */
+void Authenticator::random_bytes(unsigned char* out, size_t length) {
+    random_pool.read(out, length);
 }
 
 /**
@@ -56,18 +155,85 @@ std::string Authenticator::generate_salt_16() {
  */
 std::string Authenticator::calculate_md5_hash(const std::string& salt, 
                                             const std::string& password) {
-    std::string data = salt + password;
-    
-    unsigned char hash[MD5_DIGEST_LENGTH];
-    MD5(reinterpret_cast<const unsigned char*>(data.c_str()), data.length(), hash);
+    unsigned char hash[kDigestLength];
+    md5_digest(salt, password, hash);
     
-    std::stringstream ss;
-    ss << std::hex << std::uppercase;
-    for (int i = 0; i < MD5_DIGEST_LENGTH; i++) {
-        ss << std::setw(2) << std::setfill('0') << static_cast<int>(hash[i]);
+    char hex[2 * kDigestLength];
+    hex_encode(hash, kDigestLength, hex);
+    return std::string(hex, sizeof(hex));
+}
+
+/**
+ * @brief Вычисляет MD5 от соли и пароля
+ * 
+ * @param salt Соль
+ * @param password Пароль
+ * @param digest Буфер для дайджеста
+ * 
+ * @details
+ * Соль и пароль передаются в MD5 двумя порциями, поэтому строка
+ * salt + password не создается.
+ */
+void Authenticator::md5_digest(const std::string& salt, const std::string& password,
+                               unsigned char* digest) {
+    md5_digest(salt, password.data(), password.size(), digest);
+}
+
+/**
+ * @brief Вычисляет MD5 от соли и пароля, заданного указателем и длиной
+ * 
+ * @param salt Соль
+ * @param password Пароль
+ * @param password_length Длина пароля
+ * @param digest Буфер для дайджеста
+ */
+void Authenticator::md5_digest(const std::string& salt, const char* password, size_t password_length,
+                               unsigned char* digest) {
+    MD5_CTX context;
+    MD5_Init(&context);
+    MD5_Update(&context, salt.data(), salt.size());
+    MD5_Update(&context, password, password_length);
+    MD5_Final(digest, &context);
+}
+
+/**
+ * @brief Hex-запись байт
+ * 
+ * @param data Байты
+ * @param length Количество байт
+ * @param out Буфер для 2 * length символов
+ * @param uppercase Регистр букв
+ */
+void Authenticator::hex_encode(const unsigned char* data, size_t length, char* out, bool uppercase) {
+    const char* digits = uppercase ? kHexUpper : kHexLower;
+    for (size_t i = 0; i < length; i++) {
+        out[2 * i] = digits[data[i] >> 4];
+        out[2 * i + 1] = digits[data[i] & 0x0F];
     }
-    
-    return ss.str();
+}
+
+/**
+ * @brief Сравнение hex-записи с дайджестом
+ * 
+ * @param digest Дайджест
+ * @param hex Hex-запись
+ * @return bool true при совпадении
+ * 
+ * @details
+ * Hex-запись декодируется по парам символов и сравнивается с байтами
+ * дайджеста; расхождения накапливаются без раннего выхода.
+ */
+bool Authenticator::digest_matches(const unsigned char* digest, const std::string& hex) {
+    if (hex.size() != 2 * kDigestLength) {
+        return false;
+    }
+    unsigned difference = 0;
+    for (size_t i = 0; i < kDigestLength; i++) {
+        unsigned high = hex_value(hex[2 * i]);
+        unsigned low = hex_value(hex[2 * i + 1]);
+        difference |= ((high | low) & 0xF0) | (((high << 4) | low) ^ digest[i]);
+    }
+    return difference == 0;
 }
 
 /**
@@ -90,12 +256,13 @@ std::string Authenticator::calculate_md5_hash(const std::string& salt,
 bool Authenticator::verify_client(const std::string& login, 
                                 const std::string& received_hash, 
                                 const std::string& salt, 
-                                const std::unordered_map<std::string, std::string>& clients) {
-    auto it = clients.find(login);
-    if (it == clients.end()) {
+                                const CredentialTable& clients) {
+    CredentialTable::View password;
+    if (!clients.find(login, password)) {
         return false;
     }
     
-    std::string calculated_hash = calculate_md5_hash(salt, it->second);
-    return calculated_hash == received_hash;
+    unsigned char digest[kDigestLength];
+    md5_digest(salt, password.data, password.size, digest);
+    return digest_matches(digest, received_hash);
 }
@@ -0,0 +1,414 @@
+/**
+ * @file auth_batch.cpp
+ * @brief Реализация многобуферного MD5 и пакетной проверки аутентификации
+ *
+ * @see auth_batch.h
+ */
+
+#include "../include/auth_batch.h"
+#include "../include/auth.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define AUTH_BATCH_X86 1
+#endif
+
+namespace {
+
+/**
+ * @brief Сдвиги шагов MD5 (RFC 1321)
+ */
+const unsigned kShift[64] = {
+    7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+    5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20,
+    4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+    6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21
+};
+
+/**
+ * @brief Константы шагов MD5: floor(2^32 * |sin(i + 1)|)
+ */
+const uint32_t kConstant[64] = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+};
+
+const uint32_t kInitial[4] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476};
+
+/**
+ * @brief Количество 64-байтных блоков сообщения длины length с дополнением
+ */
+inline size_t block_count(size_t length) {
+    return (length + 8) / 64 + 1;
+}
+
+/**
+ * @brief Блок number дополненного сообщения salt + password
+ *
+ * @param input Сообщение
+ * @param number Номер блока
+ * @param block Буфер на 64 байта
+ *
+ * @details
+ * Сообщение не склеивается: в блок копируются попавшие в него части соли
+ * и пароля, байт 0x80 сразу за сообщением и, в последнем блоке, длина
+ * сообщения в битах.
+ */
+void fill_block(const Md5Input& input, size_t number, unsigned char* block) {
+    const std::string& salt = *input.salt;
+    size_t length = salt.size() + input.password_length;
+    size_t begin = number * 64;
+    size_t end = begin + 64;
+
+    std::memset(block, 0, 64);
+    if (begin < salt.size()) {
+        std::memcpy(block, salt.data() + begin, std::min(end, salt.size()) - begin);
+    }
+    size_t from = std::max(begin, salt.size());
+    size_t to = std::min(end, length);
+    if (from < to) {
+        std::memcpy(block + (from - begin), input.password + (from - salt.size()), to - from);
+    }
+    if (length >= begin && length < end) {
+        block[length - begin] = 0x80;
+    }
+    if (number + 1 == block_count(length)) {
+        uint64_t bits = static_cast<uint64_t>(length) * 8;
+        for (size_t i = 0; i < 8; i++) {
+            block[56 + i] = static_cast<unsigned char>(bits >> (8 * i));
+        }
+    }
+}
+
+#ifdef AUTH_BATCH_X86
+
+/**
+ * @brief Вектор из W 32-битных дорожек (векторное расширение GCC)
+ */
+template <size_t W>
+struct Lanes {
+    typedef uint32_t Type __attribute__((vector_size(4 * W)));
+};
+
+/**
+ * @brief Шаг i сжатия: (a, b, c, d) <- (d, b + (a + f + m + K[i]) <<< s[i], b, c)
+ */
+template <size_t W>
+__attribute__((always_inline)) inline void step(typename Lanes<W>::Type& a, typename Lanes<W>::Type& b,
+                                                typename Lanes<W>::Type& c, typename Lanes<W>::Type& d,
+                                                const typename Lanes<W>::Type& f, const typename Lanes<W>::Type& m,
+                                                size_t i) {
+    typename Lanes<W>::Type t = a + f + m + kConstant[i];
+    a = d;
+    d = c;
+    c = b;
+    b = b + ((t << kShift[i]) | (t >> (32 - kShift[i])));
+}
+
+/**
+ * @brief Сжатие по одному блоку в каждой дорожке
+ *
+ * @param state Состояние (a, b, c, d) всех дорожек
+ * @param words Слова блоков: words[j][lane] - j-е слово блока дорожки lane
+ *
+ * @details
+ * Шаги MD5 записаны обычными операциями над векторами; набор инструкций
+ * (SSE2, AVX2, AVX-512F) выбирает функция с атрибутом target, в которую
+ * встраивается этот шаблон.
+ */
+template <size_t W>
+__attribute__((always_inline)) inline void compress(typename Lanes<W>::Type* state, const uint32_t (*words)[W]) {
+    typedef typename Lanes<W>::Type V;
+    V m[16];
+    for (size_t j = 0; j < 16; j++) {
+        std::memcpy(&m[j], words[j], sizeof(V));
+    }
+
+    V a = state[0], b = state[1], c = state[2], d = state[3];
+    for (size_t i = 0; i < 16; i++) {
+        step<W>(a, b, c, d, d ^ (b & (c ^ d)), m[i], i);
+    }
+    for (size_t i = 16; i < 32; i++) {
+        step<W>(a, b, c, d, c ^ (d & (b ^ c)), m[(5 * i + 1) % 16], i);
+    }
+    for (size_t i = 32; i < 48; i++) {
+        step<W>(a, b, c, d, b ^ c ^ d, m[(3 * i + 5) % 16], i);
+    }
+    for (size_t i = 48; i < 64; i++) {
+        step<W>(a, b, c, d, c ^ (b | ~d), m[(7 * i) % 16], i);
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+}
+
+/**
+ * @brief MD5 до W сообщений, по одному в дорожке
+ *
+ * @param inputs Сообщения
+ * @param count Количество сообщений (1..W)
+ * @param digests Буфер для count * 16 байт
+ *
+ * @details
+ * Дорожки без сообщения и дорожки, сообщение которых уже закончилось,
+ * сжимают нулевые блоки; их результат не используется. Дайджест дорожки
+ * снимается сразу после ее последнего блока.
+ */
+template <size_t W>
+__attribute__((always_inline)) inline void digest_group(const Md5Input* inputs, size_t count,
+                                                        unsigned char* digests) {
+    typedef typename Lanes<W>::Type V;
+    size_t blocks[W];
+    size_t max_blocks = 0;
+    for (size_t lane = 0; lane < W; lane++) {
+        blocks[lane] = lane < count ? block_count(inputs[lane].salt->size() + inputs[lane].password_length) : 0;
+        max_blocks = std::max(max_blocks, blocks[lane]);
+    }
+
+    V state[4];
+    for (size_t k = 0; k < 4; k++) {
+        V initial = {};
+        state[k] = initial + kInitial[k];
+    }
+
+    // Блоки дорожек: на x86 байты блока уже лежат словами little-endian
+    unsigned char blocks_data[W][64];
+    uint32_t words[16][W];
+    for (size_t number = 0; number < max_blocks; number++) {
+        for (size_t lane = 0; lane < W; lane++) {
+            if (number < blocks[lane]) {
+                fill_block(inputs[lane], number, blocks_data[lane]);
+            } else if (number == blocks[lane]) {
+                std::memset(blocks_data[lane], 0, 64);
+            }
+        }
+        for (size_t j = 0; j < 16; j++) {
+            for (size_t lane = 0; lane < W; lane++) {
+                std::memcpy(&words[j][lane], blocks_data[lane] + 4 * j, 4);
+            }
+        }
+
+        compress<W>(state, words);
+
+        for (size_t lane = 0; lane < count; lane++) {
+            if (number + 1 != blocks[lane]) {
+                continue;
+            }
+            unsigned char* out = digests + lane * Authenticator::kDigestLength;
+            for (size_t k = 0; k < 4; k++) {
+                uint32_t value = state[k][lane];
+                std::memcpy(out + 4 * k, &value, 4);
+            }
+        }
+    }
+}
+
+__attribute__((target("sse2")))
+void digest_sse2(const Md5Input* inputs, size_t count, unsigned char* digests) {
+    digest_group<4>(inputs, count, digests);
+}
+
+__attribute__((target("avx2")))
+void digest_avx2(const Md5Input* inputs, size_t count, unsigned char* digests) {
+    digest_group<8>(inputs, count, digests);
+}
+
+__attribute__((target("avx512f")))
+void digest_avx512(const Md5Input* inputs, size_t count, unsigned char* digests) {
+    digest_group<16>(inputs, count, digests);
+}
+
+/**
+ * @brief Ширина пакета по возможностям процессора
+ */
+size_t detect_lanes() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return 16;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return 8;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return 4;
+    }
+    return 1;
+}
+
+#else
+
+size_t detect_lanes() {
+    return 1;
+}
+
+#endif // AUTH_BATCH_X86
+
+} // namespace
+
+/**
+ * @brief Ширина пакета, поддерживаемая процессором
+ *
+ * @return size_t Количество дорожек
+ */
+size_t Md5Batch::lanes() {
+    static const size_t supported = detect_lanes();
+    return supported;
+}
+
+/**
+ * @brief Вычисляет дайджесты сообщений
+ *
+ * @param inputs Сообщения
+ * @param count Количество сообщений
+ * @param digests Буфер для дайджестов
+ * @param lanes Ширина пакета (0 - максимальная поддерживаемая)
+ *
+ * @details
+ * Сообщения обрабатываются группами по lanes. Одиночное сообщение
+ * (в том числе остаток из одного сообщения) считается OpenSSL: пустые
+ * дорожки сделали бы его только дороже.
+ */
+void Md5Batch::digest(const Md5Input* inputs, size_t count, unsigned char* digests, size_t lanes) {
+    size_t supported = Md5Batch::lanes();
+    if (lanes == 0 || lanes > supported) {
+        lanes = supported;
+    }
+
+    for (size_t offset = 0; offset < count;) {
+        size_t group = std::min(lanes, count - offset);
+        const Md5Input* batch = inputs + offset;
+        unsigned char* out = digests + offset * Authenticator::kDigestLength;
+#ifdef AUTH_BATCH_X86
+        if (group > 1 && lanes >= 16) {
+            digest_avx512(batch, group, out);
+        } else if (group > 1 && lanes >= 8) {
+            digest_avx2(batch, group, out);
+        } else if (group > 1 && lanes >= 4) {
+            digest_sse2(batch, group, out);
+        } else
+#endif
+        {
+            group = 1;
+            Authenticator::md5_digest(*batch->salt, batch->password, batch->password_length, out);
+        }
+        offset += group;
+    }
+}
+
+/**
+ * @brief Конструктор
+ *
+ * @param deadline Максимальное ожидание проверки
+ * @param batch Размер пакета (0 - ширина Md5Batch)
+ */
+AuthBatcher::AuthBatcher(std::chrono::microseconds deadline, size_t batch)
+    : batch_(batch != 0 ? batch : Md5Batch::lanes()), deadline_(deadline), batches_(0), verified_(0) {
+    pending_.reserve(batch_);
+    inputs_.reserve(batch_);
+    digests_.reserve(batch_ * Authenticator::kDigestLength);
+    results_.reserve(batch_);
+}
+
+/**
+ * @brief Ставит проверку в очередь
+ *
+ * @param client Сокет сессии
+ * @param salt Соль
+ * @param password Пароль
+ * @param password_length Длина пароля
+ * @param hash Хэш от клиента
+ *
+ * @note Срок пакета отсчитывается от постановки первой проверки
+ */
+void AuthBatcher::submit(int client, const std::string& salt, const char* password, size_t password_length,
+                         const std::string& hash) {
+    if (pending_.empty()) {
+        oldest_ = std::chrono::steady_clock::now();
+    }
+    Request request = {client, &hash};
+    Md5Input input = {&salt, password, password_length};
+    pending_.push_back(request);
+    inputs_.push_back(input);
+}
+
+/**
+ * @brief Отменяет проверку
+ *
+ * @param client Сокет сессии
+ *
+ * @note Срок оставшихся проверок не сдвигается: он отсчитывается от
+ *       более ранней проверки и потому только короче
+ */
+void AuthBatcher::cancel(int client) {
+    for (size_t i = 0; i < pending_.size(); i++) {
+        if (pending_[i].client == client) {
+            pending_.erase(pending_.begin() + i);
+            inputs_.erase(inputs_.begin() + i);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Таймаут ожидания событий
+ *
+ * @return int Миллисекунды или -1
+ */
+int AuthBatcher::timeout_ms() const {
+    if (pending_.empty()) {
+        return -1;
+    }
+    std::chrono::steady_clock::duration left = oldest_ + deadline_ - std::chrono::steady_clock::now();
+    if (left <= std::chrono::steady_clock::duration::zero()) {
+        return 0;
+    }
+    std::chrono::microseconds micros = std::chrono::duration_cast<std::chrono::microseconds>(left);
+    return static_cast<int>((micros.count() + 999) / 1000);
+}
+
+/**
+ * @brief Готов ли пакет
+ *
+ * @return bool true если пакет заполнен или срок истек
+ */
+bool AuthBatcher::due() const {
+    if (pending_.empty()) {
+        return false;
+    }
+    return pending_.size() >= batch_ || std::chrono::steady_clock::now() >= oldest_ + deadline_;
+}
+
+/**
+ * @brief Проверяет все ожидающие запросы
+ *
+ * @return const std::vector<Result>& Результаты
+ */
+const std::vector<AuthBatcher::Result>& AuthBatcher::flush() {
+    results_.clear();
+    size_t count = pending_.size();
+    if (count == 0) {
+        return results_;
+    }
+
+    digests_.resize(count * Authenticator::kDigestLength);
+    Md5Batch::digest(inputs_.data(), count, digests_.data());
+    for (size_t i = 0; i < count; i++) {
+        const unsigned char* digest = digests_.data() + i * Authenticator::kDigestLength;
+        Result result = {pending_[i].client, Authenticator::digest_matches(digest, *pending_[i].hash)};
+        results_.push_back(result);
+    }
+
+    batches_++;
+    verified_ += count;
+    pending_.clear();
+    inputs_.clear();
+    return results_;
+}
@@ -0,0 +1,337 @@
+/**
+ * @file big_integer.cpp
+ * @brief Реализация целых произвольной точности и точного произведения
+ *
+ * @see big_integer.h
+ */
+
+#include "../include/big_integer.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+typedef unsigned __int128 Wide;
+
+/**
+ * @brief Длина без старших нулевых слов
+ */
+inline size_t significant(const uint64_t* x, size_t n) {
+    while (n > 0 && x[n - 1] == 0) {
+        n--;
+    }
+    return n;
+}
+
+/**
+ * @brief out[0..nout) += x[0..nx), nx <= nout
+ */
+void add_into(uint64_t* out, size_t nout, const uint64_t* x, size_t nx) {
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < nx; i++) {
+        Wide sum = static_cast<Wide>(out[i]) + x[i] + carry;
+        out[i] = static_cast<uint64_t>(sum);
+        carry = static_cast<uint64_t>(sum >> 64);
+    }
+    for (; carry != 0 && i < nout; i++) {
+        carry = (++out[i] == 0);
+    }
+}
+
+/**
+ * @brief out[0..nout) -= x[0..nx), результат неотрицателен
+ */
+void sub_into(uint64_t* out, size_t nout, const uint64_t* x, size_t nx) {
+    uint64_t borrow = 0;
+    size_t i = 0;
+    for (; i < nx; i++) {
+        uint64_t value = out[i];
+        uint64_t diff = value - x[i] - borrow;
+        borrow = (value < x[i]) || (value - x[i] < borrow);
+        out[i] = diff;
+    }
+    for (; borrow != 0 && i < nout; i++) {
+        borrow = (out[i]-- == 0);
+    }
+}
+
+/**
+ * @brief Сумма a + b в max(na, nb) + 1 словах
+ */
+BigInteger::Limbs add(const uint64_t* a, size_t na, const uint64_t* b, size_t nb) {
+    if (na < nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    BigInteger::Limbs sum(a, a + na);
+    sum.push_back(0);
+    add_into(sum.data(), sum.size(), b, nb);
+    return sum;
+}
+
+/**
+ * @brief Умножение в столбик: out[0..na+nb) = a * b
+ */
+void multiply_schoolbook(const uint64_t* a, size_t na, const uint64_t* b, size_t nb, uint64_t* out) {
+    std::fill(out, out + na + nb, 0);
+    for (size_t i = 0; i < na; i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < nb; j++) {
+            Wide t = static_cast<Wide>(a[i]) * b[j] + out[i + j] + carry;
+            out[i + j] = static_cast<uint64_t>(t);
+            carry = static_cast<uint64_t>(t >> 64);
+        }
+        out[i + nb] = carry;
+    }
+}
+
+/**
+ * @brief out[0..na+nb) = a * b
+ *
+ * @details
+ * Карацуба: a = a1 * B^m + a0, b = b1 * B^m + b0,
+ * a * b = z2 * B^2m + ((a0 + a1)(b0 + b1) - z0 - z2) * B^m + z0,
+ * где z0 = a0 * b0, z2 = a1 * b1 записываются прямо в свои части out.
+ */
+void multiply(const uint64_t* a, size_t na, const uint64_t* b, size_t nb, uint64_t* out) {
+    if (na < nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    if (nb < BigInteger::kKaratsubaThreshold) {
+        multiply_schoolbook(a, na, b, nb, out);
+        return;
+    }
+
+    if (na >= 2 * nb) {
+        // Сильно неравные длины: длинный сомножитель частями по nb слов
+        std::fill(out, out + na + nb, 0);
+        BigInteger::Limbs part(2 * nb);
+        for (size_t offset = 0; offset < na; offset += nb) {
+            size_t length = std::min(nb, na - offset);
+            multiply(a + offset, length, b, nb, part.data());
+            add_into(out + offset, na + nb - offset, part.data(), length + nb);
+        }
+        return;
+    }
+
+    size_t m = na / 2;  // nb > m, так как na < 2 * nb
+    multiply(a, m, b, m, out);
+    multiply(a + m, na - m, b + m, nb - m, out + 2 * m);
+
+    BigInteger::Limbs sa = add(a, m, a + m, na - m);
+    BigInteger::Limbs sb = add(b, m, b + m, nb - m);
+    size_t nsa = significant(sa.data(), sa.size());
+    size_t nsb = significant(sb.data(), sb.size());
+    BigInteger::Limbs middle(nsa + nsb);
+    multiply(sa.data(), nsa, sb.data(), nsb, middle.data());
+    // z0, z2 <= middle, поэтому их значащие слова помещаются в middle
+    sub_into(middle.data(), middle.size(), out, significant(out, 2 * m));
+    sub_into(middle.data(), middle.size(), out + 2 * m, significant(out + 2 * m, na + nb - 2 * m));
+    add_into(out + m, na + nb - m, middle.data(), significant(middle.data(), middle.size()));
+}
+
+/**
+ * @brief Произведение модулей
+ */
+BigInteger::Limbs multiply(const BigInteger::Limbs& a, const BigInteger::Limbs& b) {
+    if (a.empty() || b.empty()) {
+        return BigInteger::Limbs();
+    }
+    BigInteger::Limbs product(a.size() + b.size());
+    multiply(a.data(), a.size(), b.data(), b.size(), product.data());
+    product.resize(significant(product.data(), product.size()));
+    return product;
+}
+
+} // namespace
+
+/**
+ * @brief Значение 64-битного целого
+ *
+ * @param value Значение
+ */
+BigInteger::BigInteger(int64_t value) : negative_(value < 0) {
+    uint64_t magnitude = value < 0 ? 0u - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    if (magnitude != 0) {
+        limbs_.push_back(magnitude);
+    }
+}
+
+/**
+ * @brief Число по модулю и знаку
+ *
+ * @param limbs Модуль
+ * @param negative Знак
+ */
+BigInteger::BigInteger(Limbs limbs, bool negative) : limbs_(std::move(limbs)), negative_(negative) {
+    normalize();
+}
+
+/**
+ * @brief Нормализация: без старших нулей, ноль неотрицателен
+ */
+void BigInteger::normalize() {
+    limbs_.resize(significant(limbs_.data(), limbs_.size()));
+    if (limbs_.empty()) {
+        negative_ = false;
+    }
+}
+
+/**
+ * @brief Битовая длина модуля
+ *
+ * @return size_t Количество значащих бит
+ */
+size_t BigInteger::bit_length() const {
+    if (limbs_.empty()) {
+        return 0;
+    }
+    return limbs_.size() * 64 - __builtin_clzll(limbs_.back());
+}
+
+/**
+ * @brief Произведение
+ *
+ * @param a Первый сомножитель
+ * @param b Второй сомножитель
+ * @return BigInteger a * b
+ */
+BigInteger operator*(const BigInteger& a, const BigInteger& b) {
+    return BigInteger(multiply(a.limbs_, b.limbs_), a.negative_ != b.negative_);
+}
+
+/**
+ * @brief Десятичная запись
+ *
+ * @return std::string Число со знаком
+ */
+std::string BigInteger::to_string() const {
+    if (limbs_.empty()) {
+        return "0";
+    }
+
+    // Деление на 10^19 - наибольшую степень 10, помещающуюся в слово
+    const uint64_t kChunk = 10000000000000000000ULL;
+    Limbs rest = limbs_;
+    std::vector<uint64_t> chunks;
+    while (!rest.empty()) {
+        uint64_t remainder = 0;
+        for (size_t i = rest.size(); i > 0; i--) {
+            Wide current = (static_cast<Wide>(remainder) << 64) | rest[i - 1];
+            rest[i - 1] = static_cast<uint64_t>(current / kChunk);
+            remainder = static_cast<uint64_t>(current % kChunk);
+        }
+        chunks.push_back(remainder);
+        rest.resize(significant(rest.data(), rest.size()));
+    }
+
+    std::string text = negative_ ? "-" : "";
+    text += std::to_string(chunks.back());
+    for (size_t i = chunks.size() - 1; i > 0; i--) {
+        std::string digits = std::to_string(chunks[i - 1]);
+        text.append(19 - digits.size(), '0');
+        text += digits;
+    }
+    return text;
+}
+
+/**
+ * @brief Кодирование для протокола
+ *
+ * @param out Буфер вывода
+ */
+void BigInteger::encode(std::string& out) const {
+    size_t bytes = (bit_length() + 7) / 8;
+    if (bytes > static_cast<size_t>(INT32_MAX)) {
+        throw std::runtime_error("Exact product is too long to encode");
+    }
+    int32_t size = static_cast<int32_t>(bytes);
+    if (negative_) {
+        size = -size;
+    }
+    out.append(reinterpret_cast<const char*>(&size), 4);
+    size_t start = out.size();
+    out.resize(start + bytes);
+    for (size_t i = 0; i < bytes; i++) {
+        out[start + i] = static_cast<char>(limbs_[i / 8] >> (8 * (i % 8)));
+    }
+}
+
+/**
+ * @brief Добавление листа в дерево произведений
+ *
+ * @param limbs Модуль листа
+ *
+ * @details
+ * Как прибавление единицы к двоичному счетчику: пока на вершине стека
+ * произведение того же уровня, оно объединяется с новым.
+ */
+template <typename T>
+void ExactProductAccumulator<T>::push(BigInteger::Limbs limbs) {
+    Node node = {std::move(limbs), 0};
+    while (!stack_.empty() && stack_.back().level == node.level) {
+        node.limbs = multiply(stack_.back().limbs, node.limbs);
+        node.level++;
+        stack_.pop_back();
+    }
+    stack_.push_back(std::move(node));
+}
+
+/**
+ * @brief Добавление элементов
+ *
+ * @param data Элементы
+ * @param count Количество элементов
+ */
+template <typename T>
+void ExactProductAccumulator<T>::add(const char* data, size_t count) {
+    if (count > 0) {
+        empty_ = false;
+    }
+    for (size_t i = 0; i < count && !zero_; i++) {
+        T value;
+        memcpy(&value, data + i * sizeof(T), sizeof(T));
+        if (value == 0) {
+            zero_ = true;
+            stack_.clear();
+            return;
+        }
+        negative_ ^= (value < 0);
+        uint64_t magnitude = value < 0 ? 0u - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+        uint64_t packed;
+        if (__builtin_mul_overflow(leaf_, magnitude, &packed)) {
+            push(BigInteger::Limbs(1, leaf_));
+            leaf_ = magnitude;
+        } else {
+            leaf_ = packed;
+        }
+    }
+}
+
+/**
+ * @brief Точное произведение
+ *
+ * @return BigInteger Произведение (0 для пустой последовательности)
+ *
+ * @details
+ * Оставшиеся на стеке произведения объединяются от вершины (коротких)
+ * к дну (длинным).
+ */
+template <typename T>
+BigInteger ExactProductAccumulator<T>::result() const {
+    if (empty_ || zero_) {
+        return BigInteger();
+    }
+    BigInteger::Limbs product(1, leaf_);
+    for (size_t i = stack_.size(); i > 0; i--) {
+        product = multiply(stack_[i - 1].limbs, product);
+    }
+    return BigInteger(std::move(product), negative_);
+}
+
+template class ExactProductAccumulator<int32_t>;
+template class ExactProductAccumulator<int64_t>;
@@ -0,0 +1,89 @@
+/**
+ * @file byte_buffer.cpp
+ * @brief Реализация буфера приема
+ *
+ * @see byte_buffer.h
+ */
+
+#include "../include/byte_buffer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const size_t kMinCapacity = 4096;         ///< Минимальный размер выделяемой памяти
+const size_t kMaxIdleCapacity = 1 << 20;  ///< Больший буфер освобождается, когда опустеет
+
+} // namespace
+
+/**
+ * @brief Конструктор
+ */
+ByteBuffer::ByteBuffer() : capacity_(0), begin_(0), end_(0) {
+}
+
+/**
+ * @brief Подготовка свободного места в хвосте
+ *
+ * @param length Требуемое свободное место
+ * @return char* Начало свободного места
+ */
+char* ByteBuffer::prepare(size_t length) {
+    if (writable() >= length) {
+        return storage_.get() + end_;
+    }
+
+    size_t used = size();
+    if (used + length <= capacity_) {
+        // Места хватает, если перенести неразобранный остаток в начало
+        memmove(storage_.get(), storage_.get() + begin_, used);
+    } else {
+        size_t capacity = std::max(std::max(capacity_ * 2, used + length), kMinCapacity);
+        std::unique_ptr<char[]> storage(new char[capacity]);
+        if (used > 0) {
+            memcpy(storage.get(), storage_.get() + begin_, used);
+        }
+        storage_.swap(storage);
+        capacity_ = capacity;
+    }
+    begin_ = 0;
+    end_ = used;
+    return storage_.get() + end_;
+}
+
+/**
+ * @brief Дописывание данных
+ *
+ * @param data Данные
+ * @param length Количество байт
+ */
+void ByteBuffer::append(const char* data, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    memcpy(prepare(length), data, length);
+    commit(length);
+}
+
+/**
+ * @brief Отбрасывание разобранных байт
+ *
+ * @param length Количество байт
+ */
+void ByteBuffer::consume(size_t length) {
+    begin_ += length;
+    if (begin_ == end_) {
+        clear();
+    }
+}
+
+/**
+ * @brief Очистка буфера
+ */
+void ByteBuffer::clear() {
+    begin_ = end_ = 0;
+    if (capacity_ > kMaxIdleCapacity) {
+        storage_.reset();
+        capacity_ = 0;
+    }
+}
@@ -29,6 +29,14 @@
  * -c FILE          -> указывает файл конфигурации клиентов
  * -d FILE          -> синоним для -c
  * -l FILE          -> указывает файл логов
+ * -t THREADS       -> задает количество рабочих потоков (0-1024)
+ * -s SHARDS        -> задает количество шардов SO_REUSEPORT (0-1024)
+ * -b BACKEND       -> выбирает транспорт ввода-вывода (epoll, uring)
+ * -k KERNEL        -> задает ядро произведения (проверяется при старте сервера)
+ * -r MB            -> задает объем кэша результатов (0-65536 МБ)
+ * -R PLACEMENT     -> выбирает размещение кэша (worker, global)
+ * -a USEC          -> задает срок пакетной проверки аутентификации (0-100000 мкс)
+ * -S SOURCE        -> выбирает источник соли (client, server)
  * 
  * @note При неизвестном аргументе выводит справку и завершает программу с кодом 1
  * @note Если аргументов нет, возвращает конфигурацию по умолчанию
@@ -62,6 +70,84 @@ ServerConfig ServerConfig::parse_args(int argc, char* argv[]) {
                 std::cerr << "Error: Invalid port number - " << argv[i] << "\n";
                 exit(1);
             }
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            try {
+                int threads = std::stoi(argv[++i]);
+                // Проверка количества потоков
+                if (threads < 0 || threads > 1024) {
+                    std::cerr << "Error: Thread count must be between 0 and 1024\n";
+                    exit(1);
+                }
+                config.threads = threads;
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid thread count - " << argv[i] << "\n";
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            try {
+                int shards = std::stoi(argv[++i]);
+                // Проверка количества шардов
+                if (shards < 0 || shards > 1024) {
+                    std::cerr << "Error: Shard count must be between 0 and 1024\n";
+                    exit(1);
+                }
+                config.shards = shards;
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid shard count - " << argv[i] << "\n";
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            std::string backend = argv[++i];
+            // Проверка названия транспорта
+            if (backend != "epoll" && backend != "uring") {
+                std::cerr << "Error: I/O backend must be epoll or uring\n";
+                exit(1);
+            }
+            config.io_backend = backend;
+        } else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc) {
+            config.kernel = argv[++i];
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            try {
+                int cache_mb = std::stoi(argv[++i]);
+                // Проверка объема кэша
+                if (cache_mb < 0 || cache_mb > 65536) {
+                    std::cerr << "Error: Cache size must be between 0 and 65536 MB\n";
+                    exit(1);
+                }
+                config.cache_mb = static_cast<size_t>(cache_mb);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid cache size - " << argv[i] << "\n";
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "-R") == 0 && i + 1 < argc) {
+            std::string placement = argv[++i];
+            // Проверка размещения кэша
+            if (placement != "worker" && placement != "global") {
+                std::cerr << "Error: Cache placement must be worker or global\n";
+                exit(1);
+            }
+            config.cache_placement = placement;
+        } else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) {
+            try {
+                int auth_batch_us = std::stoi(argv[++i]);
+                // Проверка срока пакетной проверки
+                if (auth_batch_us < 0 || auth_batch_us > 100000) {
+                    std::cerr << "Error: Auth batch deadline must be between 0 and 100000 us\n";
+                    exit(1);
+                }
+                config.auth_batch_us = auth_batch_us;
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid auth batch deadline - " << argv[i] << "\n";
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "-S") == 0 && i + 1 < argc) {
+            std::string source = argv[++i];
+            // Проверка источника соли
+            if (source != "client" && source != "server") {
+                std::cerr << "Error: Salt source must be client or server\n";
+                exit(1);
+            }
+            config.salt_source = source;
         } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
             config.client_db_file = argv[++i];
         } else {
@@ -91,9 +177,24 @@ void ServerConfig::print_help() {
     std::cout << "  -c CONFIG_FILE   Client database file (default: /etc/vealc.conf)\n";
     std::cout << "  -d CONFIG_FILE   Alias for -c\n";
     std::cout << "  -l LOG_FILE      Log file (default: /var/log/vealc.log)\n";
+    std::cout << "  -t THREADS       Worker threads (0-1024, default: 0 = single thread)\n";
+    std::cout << "  -s SHARDS        SO_REUSEPORT shards, one listener per core (0-1024, default: 0 = off)\n";
+    std::cout << "  -b BACKEND       I/O backend: epoll or uring (default: epoll)\n";
+    std::cout << "  -k KERNEL        Product kernel: auto, scalar, unrolled, simd, avx2, avx512 (default: auto)\n";
+    std::cout << "  -r MB            Result cache size (0-65536 MB, default: 0 = off)\n";
+    std::cout << "  -R PLACEMENT     Result cache placement: worker or global (default: worker)\n";
+    std::cout << "  -a USEC          Batch MD5 authentication, max wait in us (0-100000, default: 0 = off)\n";
+    std::cout << "  -S SOURCE        Salt source: client or server challenge (default: client)\n";
     std::cout << "\n";
     std::cout << "Examples:\n";
     std::cout << "  ./server                    # Run with default settings\n";
     std::cout << "  ./server -p 44444           # Run on port 44444\n";
     std::cout << "  ./server -c ./myconfig.conf # Use custom config file\n";
+    std::cout << "  ./server -t 16              # Serve sessions on 16 worker threads\n";
+    std::cout << "  ./server -s 16              # 16 SO_REUSEPORT shards on one port\n";
+    std::cout << "  ./server -b uring           # Serve sessions through io_uring\n";
+    std::cout << "  ./server -k scalar          # Force the reference product kernel\n";
+    std::cout << "  ./server -t 8 -r 64 -R global # 64 MB result cache shared by 8 workers\n";
+    std::cout << "  ./server -t 4 -a 500        # Verify logins in MD5 batches, waiting up to 0.5 ms\n";
+    std::cout << "  ./server -S server          # Send each client a salt to sign on connect\n";
 }
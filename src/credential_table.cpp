@@ -0,0 +1,194 @@
+/**
+ * @file credential_table.cpp
+ * @brief Реализация компактной таблицы учетных данных
+ *
+ * @see credential_table.h
+ */
+
+#include "../include/credential_table.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+/**
+ * @brief Хэш логина: FNV-1a с перемешиванием из MurmurHash3
+ *
+ * @details
+ * Логины короткие, поэтому побайтовый FNV-1a дешевле блочных хэшей;
+ * финальное перемешивание распределяет по слотам и младшие биты (индекс),
+ * и старшие (тег).
+ */
+uint64_t hash_login(const char* data, size_t length) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/**
+ * @brief Тег слота: старшие 32 бита хэша, младший бит всегда 1
+ */
+inline uint32_t tag_of(uint64_t hash) {
+    return static_cast<uint32_t>(hash >> 32) | 1u;
+}
+
+/**
+ * @brief Размер заголовка записи: длины логина и пароля по 16 бит
+ */
+const size_t kHeaderLength = 4;
+
+inline uint16_t read_length(const char* data) {
+    uint16_t length;
+    memcpy(&length, data, sizeof(length));
+    return length;
+}
+
+} // namespace
+
+/**
+ * @brief Пустая таблица на 16 слотов
+ */
+CredentialTable::CredentialTable() : slots_(16, Slot()), size_(0) {}
+
+/**
+ * @brief Таблица из словаря
+ *
+ * @param clients Словарь логин -> пароль
+ */
+CredentialTable::CredentialTable(const std::unordered_map<std::string, std::string>& clients)
+    : CredentialTable() {
+    for (const auto& client : clients) {
+        insert(client.first, client.second);
+    }
+}
+
+/**
+ * @brief Поиск слота логина
+ *
+ * @param login Логин
+ * @param length Длина логина
+ * @param hash Хэш логина
+ * @return size_t Индекс слота с этим логином или первого пустого слота
+ *
+ * @details
+ * Линейное пробирование. Арена читается только для слотов с тем же
+ * тегом, то есть почти всегда один раз - для искомой записи.
+ */
+size_t CredentialTable::locate(const char* login, size_t length, uint64_t hash) const {
+    size_t mask = slots_.size() - 1;
+    uint32_t tag = tag_of(hash);
+    for (size_t index = static_cast<size_t>(hash) & mask;; index = (index + 1) & mask) {
+        const Slot& slot = slots_[index];
+        if (slot.tag == 0) {
+            return index;
+        }
+        if (slot.tag != tag) {
+            continue;
+        }
+        const char* record = arena_.data() + slot.offset;
+        if (read_length(record) == length && memcmp(record + kHeaderLength, login, length) == 0) {
+            return index;
+        }
+    }
+}
+
+/**
+ * @brief Удваивает количество слотов
+ *
+ * @details
+ * Записи арены не перемещаются: слоты раскладываются заново по хэшам
+ * логинов, прочитанных из арены.
+ */
+void CredentialTable::grow() {
+    std::vector<Slot> old;
+    old.swap(slots_);
+    slots_.assign(old.size() * 2, Slot());
+    size_t mask = slots_.size() - 1;
+    for (const Slot& slot : old) {
+        if (slot.tag == 0) {
+            continue;
+        }
+        const char* record = arena_.data() + slot.offset;
+        uint64_t hash = hash_login(record + kHeaderLength, read_length(record));
+        size_t index = static_cast<size_t>(hash) & mask;
+        while (slots_[index].tag != 0) {
+            index = (index + 1) & mask;
+        }
+        slots_[index] = slot;
+    }
+}
+
+/**
+ * @brief Добавление или замена записи
+ *
+ * @param login Логин
+ * @param login_length Длина логина
+ * @param password Пароль
+ * @param password_length Длина пароля
+ *
+ * @details
+ * Загрузка таблицы не превышает 3/4: при большей слоты удваиваются.
+ */
+void CredentialTable::insert(const char* login, size_t login_length, const char* password,
+                             size_t password_length) {
+    if (login_length > kMaxLength || password_length > kMaxLength) {
+        throw std::invalid_argument("Login or password is too long");
+    }
+    size_t record_length = kHeaderLength + login_length + password_length;
+    if (arena_.size() + record_length > UINT32_MAX) {
+        throw std::length_error("Credential table exceeds 4 GB");
+    }
+    if ((size_ + 1) * 4 > slots_.size() * 3) {
+        grow();
+    }
+
+    uint64_t hash = hash_login(login, login_length);
+    size_t index = locate(login, login_length, hash);
+    if (slots_[index].tag == 0) {
+        size_++;
+    }
+    slots_[index].tag = tag_of(hash);
+    slots_[index].offset = static_cast<uint32_t>(arena_.size());
+
+    uint16_t lengths[2] = {static_cast<uint16_t>(login_length), static_cast<uint16_t>(password_length)};
+    const char* header = reinterpret_cast<const char*>(lengths);
+    arena_.insert(arena_.end(), header, header + kHeaderLength);
+    arena_.insert(arena_.end(), login, login + login_length);
+    arena_.insert(arena_.end(), password, password + password_length);
+}
+
+/**
+ * @brief Поиск пароля
+ *
+ * @param login Логин
+ * @param password Пароль, если найден
+ * @return bool true если найден
+ */
+bool CredentialTable::find(const std::string& login, View& password) const {
+    size_t index = locate(login.data(), login.size(), hash_login(login.data(), login.size()));
+    const Slot& slot = slots_[index];
+    if (slot.tag == 0) {
+        return false;
+    }
+    const char* record = arena_.data() + slot.offset;
+    password.data = record + kHeaderLength + login.size();
+    password.size = read_length(record + 2);
+    return true;
+}
+
+/**
+ * @brief Память таблицы
+ *
+ * @return size_t Байты арены и слотов
+ */
+size_t CredentialTable::memory_bytes() const {
+    return arena_.capacity() + slots_.capacity() * sizeof(Slot);
+}
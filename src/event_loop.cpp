@@ -0,0 +1,99 @@
+/**
+ * @file event_loop.cpp
+ * @brief Реализация событийного цикла на основе epoll
+ *
+ * Содержит реализацию методов класса EventLoop:
+ * - создание и закрытие экземпляра epoll
+ * - регистрация и удаление дескрипторов
+ * - ожидание событий
+ *
+ * @see event_loop.h
+ */
+
+#include "../include/event_loop.h"
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <stdexcept>
+
+/**
+ * @brief Создает экземпляр epoll
+ *
+ * @note Используется флаг EPOLL_CLOEXEC
+ */
+EventLoop::EventLoop() : epoll_fd_(epoll_create1(EPOLL_CLOEXEC)) {
+    if (epoll_fd_ < 0) {
+        throw std::runtime_error("epoll_create1 failed");
+    }
+}
+
+/**
+ * @brief Закрывает дескриптор epoll
+ */
+EventLoop::~EventLoop() {
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+    }
+}
+
+/**
+ * @brief Регистрирует дескриптор в цикле
+ *
+ * @param fd Дескриптор
+ * @param events Маска событий
+ *
+ * @details
+ * В поле data события сохраняется сам дескриптор, по нему владелец
+ * цикла находит обработчик.
+ */
+void EventLoop::add(int fd, uint32_t events) {
+    struct epoll_event ev;
+    ev.events = events;
+    ev.data.fd = fd;
+
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        throw std::runtime_error("epoll_ctl ADD failed");
+    }
+}
+
+/**
+ * @brief Удаляет дескриптор из цикла
+ *
+ * @param fd Дескриптор
+ */
+void EventLoop::remove(int fd) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+/**
+ * @brief Ожидает готовности дескрипторов
+ *
+ * @param events Массив для готовых событий
+ * @param max_events Размер массива
+ * @param timeout_ms Таймаут в миллисекундах
+ * @return int Количество готовых событий
+ *
+ * @note Прерывание сигналом (EINTR) не считается ошибкой
+ */
+int EventLoop::wait(struct epoll_event* events, int max_events, int timeout_ms) {
+    int ready = epoll_wait(epoll_fd_, events, max_events, timeout_ms);
+    if (ready < 0) {
+        if (errno == EINTR) {
+            return 0;
+        }
+        throw std::runtime_error("epoll_wait failed");
+    }
+    return ready;
+}
+
+/**
+ * @brief Переводит дескриптор в неблокирующий режим
+ *
+ * @param fd Дескриптор
+ */
+void set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        throw std::runtime_error("fcntl O_NONBLOCK failed");
+    }
+}
@@ -7,6 +7,7 @@
  * - запись сообщений с временными метками
  * - обработка ошибок и критических событий
  * - добавление текста к существующей записи
+ * - буферизованная запись для шардов сервера
  * 
  * @see logger.h
  */
@@ -14,17 +15,42 @@
 #include "../include/logger.h"
 #include <fstream>
 #include <ctime>
+#include <cerrno>
+#include <fcntl.h>
 #include <iomanip>
 #include <iostream>
+#include <unistd.h>
+
+const int Logger::kFlushIntervalMs;
+const size_t Logger::kFlushBytes;
 
 /**
  * @brief Конструктор логгера
  * 
  * @param filename Путь к файлу для записи логов
+ * @param buffered Буферизованный режим
  * 
- * @note Не создает файл, если он не существует - файл создается при первой записи
+ * @note Обычный логгер не создает файл, если он не существует - файл
+ *       создается при первой записи. Буферизованный открывает (создает)
+ *       его сразу и держит открытым
  */
-Logger::Logger(const std::string& filename) : log_file_(filename) {}
+Logger::Logger(const std::string& filename, bool buffered)
+    : log_file_(filename), buffered_(buffered), fd_(-1) {
+    if (buffered_) {
+        fd_ = open(log_file_.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+        buffer_.reserve(kFlushBytes);
+    }
+}
+
+/**
+ * @brief Деструктор логгера
+ */
+Logger::~Logger() {
+    if (fd_ >= 0) {
+        flush();
+        close(fd_);
+    }
+}
 
 /**
  * @brief Записывает сообщение в лог
@@ -38,16 +64,37 @@ Logger::Logger(const std::string& filename) : log_file_(filename) {}
  * 3. Форматирует запись: [YYYY-MM-DD HH:MM:SS] [LEVEL] message
  * 4. Записывает в файл и закрывает его
  * 
- * @note Потокобезопасность не гарантируется
+ * В буферизованном режиме запись только добавляется в буфер; буфер
+ * записывается при переполнении, для критических сообщений и по сроку
+ * (flush_timeout_ms()/flush()).
+ * 
+ * @note Потокобезопасен: консоль и файл пишутся под мьютексом
  */
 void Logger::log(const std::string& message, bool critical) {
+    std::string time_str = get_current_time();
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    if (buffered_) {
+        if (buffer_.empty()) {
+            flush_at_ = std::chrono::steady_clock::now() + std::chrono::milliseconds(kFlushIntervalMs);
+        }
+        buffer_ += '[';
+        buffer_ += time_str;
+        buffer_ += critical ? "] [CRITICAL] " : "] [NON-CRITICAL] ";
+        buffer_ += message;
+        buffer_ += '\n';
+        if (critical || buffer_.size() >= kFlushBytes) {
+            write_buffer();
+        }
+        return;
+    }
+    
     // Вывод в консоль для отладки
     std::cout << message << std::endl;
     
     // Запись в файл
     std::ofstream file(log_file_, std::ios_base::app);
     if (file.is_open()) {
-        std::string time_str = get_current_time();
         std::string critical_str = critical ? "CRITICAL" : "NON-CRITICAL";
 
         file << "[" << time_str << "] [" << critical_str << "] " << message << std::endl;
@@ -69,6 +116,16 @@ void Logger::log(const std::string& message, bool critical) {
  * @note Полезно для создания прогресс-баров или форматированных выводов
  */
 void Logger::log_add(const std::string& message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    if (buffered_) {
+        if (buffer_.empty()) {
+            flush_at_ = std::chrono::steady_clock::now() + std::chrono::milliseconds(kFlushIntervalMs);
+        }
+        buffer_ += message;
+        return;
+    }
+    
     // Вывод в консоль без новой строки
     std::cout << message;
     
@@ -100,6 +157,57 @@ void Logger::log_error(const std::string& error, bool critical) {
     log(err_message, critical);
 }
 
+/**
+ * @brief Записывает накопленный буфер в файл
+ */
+void Logger::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    write_buffer();
+}
+
+/**
+ * @brief Время до записи буфера
+ * 
+ * @return int Миллисекунды до срока (0 - срок прошел), -1 если писать нечего
+ */
+int Logger::flush_timeout_ms() {
+    if (!buffered_) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (buffer_.empty()) {
+        return -1;
+    }
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+        flush_at_ - std::chrono::steady_clock::now()).count();
+    return left > 0 ? static_cast<int>(left) : 0;
+}
+
+/**
+ * @brief Записывает буфер в файл и очищает его
+ * 
+ * @details
+ * Файл открыт с O_APPEND, поэтому буфер целиком дописывается в конец
+ * даже при записи в тот же файл другими логгерами.
+ * 
+ * @note Вызывается под mutex_. Если файл не открылся, записи теряются,
+ *       как и у обычного логгера
+ */
+void Logger::write_buffer() {
+    size_t offset = 0;
+    while (fd_ >= 0 && offset < buffer_.size()) {
+        ssize_t written = write(fd_, buffer_.data() + offset, buffer_.size() - offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        offset += static_cast<size_t>(written);
+    }
+    buffer_.clear();
+}
+
 /**
  * @brief Получает текущее время в формате строки
  * 
@@ -107,10 +215,12 @@ void Logger::log_error(const std::string& error, bool critical) {
  * 
  * @note Использует локальное время системы
  * @note Формат соответствует ISO 8601 без временной зоны
+ * @note Использует localtime_r(), безопасный для вызова из разных потоков
  */
 std::string Logger::get_current_time() {
     auto now = std::time(nullptr);
-    auto tm = *std::localtime(&now);
+    struct tm tm;
+    localtime_r(&now, &tm);
     
     char buffer[20];
     std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
@@ -48,17 +48,39 @@ int main(int argc, char* argv[]) {
         std::cout << "  -c CONFIG_FILE   Client database file (default: /etc/vealc.conf)\n";
         std::cout << "  -d CONFIG_FILE   Alias for -c\n";
         std::cout << "  -l LOG_FILE      Log file (default: /var/log/vealc.log)\n";
+        std::cout << "  -t THREADS       Worker threads (default: 0 = single thread)\n";
+        std::cout << "  -s SHARDS        SO_REUSEPORT shards (default: 0 = off)\n";
+        std::cout << "  -b BACKEND       I/O backend: epoll or uring (default: epoll)\n";
+        std::cout << "  -k KERNEL        Product kernel: auto, scalar, unrolled, simd, avx2, avx512 (default: auto)\n";
+        std::cout << "  -r MB            Result cache size (default: 0 = off)\n";
+        std::cout << "  -R PLACEMENT     Result cache placement: worker or global (default: worker)\n";
+        std::cout << "  -a USEC          Batch MD5 authentication, max wait in us (default: 0 = off)\n";
+        std::cout << "  -S SOURCE        Salt source: client or server challenge (default: client)\n";
         std::cout << "\n";
         std::cout << "Examples:\n";
         std::cout << "  ./server                    # Run with default settings\n";
         std::cout << "  ./server -p 44444           # Run on port 44444\n";
         std::cout << "  ./server -c ./myconfig.conf # Use custom config file\n";
+        std::cout << "  ./server -t 16              # Serve sessions on 16 worker threads\n";
+        std::cout << "  ./server -s 16              # 16 SO_REUSEPORT shards on one port\n";
+        std::cout << "  ./server -b uring           # Serve sessions through io_uring\n";
+        std::cout << "  ./server -k scalar          # Force the reference product kernel\n";
+        std::cout << "  ./server -t 8 -r 64 -R global # 64 MB result cache shared by 8 workers\n";
+        std::cout << "  ./server -t 4 -a 500        # Verify logins in MD5 batches, waiting up to 0.5 ms\n";
+        std::cout << "  ./server -S server          # Send each client a salt to sign on connect\n";
         std::cout << "\n";
         std::cout << "========================================\n";
         std::cout << "Starting server with configuration:\n";
         std::cout << "  Port: " << config.port << "\n";
         std::cout << "  Config file: " << config.client_db_file << "\n";
         std::cout << "  Log file: " << config.log_file << "\n";
+        std::cout << "  Worker threads: " << config.threads << "\n";
+        std::cout << "  Shards: " << config.shards << "\n";
+        std::cout << "  I/O backend: " << config.io_backend << "\n";
+        std::cout << "  Product kernel: " << config.kernel << "\n";
+        std::cout << "  Result cache: " << config.cache_mb << " MB (" << config.cache_placement << ")\n";
+        std::cout << "  Auth batch: " << config.auth_batch_us << " us\n";
+        std::cout << "  Salt source: " << config.salt_source << "\n";
         std::cout << "========================================\n\n";
         
         // Запускаем сервер с конфигом
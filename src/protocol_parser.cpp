@@ -0,0 +1,395 @@
+/**
+ * @file protocol_parser.cpp
+ * @brief Реализация инкрементального разбора протокола
+ *
+ * @see protocol_parser.h
+ */
+
+#include "../include/protocol_parser.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+/**
+ * @brief Количество hex символов соли и хэша подряд
+ */
+const size_t kCredentialsLength = 48;
+
+/**
+ * @brief Является ли символ hex-цифрой
+ */
+inline bool is_hex(char c) {
+    unsigned char u = static_cast<unsigned char>(c);
+    return static_cast<unsigned char>(u - '0') < 10 || static_cast<unsigned char>((u | 0x20) - 'a') < 6;
+}
+
+#if defined(__SSE2__)
+
+/**
+ * @brief Маска hex-цифр среди 16 байт
+ *
+ * @details
+ * Беззнаковое сравнение c - lo < n выполняется знаковым сравнением со
+ * сдвигом на 128: диапазон [lo, lo + n) переходит в [-128, -128 + n).
+ * Буквы сравниваются после приведения к нижнему регистру (c | 0x20).
+ */
+inline uint32_t hex_mask16(const char* data) {
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    __m128i digit = _mm_cmplt_epi8(_mm_add_epi8(c, _mm_set1_epi8(static_cast<char>(-128 - '0'))),
+                                   _mm_set1_epi8(-128 + 10));
+    __m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+    __m128i letter = _mm_cmplt_epi8(_mm_add_epi8(lower, _mm_set1_epi8(static_cast<char>(-128 - 'a'))),
+                                    _mm_set1_epi8(-128 + 6));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(digit, letter)));
+}
+
+#endif
+
+/**
+ * @brief Маска hex-цифр: бит i установлен, если data[i] - hex-цифра
+ *
+ * @param data Байты
+ * @param length Количество байт (не больше 64)
+ * @return uint64_t Маска (биты за пределами length сброшены)
+ */
+inline uint64_t hex_mask(const char* data, size_t length) {
+    uint64_t mask = 0;
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 16 <= length; i += 16) {
+        mask |= static_cast<uint64_t>(hex_mask16(data + i)) << i;
+    }
+#endif
+    for (; i < length; i++) {
+        mask |= static_cast<uint64_t>(is_hex(data[i])) << i;
+    }
+    return mask;
+}
+
+} // namespace
+
+/**
+ * @brief Конструктор
+ */
+ProtocolParser::ProtocolParser(uint32_t stream_threshold, uint32_t key_threshold)
+    : stage_(Stage::Auth), scanned_(0), run_start_(0), run_length_(0), credentials_offset_(0),
+      vector_count_(0), element_type_(ElementType::Int32), element_size_(4), operation_(Operation::Product),
+      vectors_parsed_(0), vector_size_(0), vector_filled_(0),
+      stream_threshold_(stream_threshold), key_threshold_(key_threshold), keyed_(false), streaming_(false), skipping_(false), chunk_(nullptr), chunk_count_(0),
+      pending_consume_(0) {
+}
+
+/**
+ * @brief Добавление принятых байт
+ *
+ * @param data Данные
+ * @param length Количество байт
+ *
+ * @note После завершения разбора данные отбрасываются
+ */
+void ProtocolParser::feed(const char* data, size_t length) {
+    if (stage_ != Stage::Done) {
+        buffer_.append(data, length);
+    }
+}
+
+/**
+ * @brief Один шаг разбора
+ *
+ * @return Event Событие или NeedMore
+ *
+ * @details
+ * 1. Auth - поиск 48 hex символов (соль + хэш), все перед ними - логин
+ * 2. VectorCount - количество векторов (0 завершает разбор), возможно
+ *    после расширенного заголовка с типом элементов и операцией
+ * 3. VectorSize / VectorData - размер и элементы каждого вектора;
+ *    после последнего вектора разбор завершается. Нечетный размер
+ *    вектора для скалярного произведения или слишком длинный вектор
+ *    точного произведения завершают разбор (BadHeader)
+ * 
+ * Потоковый вектор (размер больше stream_threshold) выдается событиями
+ * Elements по мере приема целых элементов и завершается событием Vector.
+ * Порция указывает прямо в буфер приема и отбрасывается из него только
+ * в начале следующего вызова next(). После skip_vector() остаток вектора
+ * отбрасывается из буфера по мере приема без выдачи порций.
+ */
+ProtocolParser::Event ProtocolParser::next() {
+    if (pending_consume_ > 0) {
+        buffer_.consume(pending_consume_);
+        pending_consume_ = 0;
+        chunk_ = nullptr;
+        chunk_count_ = 0;
+    }
+
+    switch (stage_) {
+    case Stage::Auth:
+        return parse_credentials();
+
+    case Stage::VectorCount:
+        return parse_vector_count();
+
+    case Stage::VectorSize:
+        if (buffer_.size() < 4) {
+            return Event::NeedMore;
+        }
+        vector_size_ = take_uint32();
+        if ((operation_ == Operation::Dot && vector_size_ % 2 != 0) ||
+            (operation_ == Operation::ExactProduct &&
+             static_cast<uint64_t>(vector_size_) * element_size_ > kMaxExactProductBytes)) {
+            stage_ = Stage::Done;
+            return Event::BadHeader;
+        }
+        vector_filled_ = 0;
+        streaming_ = vector_size_ > stream_threshold_ || element_type_ != ElementType::Int32 ||
+                     operation_ != Operation::Product;
+        skipping_ = false;
+        keyed_ = !streaming_ && vector_size_ >= key_threshold_;
+        if (keyed_) {
+            key_hasher_.reset();
+        }
+        vector_.resize(streaming_ ? 0 : vector_size_);
+        stage_ = Stage::VectorData;
+        return Event::VectorSize;
+
+    case Stage::VectorData: {
+        // Потоковый вектор выдается порциями целых элементов из буфера.
+        // Для обычного уже принятая часть элементов переносится в вектор,
+        // остальное транспорт может принять прямо в него (direct_area())
+        size_t remaining = static_cast<size_t>(vector_size_) * element_size_ - vector_filled_;
+        size_t available = std::min(remaining, buffer_.size());
+        if (skipping_) {
+            buffer_.consume(available);
+            vector_filled_ += available;
+        } else if (streaming_) {
+            available -= available % element_size_;
+            if (available > 0) {
+                chunk_ = buffer_.data();
+                chunk_count_ = available / element_size_;
+                pending_consume_ = available;
+                vector_filled_ += available;
+                return Event::Elements;
+            }
+            if (remaining > 0) {
+                return Event::NeedMore;
+            }
+        } else if (available > 0) {
+            char* area = reinterpret_cast<char*>(vector_.data()) + vector_filled_;
+            memcpy(area, buffer_.data(), available); // Не используем ntohl
+            if (keyed_) {
+                key_hasher_.update(area, available);
+            }
+            buffer_.consume(available);
+            vector_filled_ += available;
+        }
+        if (available < remaining) {
+            return Event::NeedMore;
+        }
+        stage_ = (++vectors_parsed_ == vector_count_) ? Stage::Done : Stage::VectorSize;
+        return Event::Vector;
+    }
+
+    case Stage::Done:
+        break;
+    }
+    return Event::NeedMore;
+}
+
+/**
+ * @brief Свободное место в векторе для приема без буфера
+ *
+ * @return size_t Количество еще не принятых байт элементов или 0
+ */
+size_t ProtocolParser::direct_capacity() const {
+    if (stage_ != Stage::VectorData || streaming_ || !buffer_.empty()) {
+        return 0;
+    }
+    return static_cast<size_t>(vector_size_) * 4 - vector_filled_;
+}
+
+/**
+ * @brief Начало свободного места в векторе
+ *
+ * @return char* Адрес первого еще не принятого байта элементов
+ */
+char* ProtocolParser::direct_area() {
+    return reinterpret_cast<char*>(vector_.data()) + vector_filled_;
+}
+
+/**
+ * @brief Учет байт, принятых прямо в вектор
+ *
+ * @param length Количество байт
+ */
+void ProtocolParser::commit_direct(size_t length) {
+    if (keyed_) {
+        key_hasher_.update(direct_area(), length);
+    }
+    vector_filled_ += length;
+}
+
+/**
+ * @brief Ключ кэша последнего вектора
+ *
+ * @param key Ключ
+ * @return bool true если ключ вычислялся
+ */
+bool ProtocolParser::vector_key(ResultCache::Key& key) const {
+    if (!keyed_) {
+        return false;
+    }
+    key = key_hasher_.key();
+    return true;
+}
+
+/**
+ * @brief Отказ от остатка потокового вектора
+ */
+void ProtocolParser::skip_vector() {
+    if (stage_ == Stage::VectorData && streaming_) {
+        skipping_ = true;
+    }
+}
+
+/**
+ * @brief Прекращение разбора
+ */
+void ProtocolParser::finish() {
+    stage_ = Stage::Done;
+    buffer_.clear();
+    pending_consume_ = 0;
+    chunk_ = nullptr;
+    chunk_count_ = 0;
+}
+
+/**
+ * @brief Начало неразобранных данных
+ *
+ * @param length Максимальная длина
+ * @return std::string Префикс буфера
+ */
+std::string ProtocolParser::preview(size_t length) const {
+    return std::string(buffer_.data(), std::min(length, buffer_.size()));
+}
+
+/**
+ * @brief Поиск аутентификационных данных
+ *
+ * @return Event Credentials, BadCredentials или NeedMore
+ *
+ * @details
+ * Ищет первые 48 HEX символов подряд (соль 16 + хэш 32). Все, что перед
+ * ними, - логин. Буфер просматривается один раз: байты классифицируются
+ * блоками по 64 (SSE2 по 16 байт), серия hex-цифр ищется по битовой
+ * маске блока. Длина текущей серии и ее начало переносятся между
+ * вызовами, поэтому каждый байт проверяется один раз, как бы ни были
+ * разбиты данные между приемами.
+ */
+ProtocolParser::Event ProtocolParser::parse_credentials() {
+    const char* data = buffer_.data();
+    // Серия, начавшаяся в пределах kCredentialsSearchLimit, заканчивается не дальше
+    size_t end = std::min(buffer_.size(), kCredentialsSearchLimit + kCredentialsLength);
+
+    while (scanned_ < end) {
+        size_t length = std::min(end - scanned_, (size_t)64);
+        uint64_t mask = hex_mask(data + scanned_, length);
+        size_t i = 0;
+        while (i < length) {
+            // Серия hex-цифр с позиции i: количество младших единиц маски
+            uint64_t rest = mask >> i;
+            size_t ones = ~rest == 0 ? 64 : __builtin_ctzll(~rest);
+            ones = std::min(ones, length - i);
+            if (ones > 0) {
+                if (run_length_ == 0) {
+                    run_start_ = scanned_ + i;
+                }
+                run_length_ += ones;
+                i += ones;
+                if (run_length_ >= kCredentialsLength) {
+                    credentials_offset_ = run_start_;
+                    login_.assign(data, run_start_);
+                    salt_.assign(data + run_start_, 16);
+                    hash_.assign(data + run_start_ + 16, 32);
+                    buffer_.consume(run_start_ + kCredentialsLength);
+                    stage_ = Stage::VectorCount;
+                    return Event::Credentials;
+                }
+                continue;
+            }
+            // Серия прервана: пропускаем байты до следующей hex-цифры
+            run_length_ = 0;
+            i = rest == 0 ? length : std::min(i + __builtin_ctzll(rest), length);
+        }
+        scanned_ += length;
+    }
+
+    size_t earliest = run_length_ > 0 ? run_start_ : scanned_;
+    if (earliest < kCredentialsSearchLimit) {
+        // Соль и хэш еще могут начаться в пределах ограничения
+        return Event::NeedMore;
+    }
+    stage_ = Stage::Done;
+    return Event::BadCredentials;
+}
+
+/**
+ * @brief Разбор количества векторов
+ *
+ * @return Event VectorCount, BadHeader или NeedMore
+ *
+ * @details
+ * Если вместо количества пришел kExtendedHeader, разбор ждет весь
+ * заголовок (12 байт) и только потом извлекает его из буфера.
+ * Неизвестный тип элементов или операция (в том числе точное
+ * произведение для float/double) завершают разбор.
+ */
+ProtocolParser::Event ProtocolParser::parse_vector_count() {
+    if (buffer_.size() < 4) {
+        return Event::NeedMore;
+    }
+
+    uint32_t count;
+    memcpy(&count, buffer_.data(), 4);
+    if (count == kExtendedHeader) {
+        if (buffer_.size() < 12) {
+            return Event::NeedMore;
+        }
+        uint8_t type = static_cast<uint8_t>(buffer_.data()[4]);
+        uint8_t operation = static_cast<uint8_t>(buffer_.data()[5]);
+        bool floating = type == static_cast<uint8_t>(ElementType::Float32) ||
+                        type == static_cast<uint8_t>(ElementType::Float64);
+        if (type > static_cast<uint8_t>(ElementType::Float64) ||
+            operation > static_cast<uint8_t>(Operation::ExactProduct) ||
+            (operation == static_cast<uint8_t>(Operation::ExactProduct) && floating)) {
+            stage_ = Stage::Done;
+            return Event::BadHeader;
+        }
+        element_type_ = static_cast<ElementType>(type);
+        operation_ = static_cast<Operation>(operation);
+        element_size_ = element_size(element_type_);
+        buffer_.consume(8);
+    }
+
+    vector_count_ = take_uint32();
+    stage_ = (vector_count_ == 0) ? Stage::Done : Stage::VectorSize;
+    return Event::VectorCount;
+}
+
+/**
+ * @brief Извлечение 32-битного беззнакового числа из буфера
+ *
+ * @return uint32_t Извлеченное число
+ *
+ * @note Вызывающая сторона проверяет, что в буфере есть 4 байта
+ * @note Не использует ntohl() - предполагается что данные уже в правильном порядке
+ */
+uint32_t ProtocolParser::take_uint32() {
+    uint32_t value;
+    memcpy(&value, buffer_.data(), 4);
+    buffer_.consume(4);
+    return value;
+}
@@ -0,0 +1,301 @@
+/**
+ * @file result_cache.cpp
+ * @brief Реализация кэша результатов
+ *
+ * @see result_cache.h
+ */
+
+#include "../include/result_cache.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+namespace {
+
+/**
+ * @brief Константы смешивания (нечетные, с равномерно распределенными битами)
+ */
+const uint64_t kSecret[4] = {0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL,
+                             0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL};
+
+/**
+ * @brief Умножение 64x64->128 со сверткой половин
+ */
+inline uint64_t mix(uint64_t a, uint64_t b) {
+    unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+}
+
+/**
+ * @brief Случайное начальное значение хэша процесса
+ *
+ * @details
+ * Без секрета клиент мог бы подобрать блок, обнуляющий дорожку хэша, и
+ * получить чужой результат для другого вектора той же длины.
+ */
+uint64_t process_seed() {
+    static const uint64_t seed = []() {
+        std::random_device device;
+        return (static_cast<uint64_t>(device()) << 32) ^ device();
+    }();
+    return seed;
+}
+
+/**
+ * @brief Начальное состояние хэша
+ *
+ * @param seed Начальное значение
+ * @param secret Константы дорожек
+ * @param lanes Дорожки
+ */
+inline void start_hash(uint64_t seed, uint64_t* secret, uint64_t* lanes) {
+    for (int i = 0; i < 4; i++) {
+        secret[i] = kSecret[i] ^ seed;
+        lanes[i] = secret[i];
+    }
+}
+
+/**
+ * @brief Сворачивает целые 64-байтные блоки в дорожки
+ *
+ * @param secret Константы дорожек
+ * @param lanes Дорожки
+ * @param bytes Блоки
+ * @param blocks Количество блоков
+ */
+inline void absorb_blocks(const uint64_t* secret, uint64_t* lanes, const char* bytes, size_t blocks) {
+    uint64_t s0 = lanes[0], s1 = lanes[1], s2 = lanes[2], s3 = lanes[3];
+    uint64_t w[8];
+
+    // Четыре независимые цепочки умножений по 16 байт
+    for (size_t i = 0; i < blocks; i++, bytes += 64) {
+        memcpy(w, bytes, 64);
+        s0 = mix(w[0] ^ secret[0], w[1] ^ s0);
+        s1 = mix(w[2] ^ secret[1], w[3] ^ s1);
+        s2 = mix(w[4] ^ secret[2], w[5] ^ s2);
+        s3 = mix(w[6] ^ secret[3], w[7] ^ s3);
+    }
+    lanes[0] = s0;
+    lanes[1] = s1;
+    lanes[2] = s2;
+    lanes[3] = s3;
+}
+
+/**
+ * @brief Завершает хэш
+ *
+ * @param secret Константы дорожек
+ * @param lanes Дорожки после всех целых 64-байтных блоков
+ * @param tail Остаток (меньше 64 байт)
+ * @param tail_length Длина остатка
+ * @param length Длина всех данных
+ * @return uint64_t Хэш
+ */
+uint64_t finish_hash(const uint64_t* secret, const uint64_t* lanes, const char* tail, size_t tail_length,
+                     uint64_t length) {
+    uint64_t h = mix(lanes[0] ^ secret[1], lanes[1]) ^ mix(lanes[2] ^ secret[3], lanes[3]);
+    uint64_t w[2];
+    size_t i = 0;
+
+    for (; i + 16 <= tail_length; i += 16) {
+        memcpy(w, tail + i, 16);
+        h = mix(w[0] ^ secret[1], w[1] ^ h);
+    }
+    w[0] = 0;
+    w[1] = 0;
+    memcpy(w, tail + i, tail_length - i);
+    h = mix(w[0] ^ secret[2], w[1] ^ h);
+    return mix(h ^ secret[0], length ^ secret[3]);
+}
+
+} // namespace
+
+/**
+ * @brief Конструктор
+ *
+ * @param memory_bytes Ограничение памяти
+ * @param shards Количество шардов
+ */
+ResultCache::ResultCache(size_t memory_bytes, size_t shards) : hits_(0), misses_(0), evictions_(0) {
+    size_t count = 1;
+    while (count < shards) {
+        count <<= 1;
+    }
+    size_t capacity = memory_bytes / kEntryBytes / count;
+    for (size_t i = 0; i < count; i++) {
+        shards_.push_back(std::unique_ptr<Shard>(new Shard()));
+        shards_.back()->capacity = capacity > 0 ? capacity : 1;
+    }
+}
+
+/**
+ * @brief Хэш
+ *
+ * @param data Данные
+ * @param length Длина в байтах
+ * @param seed Начальное значение
+ * @return uint64_t Хэш
+ */
+uint64_t ResultCache::hash(const void* data, size_t length, uint64_t seed) {
+    const char* bytes = static_cast<const char*>(data);
+    uint64_t secret[4];
+    uint64_t lanes[4];
+    start_hash(seed, secret, lanes);
+    size_t blocks = length / 64;
+    absorb_blocks(secret, lanes, bytes, blocks);
+    return finish_hash(secret, lanes, bytes + blocks * 64, length - blocks * 64, length);
+}
+
+/**
+ * @brief Ключ для элементов вектора
+ *
+ * @param data Байты элементов
+ * @param count Количество элементов
+ * @return Key Ключ
+ */
+ResultCache::Key ResultCache::make_key(const void* data, size_t count) {
+    Key key;
+    key.hash = hash(data, count * 4, process_seed());
+    key.count = static_cast<uint32_t>(count);
+    return key;
+}
+
+/**
+ * @brief Инкрементальный ключ с начальным значением процесса
+ */
+ResultCache::KeyHasher::KeyHasher() {
+    reset();
+}
+
+/**
+ * @brief Сброс к пустому ключу
+ */
+void ResultCache::KeyHasher::reset() {
+    start_hash(process_seed(), secret_, lanes_);
+    tail_length_ = 0;
+    length_ = 0;
+}
+
+/**
+ * @brief Добавление байт
+ *
+ * @param data Данные
+ * @param length Длина в байтах
+ *
+ * @details
+ * Целые 64-байтные блоки сворачиваются прямо из data; копируется только
+ * неполный блок на стыке порций.
+ */
+void ResultCache::KeyHasher::update(const void* data, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    const char* bytes = static_cast<const char*>(data);
+    length_ += length;
+    if (tail_length_ > 0) {
+        size_t take = std::min(length, sizeof(tail_) - tail_length_);
+        memcpy(tail_ + tail_length_, bytes, take);
+        tail_length_ += take;
+        bytes += take;
+        length -= take;
+        if (tail_length_ < sizeof(tail_)) {
+            return;
+        }
+        absorb_blocks(secret_, lanes_, tail_, 1);
+        tail_length_ = 0;
+    }
+    size_t blocks = length / 64;
+    absorb_blocks(secret_, lanes_, bytes, blocks);
+    tail_length_ = length - blocks * 64;
+    memcpy(tail_, bytes + blocks * 64, tail_length_);
+}
+
+/**
+ * @brief Ключ поданных байт
+ *
+ * @return Key Тот же ключ, что make_key() для всех байт подряд
+ */
+ResultCache::Key ResultCache::KeyHasher::key() const {
+    Key key;
+    key.hash = finish_hash(secret_, lanes_, tail_, tail_length_, length_);
+    key.count = static_cast<uint32_t>(length_ / 4);
+    return key;
+}
+
+/**
+ * @brief Шард для ключа
+ *
+ * @details
+ * Индекс шарда берется из старших бит хэша, а корзина unordered_map - из
+ * младших, поэтому записи одного шарда равномерно распределены по корзинам.
+ */
+ResultCache::Shard& ResultCache::shard_for(const Key& key) {
+    return *shards_[(key.hash >> 48) & (shards_.size() - 1)];
+}
+
+/**
+ * @brief Поиск результата
+ *
+ * @param key Ключ
+ * @param result Результат при попадании
+ * @return bool true при попадании
+ */
+bool ResultCache::find(const Key& key, int32_t& result) {
+    Shard& shard = shard_for(key);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            result = it->second->result;
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+/**
+ * @brief Добавление результата
+ *
+ * @param key Ключ
+ * @param result Результат
+ */
+void ResultCache::insert(const Key& key, int32_t result) {
+    Shard& shard = shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        it->second->result = result;
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return;
+    }
+
+    if (shard.index.size() >= shard.capacity) {
+        shard.index.erase(shard.lru.back().key);
+        shard.lru.pop_back();
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+    shard.lru.push_front(Entry{key, result});
+    shard.index[key] = shard.lru.begin();
+}
+
+/**
+ * @brief Текущие счетчики
+ *
+ * @return Stats Попадания, промахи, вытеснения и количество записей
+ */
+ResultCache::Stats ResultCache::stats() const {
+    Stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    stats.entries = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        stats.entries += shard->index.size();
+    }
+    return stats;
+}
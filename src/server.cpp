@@ -13,7 +13,8 @@
 
 #include <iostream>
 #include "../include/server.h"
-#include "../include/session.h"
+#include "../include/uring_loop.h"
+#include "../include/vector_processor.h"
 #include <fstream>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -21,6 +22,7 @@
 #include <cstring>
 #include <stdexcept>
 #include <arpa/inet.h>
+#include <thread>
 
 /**
  * @brief Конструктор сервера
@@ -31,29 +33,99 @@
  * Последовательность инициализации:
  * 1. Сохранение конфигурации
  * 2. Создание логгера с указанным файлом
- * 3. Загрузка базы данных клиентов
- * 4. Настройка серверного сокета
+ * 3. Выбор вычислительного ядра произведения
+ * 4. Загрузка базы данных клиентов
+ * 5. Настройка серверного сокета
  * 
  * @throw std::runtime_error при ошибках инициализации
  */
 Server::Server(const ServerConfig& config) 
-    : config_(config), logger_(config.log_file), server_fd_(-1) {
+    : config_(config), logger_(config.log_file), server_fd_(-1), next_worker_(0) {
+    select_kernel();
     load_clients();
     setup_socket();
 }
 
+/**
+ * @brief Выбор вычислительного ядра произведения
+ * 
+ * Активирует ядро из config.kernel и записывает его имя в лог.
+ * 
+ * @throw std::runtime_error если ядро неизвестно или не поддерживается процессором
+ */
+void Server::select_kernel() {
+    if (!VectorProcessor::select_kernel(config_.kernel)) {
+        std::string names;
+        for (const ProductKernel* kernel : VectorProcessor::kernels()) {
+            names += std::string(" ") + kernel->name;
+        }
+        logger_.log_error("Unknown or unsupported product kernel '" + config_.kernel +
+                          "' (available: auto" + names + ")", true);
+        throw std::runtime_error("Unsupported product kernel: " + config_.kernel);
+    }
+    logger_.log(std::string("Product kernel: ") + VectorProcessor::kernel().name);
+}
+
+/**
+ * @brief Кэш результатов для цикла обслуживания сессий
+ * 
+ * @param serving Количество циклов, обслуживающих сессии
+ * @return ResultCache* Кэш или nullptr
+ * 
+ * @details
+ * Общий кэш разбит на kGlobalCacheShards шардов по битам хэша, поэтому
+ * потоки блокируют друг друга, только попадая в один шард.
+ */
+ResultCache* Server::cache_for_worker(size_t serving) {
+    const size_t kGlobalCacheShards = 64;
+    
+    if (config_.cache_mb == 0) {
+        return nullptr;
+    }
+    size_t bytes = config_.cache_mb << 20;
+    if (config_.cache_placement == "global") {
+        if (caches_.empty()) {
+            caches_.push_back(std::unique_ptr<ResultCache>(new ResultCache(bytes, kGlobalCacheShards)));
+            logger_.log("Result cache: " + std::to_string(config_.cache_mb) + " MB, global, " +
+                        std::to_string(kGlobalCacheShards) + " shards");
+        }
+        return caches_.front().get();
+    }
+    caches_.push_back(std::unique_ptr<ResultCache>(new ResultCache(bytes / (serving > 0 ? serving : 1))));
+    if (caches_.size() == 1) {
+        logger_.log("Result cache: " + std::to_string(config_.cache_mb) + " MB, per worker (" +
+                    std::to_string(serving) + " workers)");
+    }
+    return caches_.back().get();
+}
+
 /**
  * @brief Деструктор сервера
  * 
- * Закрывает серверный сокет если он был открыт.
+ * Останавливает рабочие потоки и закрывает серверный сокет если он был открыт.
  * Автоматически вызывается при уничтожении объекта.
  */
 Server::~Server() {
+    workers_.clear();
+    shards_.clear();
     if (server_fd_ > 0) {
         close(server_fd_);
     }
 }
 
+/**
+ * @brief Деструктор шарда
+ * 
+ * Останавливает событийный цикл шарда и закрывает его слушающий сокет,
+ * если сокет был создан для этого шарда.
+ */
+Server::Shard::~Shard() {
+    worker.reset();
+    if (owns_listen_fd) {
+        close(listen_fd);
+    }
+}
+
 /**
  * @brief Загружает базу данных клиентов из файла
  * 
@@ -68,6 +140,7 @@ Server::~Server() {
  * 
  * @note Пароли хранятся в открытом виде (небезопасно!)
  * @note Пустые строки и строки без ':' игнорируются
+ * @note Логин или пароль длиннее CredentialTable::kMaxLength пропускается с ошибкой в логе
  */
 void Server::load_clients() {
     std::ifstream file(config_.client_db_file);
@@ -76,41 +149,66 @@ void Server::load_clients() {
         throw std::runtime_error("Cannot open client database");
     }
     
+    // Логин и пароль копируются из строки сразу в арену таблицы
     std::string line;
     while (std::getline(file, line)) {
         size_t pos = line.find(':');
         if (pos != std::string::npos) {
-            std::string login = line.substr(0, pos);
-            std::string password = line.substr(pos + 1);
-            clients_[login] = password;
+            try {
+                clients_.insert(line.data(), pos, line.data() + pos + 1, line.size() - pos - 1);
+            } catch (const std::invalid_argument& e) {
+                logger_.log_error("Skipping client entry: " + std::string(e.what()), false);
+            }
         }
     }
     file.close();
+    clients_.shrink_to_fit();
     
-    logger_.log("Loaded " + std::to_string(clients_.size()) + " clients");
+    logger_.log("Loaded " + std::to_string(clients_.size()) + " clients (" +
+                std::to_string(clients_.memory_bytes()) + " bytes)");
 }
 
 /**
  * @brief Настраивает серверный сокет
  * 
  * @details
+ * Создает слушающий сокет через create_listener(). В режиме шардов
+ * это слушающий сокет первого шарда, остальные создаются в accept_connections().
+ * 
+ * @throw std::runtime_error при ошибках системных вызовов (socket, bind, listen)
+ */
+void Server::setup_socket() {
+    server_fd_ = create_listener();
+    logger_.log("Server socket setup complete on port " + std::to_string(config_.port));
+}
+
+/**
+ * @brief Создает слушающий сокет
+ * 
+ * @return int Дескриптор неблокирующего слушающего сокета
+ * 
+ * @details
  * Выполняет следующие действия:
  * 1. Создает TCP сокет (AF_INET, SOCK_STREAM)
  * 2. Устанавливает опцию SO_REUSEADDR для быстрого переиспользования порта
+ *    и, в режиме шардов, SO_REUSEPORT для нескольких сокетов на одном порту
  * 3. Привязывает сокет к адресу INADDR_ANY и указанному порту
- * 4. Переводит сокет в режим прослушивания с очередью на 10 подключений
+ * 4. Переводит сокет в режим прослушивания с очередью SOMAXCONN подключений
+ * 5. Переводит сокет в неблокирующий режим для работы с epoll
  * 
  * @throw std::runtime_error при ошибках системных вызовов (socket, bind, listen)
  */
-void Server::setup_socket() {
-    server_fd_ = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_fd_ < 0) {
+int Server::create_listener() {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
         logger_.log_error("Socket creation failed", true);
         throw std::runtime_error("Socket creation failed");
     }
     
     int opt = 1;
-    if (setsockopt(server_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt))) {
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) ||
+        (config_.shards > 0 && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)))) {
+        close(fd);
         logger_.log_error("Setsockopt failed", true);
         throw std::runtime_error("Setsockopt failed");
     }
@@ -120,52 +218,157 @@ void Server::setup_socket() {
     address.sin_addr.s_addr = INADDR_ANY;
     address.sin_port = htons(config_.port);
     
-    if (bind(server_fd_, (struct sockaddr*)&address, sizeof(address)) < 0) {
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
+        close(fd);
         logger_.log_error("Bind failed on port " + std::to_string(config_.port), true);
         throw std::runtime_error("Bind failed");
     }
     
-    if (listen(server_fd_, 10) < 0) {
+    if (listen(fd, SOMAXCONN) < 0) {
+        close(fd);
         logger_.log_error("Listen failed", true);
         throw std::runtime_error("Listen failed");
     }
     
-    logger_.log("Server socket setup complete on port " + std::to_string(config_.port));
+    set_nonblocking(fd);
+    return fd;
 }
 
 /**
  * @brief Принимает входящие подключения
  * 
  * @details
- * Бесконечный цикл, который:
- * 1. Ожидает входящее подключение (accept)
- * 2. Получает IP-адрес клиента для логирования
- * 3. Создает объект Session для обработки подключения
- * 4. Запускает обработку сессии
- * 
- * @note Обработка блокирующая - следующее подключение ждет завершения текущего
- * @note При ошибке accept логирует ошибку и продолжает работу
+ * Однопоточный режим (threads == 0): один Worker в основном потоке
+ * принимает подключения и обслуживает их сессии.
+ * 
+ * Многопоточный режим (threads > 0):
+ * 1. Запускает threads рабочих потоков, у каждого свой событийный цикл
+ * 2. Основной поток принимает подключения и передает сокеты рабочим
+ *    потокам через ограниченные очереди
+ * 
+ * Транспорт io_uring (io_backend == "uring"): все сессии обслуживает один
+ * UringLoop в основном потоке. Если ядро не поддерживает io_uring,
+ * сервер возвращается к epoll.
+ * 
+ * @note Сессии обрабатываются конкурентно: медленный клиент не блокирует остальных
  */
 void Server::accept_connections() {
-    struct sockaddr_in address;
-    socklen_t addrlen = sizeof(address);
+    const size_t queue_capacity = 1024;
+    const bool issue_salt = config_.salt_source == "server";
+    
+    if (issue_salt) {
+        logger_.log("Challenge-response authentication: the server issues salts");
+    }
+    
+    if (config_.io_backend == "uring") {
+        if (UringLoop::supported()) {
+            if (config_.threads > 0 || config_.shards > 0) {
+                logger_.log("io_uring backend is single-threaded, -t and -s are ignored");
+            }
+            if (config_.auth_batch_us > 0) {
+                logger_.log("io_uring backend verifies logins one by one, -a is ignored");
+            }
+            UringLoop loop(clients_, logger_, cache_for_worker(1), issue_salt);
+            logger_.log("Server started with io_uring backend, waiting for connections...");
+            loop.run(server_fd_);
+            return;
+        }
+        logger_.log_error("io_uring is not available, falling back to epoll", false);
+    }
+    
+    if (config_.shards > 0) {
+        run_shards(queue_capacity, issue_salt);
+        return;
+    }
+    
+    if (config_.auth_batch_us > 0) {
+        logger_.log("Authentication batching: up to " + std::to_string(Md5Batch::lanes()) +
+                    " MD5 per batch, max wait " + std::to_string(config_.auth_batch_us) + " us");
+    }
+    
+    Worker acceptor(clients_, logger_, queue_capacity, config_.threads == 0 ? cache_for_worker(1) : nullptr,
+                    config_.threads == 0 ? config_.auth_batch_us : 0, issue_salt);
+    
+    if (config_.threads == 0) {
+        acceptor.listen_on(server_fd_);
+    } else {
+        for (int i = 0; i < config_.threads; i++) {
+            ResultCache* cache = cache_for_worker(static_cast<size_t>(config_.threads));
+            workers_.push_back(std::unique_ptr<Worker>(new Worker(clients_, logger_, queue_capacity, cache,
+                                                                  config_.auth_batch_us, issue_salt)));
+            workers_.back()->start();
+        }
+        acceptor.listen_on(server_fd_, [this](int client_socket) { dispatch(client_socket); });
+        logger_.log("Started " + std::to_string(config_.threads) + " worker threads");
+    }
+    
+    logger_.log("Server started, waiting for connections...");
+    acceptor.run();
+}
+
+/**
+ * @brief Запускает сервер в режиме шардов
+ * 
+ * @param queue_capacity Емкость очереди входящих сокетов Worker
+ * @param issue_salt Режим вызов-ответ: соль выдает сервер
+ * 
+ * @details
+ * Для каждого из config.shards шардов:
+ * 1. Создает собственный буферизованный Logger (без вывода в консоль)
+ *    и копию базы клиентов
+ * 2. Открывает собственный слушающий сокет с SO_REUSEPORT
+ *    (первый шард использует server_fd_)
+ * 3. Запускает Worker в отдельном потоке, закрепленном за ядром
+ *    с номером шарда (по модулю числа ядер)
+ * 
+ * Последний шард работает в основном потоке. Ядро само распределяет
+ * входящие подключения между слушающими сокетами, поэтому на горячем
+ * пути шарды не разделяют ни данных, ни блокировок.
+ */
+void Server::run_shards(size_t queue_capacity, bool issue_salt) {
+    unsigned cores = std::thread::hardware_concurrency();
+    if (cores == 0) {
+        cores = 1;
+    }
     
+    for (int i = 0; i < config_.shards; i++) {
+        int listen_fd = (i == 0) ? server_fd_ : create_listener();
+        std::unique_ptr<Shard> shard(new Shard(config_.log_file, clients_, listen_fd, i != 0));
+        shard->worker.reset(new Worker(shard->clients, shard->logger, queue_capacity,
+                                       cache_for_worker(static_cast<size_t>(config_.shards)),
+                                       config_.auth_batch_us, issue_salt));
+        shard->worker->listen_on(listen_fd);
+        shards_.push_back(std::move(shard));
+    }
+    
+    logger_.log("Started " + std::to_string(config_.shards) + " SO_REUSEPORT shards on port " +
+                std::to_string(config_.port) + " (session logs buffered per shard, file only)");
     logger_.log("Server started, waiting for connections...");
     
-    while (true) {
-        int client_socket = accept(server_fd_, (struct sockaddr*)&address, &addrlen);
-        if (client_socket < 0) {
-            logger_.log_error("Accept failed", false);
-            continue;
+    for (int i = 0; i + 1 < config_.shards; i++) {
+        shards_[i]->worker->start(static_cast<int>(i % cores));
+    }
+    
+    int last = config_.shards - 1;
+    pin_to_cpu(static_cast<int>(last % cores));
+    shards_[last]->worker->run();
+}
+
+/**
+ * @brief Передает сокет рабочему потоку
+ * 
+ * @param client_socket Неблокирующий сокет клиента
+ */
+void Server::dispatch(int client_socket) {
+    size_t start = next_worker_;
+    next_worker_ = (next_worker_ + 1) % workers_.size();
+    
+    for (size_t i = 0; i < workers_.size(); i++) {
+        if (workers_[(start + i) % workers_.size()]->submit(client_socket, false)) {
+            return;
         }
-        
-        char client_ip[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &address.sin_addr, client_ip, INET_ADDRSTRLEN);
-        logger_.log("New connection from " + std::string(client_ip));
-        
-        Session session(client_socket, clients_, logger_);
-        session.handle();
     }
+    workers_[start]->submit(client_socket, true);
 }
 
 /**
@@ -13,17 +13,61 @@
 
 #include "../include/session.h"
 #include "logger.h"
+#include "../include/result_cache.h"
+#include "../include/auth.h"
+#include "../include/auth_batch.h"
 #include <sys/socket.h>
 #include <unistd.h>
 #include <cstring>
 #include <iostream>
 #include <arpa/inet.h>
-#include <openssl/md5.h>
-#include <sstream>
-#include <iomanip>
 #include <algorithm>
 #include <vector>
 #include <climits>
+#include <cerrno>
+#include <stdexcept>
+#include <sys/epoll.h>
+
+namespace {
+
+/**
+ * @brief Векторы длиннее этого (в элементах) не хранятся в памяти целиком
+ * 
+ * Их произведение вычисляется потоково по мере приема (1 МБ данных).
+ */
+const uint32_t kStreamThreshold = 1 << 18;
+
+/**
+ * @brief Размер накопленных результатов, при котором они отправляются не дожидаясь
+ *        окончания входных данных
+ */
+const size_t kFlushThreshold = 64 * 1024;
+
+/**
+ * @brief Сколько байт сессия принимает за одно событие on_event()
+ * 
+ * Остальное дочитывается следующим вызовом из очереди готовых сессий
+ * Worker, чтобы один быстрый клиент не задерживал остальных.
+ */
+const size_t kReadBudget = 256 * 1024;
+
+/**
+ * @brief Неотправленный вывод, при котором сессия перестает читать и разбирать
+ *        входные данные
+ * 
+ * Клиент, который шлет векторы и не читает результаты, иначе заставил бы
+ * send_buffer расти без предела. Чтение возобновляется, когда EPOLLOUT
+ * позволит сбросить вывод ниже порога.
+ */
+const size_t kOutputHighWater = 4 * kFlushThreshold;
+
+/**
+ * @brief Векторы короче этого не ищутся в кэше результатов: их произведение
+ *        дешевле хэша и блокировки шарда
+ */
+const size_t kCacheMinElements = 256;
+
+} // namespace
 
 /**
  * @brief Конструктор сессии
@@ -31,9 +75,41 @@
  * @param client_socket Сокет подключенного клиента
  * @param clients База данных клиентов
  * @param logger Логгер для записи событий
+ * @param socket_io Выполняет ли сессия ввод-вывод сама
+ * @param cache Кэш результатов или nullptr
+ * @param auth_batcher Пакетная проверка или nullptr
+ * @param issue_salt Выдать клиенту соль (режим вызов-ответ)
+ * 
+ * @throw std::runtime_error если не удалось получить случайные байты для соли
  */
-Session::Session(int client_socket, std::unordered_map<std::string, std::string>& clients, Logger& logger)
-    : client_socket(client_socket), clients(clients), logger(logger) {
+Session::Session(int client_socket, const CredentialTable& clients, Logger& logger,
+                 bool socket_io, ResultCache* cache, AuthBatcher* auth_batcher, bool issue_salt)
+    : client_socket(client_socket), socket_io(socket_io), clients(clients), logger(logger), cache(cache),
+      auth_batcher(auth_batcher), auth_pending(false), read_more(false), input_blocked(false),
+      parser(kStreamThreshold, cache != nullptr ? static_cast<uint32_t>(kCacheMinElements) : UINT32_MAX) {
+    logger.log("=== NEW CLIENT CONNECTION ===");
+    if (issue_salt) {
+        issued_salt = Authenticator::generate_salt_16();
+        send_buffer.append(issued_salt);
+        send_buffer.push_back('\n');
+        logger.log("Issued salt: " + issued_salt);
+    }
+}
+
+/**
+ * @brief Деструктор сессии
+ * 
+ * Закрывает клиентский сокет, если он не был закрыт в handle().
+ * При внешнем транспорте сокет закрывает транспорт. Ожидающая проверка
+ * отменяется: она ссылается на соль и хэш этой сессии.
+ */
+Session::~Session() {
+    if (auth_pending) {
+        auth_batcher->cancel(client_socket);
+    }
+    if (socket_io && client_socket >= 0) {
+        close(client_socket);
+    }
 }
 
 /**
@@ -45,190 +121,341 @@ Session::Session(int client_socket, std::unordered_map<std::string, std::string>
  * 3. Вычисление произведений
  * 4. Отправка результатов
  * 
+ * @details
+ * Блокирующий драйвер конечного автомата: принимает очередную порцию
+ * данных, продвигает разбор и отправляет накопленные результаты, пока
+ * сессия не завершится.
+ * 
  * @note Закрывает клиентский сокет при завершении (успешном или с ошибкой)
- * @throw std::exception перехватывает и логирует исключения
  */
 void Session::handle() {
     try {
-        process_vectors();
+        // Выданная соль
+        if (!flush_send_buffer()) {
+            throw std::runtime_error("Send error");
+        }
+        while (!parser.finished()) {
+            receive_to_buffer();
+            process_input();
+            if (!flush_send_buffer()) {
+                throw std::runtime_error("Send error");
+            }
+        }
     } catch (const std::exception& e) {
-        logger.log("Session error: " + std::string(e.what()));
+        fail(e.what());
     }
     close(client_socket);
+    client_socket = -1;
 }
 
 /**
- * @brief Прием данных в буфер
+ * @brief Обработка события готовности сокета
  * 
- * Принимает данные из сокета и добавляет их во внутренний буфер.
- * Блокирующая операция - ждет поступления данных.
+ * @param events Маска событий epoll
+ * @return bool true если сессия продолжается
  * 
- * @throw std::runtime_error при закрытии соединения или ошибке приема
+ * @details
+ * 1. Дописывает отложенный вывод
+ * 2. При готовности на чтение (или если чтение было остановлено выводом)
+ *    принимает данные порциями до EAGAIN, после каждой порции продвигая
+ *    разбор протокола, но не больше kReadBudget байт; если бюджет исчерпан
+ *    раньше EAGAIN, взводит input_pending()
+ * 3. Пока неотправленный вывод не ниже kOutputHighWater, не читает и не
+ *    разбирает входные данные: продолжит по EPOLLOUT
+ * 4. Отправляет результаты, накопленные за все порции, одним вызовом send()
+ * 
+ * @note Ошибки протокола и сети переводят сессию в состояние Done
+ * @note Пока проверка аутентификации стоит в пакете, сокет не читается:
+ *       данные дочитывает on_auth_verified()
  */
-void Session::receive_to_buffer() {
-    char buffer[4096];
-    ssize_t bytes_received = recv(client_socket, buffer, sizeof(buffer) - 1, 0);
-    
-    if (bytes_received > 0) {
-        buffer[bytes_received] = '\0';
-        receive_buffer.append(buffer, bytes_received);
-    } else if (bytes_received == 0) {
-        throw std::runtime_error("Connection closed by client");
-    } else {
-        throw std::runtime_error("Receive error");
+bool Session::on_event(uint32_t events) {
+    try {
+        if (!send_buffer.empty() && !flush_send_buffer()) {
+            parser.finish();
+            send_buffer.clear();
+        }
+        if ((events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) || input_blocked) {
+            read_more = false;
+            input_blocked = false;
+            size_t budget = kReadBudget;
+            // Данные, разбор которых остановил вывод
+            process_input();
+            while (!parser.finished() && !auth_pending) {
+                if (output_blocked()) {
+                    if (!flush_send_buffer()) {
+                        parser.finish();
+                        send_buffer.clear();
+                        break;
+                    }
+                    if (output_blocked()) {
+                        input_blocked = true;
+                        break;
+                    }
+                    process_input();
+                    continue;
+                }
+                if (budget == 0) {
+                    read_more = true;
+                    break;
+                }
+                size_t received = receive_to_buffer(budget);
+                if (received == 0) {
+                    break;
+                }
+                budget -= received;
+                process_input();
+            }
+        }
+        if (!send_buffer.empty() && !flush_send_buffer()) {
+            parser.finish();
+            send_buffer.clear();
+        }
+    } catch (const std::exception& e) {
+        fail(e.what());
     }
+    
+    return !parser.finished() || !send_buffer.empty();
 }
 
 /**
- * @brief Извлечение точного количества байт из буфера
+ * @brief Возобновление после пакетной проверки
  * 
- * @param length Количество байт для извлечения
- * @return std::string Извлеченные данные
+ * @param success Результат проверки
+ * @return bool true если сессия продолжается
  * 
  * @details
- * Если в буфере недостаточно данных, вызывает receive_to_buffer()
- * до тех пор, пока не наберется нужное количество байт.
+ * Edge-triggered epoll не повторит событие для данных, пришедших во время
+ * ожидания, поэтому сокет дочитывается здесь же через on_event(EPOLLIN).
+ */
+bool Session::on_auth_verified(bool success) {
+    auth_pending = false;
+    try {
+        complete_auth(success);
+        process_input();
+    } catch (const std::exception& e) {
+        fail(e.what());
+    }
+    return on_event(EPOLLIN);
+}
+
+/**
+ * @brief Прием данных от внешнего транспорта
  * 
- * @note Удаляет извлеченные данные из буфера
+ * @param data Принятые байты
+ * @param length Количество байт
  */
-std::string Session::extract_from_buffer_exact(size_t length) {
-    while (receive_buffer.size() < length) {
-        receive_to_buffer();
+void Session::feed(const char* data, size_t length) {
+    if (parser.finished()) {
+        return;
+    }
+    try {
+        parser.feed(data, length);
+        process_input();
+    } catch (const std::exception& e) {
+        fail(e.what());
     }
-    
-    std::string result = receive_buffer.substr(0, length);
-    receive_buffer.erase(0, length);
-    return result;
 }
 
 /**
- * @brief Отправка текста клиенту
+ * @brief Закрытие соединения клиентом при внешнем транспорте
  * 
- * @param text Текст для отправки
- * @return bool true если отправка успешна, false при ошибке
+ * @param error Текст ошибки
  * 
- * @details
- * Отправляет данные частями, пока все не будет отправлено.
- * Обрабатывает частичную отправку (short write).
+ * @note Если сессия уже завершена, ничего не делает
  */
-bool Session::send_text(const std::string& text) {
-    size_t total_sent = 0;
-    const char* buffer = text.c_str();
-    size_t length = text.length();
-    
-    while (total_sent < length) {
-        ssize_t bytes_sent = send(client_socket, buffer + total_sent, length - total_sent, 0);
-        if (bytes_sent <= 0) {
-            return false;
-        }
-        total_sent += bytes_sent;
+void Session::on_receive_closed(const std::string& error) {
+    if (!parser.finished()) {
+        fail(error);
     }
-    
-    return true;
 }
 
 /**
- * @brief Вычисление MD5 хэша
+ * @brief Передача накопленного вывода внешнему транспорту
+ * 
+ * @param out Строка для дописывания данных
+ */
+void Session::take_output(std::string& out) {
+    out.append(send_buffer);
+    send_buffer.clear();
+}
+
+/**
+ * @brief Проверка, остались ли в сокете непрочитанные данные
+ * 
+ * @return bool true если последний on_event() исчерпал бюджет чтения
+ */
+bool Session::input_pending() const {
+    return read_more && !parser.finished();
+}
+
+/**
+ * @brief Проверка, достиг ли неотправленный вывод kOutputHighWater
+ * 
+ * @return bool true если чтение и разбор нужно приостановить
  * 
- * @param data Данные для хэширования
- * @return std::string MD5 хэш в hex формате (32 символа, lowercase)
+ * @note При внешнем транспорте вывод забирает take_output(), и ограничение
+ *       соблюдает сам транспорт
+ */
+bool Session::output_blocked() const {
+    return socket_io && send_buffer.size() >= kOutputHighWater;
+}
+
+/**
+ * @brief Проверка завершения разбора протокола
  * 
- * @note Использует OpenSSL MD5 implementation
+ * @return bool true если разбор протокола завершен
  */
-std::string Session::calculate_md5(const std::string& data) {
-    unsigned char md5_hash[MD5_DIGEST_LENGTH];
-    MD5(reinterpret_cast<const unsigned char*>(data.c_str()), 
-        data.length(), md5_hash);
+bool Session::finished() const {
+    return parser.finished();
+}
+
+/**
+ * @brief Прием данных в буфер
+ * 
+ * @param limit Максимум байт за один вызов recv()
+ * @return size_t Количество принятых байт; 0 если сокет неблокирующий
+ *         и данных пока нет (EAGAIN)
+ * 
+ * Принимает данные из сокета прямо в буфер разбора протокола, заполняя
+ * все свободное место в его хвосте (не менее 16 КБ). Если разбор ждет
+ * элементы вектора, а буфер пуст, данные принимаются прямо в память вектора.
+ * На блокирующем сокете ждет поступления данных.
+ * 
+ * @throw std::runtime_error при закрытии соединения или ошибке приема
+ */
+size_t Session::receive_to_buffer(size_t limit) {
+    const size_t chunk = 16384;
+    ByteBuffer& input = parser.input();
     
-    std::stringstream ss;
-    for (int i = 0; i < MD5_DIGEST_LENGTH; i++) {
-        ss << std::hex << std::setw(2) << std::setfill('0') 
-           << static_cast<int>(md5_hash[i]);
+    // Элементы вектора принимаются прямо в его память, остальное - в буфер
+    size_t capacity = parser.direct_capacity();
+    bool direct = capacity > 0;
+    char* area;
+    if (direct) {
+        area = parser.direct_area();
+    } else {
+        area = input.prepare(chunk);
+        capacity = input.writable();
+    }
+    capacity = std::min(capacity, limit);
+    
+    ssize_t bytes_received;
+    do {
+        bytes_received = recv(client_socket, area, capacity, 0);
+    } while (bytes_received < 0 && errno == EINTR);
+    
+    if (bytes_received > 0) {
+        if (direct) {
+            parser.commit_direct(static_cast<size_t>(bytes_received));
+        } else {
+            input.commit(static_cast<size_t>(bytes_received));
+        }
+        return static_cast<size_t>(bytes_received);
+    } else if (bytes_received == 0) {
+        throw std::runtime_error("Connection closed by client");
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return 0;
+    } else {
+        throw std::runtime_error("Receive error");
     }
-    return ss.str();
 }
 
 /**
- * @brief Вычисление произведения элементов вектора
+ * @brief Отправка текста клиенту
  * 
- * @param vector Вектор целых чисел
- * @return int32_t Произведение элементов с контролем переполнения
+ * @param text Текст для отправки
+ * @return bool true если отправка успешна, false при ошибке
  * 
  * @details
- * Алгоритм:
- * 1. Использует 64-битные вычисления для предотвращения промежуточного переполнения
- * 2. Проверяет переполнение перед каждым умножением
- * 3. При переполнении возвращает INT32_MAX или INT32_MIN
+ * Добавляет данные в буфер отправки и пытается отправить его целиком.
+ * Обрабатывает частичную отправку (short write).
+ */
+bool Session::send_text(const std::string& text) {
+    send_buffer.append(text);
+    return flush_send_buffer();
+}
+
+/**
+ * @brief Отправка накопленного буфера
  * 
- * @note Для пустого вектора возвращает 0
+ * @param more true - за этими данными сразу последуют другие (MSG_MORE):
+ *        ядро может придержать неполный TCP-сегмент
+ * @return bool false при ошибке отправки, true если буфер отправлен
+ *         или сокет временно не готов к записи (EAGAIN)
+ * 
+ * @note Использует MSG_NOSIGNAL, чтобы разрыв соединения не завершал
+ *       сервер сигналом SIGPIPE
+ * @note При внешнем транспорте ничего не отправляет (см. take_output())
  */
-int32_t Session::calculate_vector_product(const std::vector<int32_t>& vector) {
-    if (vector.empty()) {
-        return 0;
+bool Session::flush_send_buffer(bool more) {
+    if (!socket_io) {
+        return true;
     }
     
-    int64_t product = 1;
-    for (int32_t val : vector) {
-        // Проверка переполнения при умножении
-        // Используем static_cast<int64_t> для безопасного преобразования
-        int64_t val64 = static_cast<int64_t>(val);
-        
-        if (val64 != 0 && llabs(product) > INT64_MAX / llabs(val64)) {
-            // Переполнение
-            if ((product > 0 && val64 > 0) || (product < 0 && val64 < 0)) {
-                return INT32_MAX;
-            } else {
-                return INT32_MIN;
-            }
+    size_t total_sent = 0;
+    
+    while (total_sent < send_buffer.size()) {
+        ssize_t bytes_sent = send(client_socket, send_buffer.data() + total_sent,
+                                  send_buffer.size() - total_sent,
+                                  MSG_NOSIGNAL | (more ? MSG_MORE : 0));
+        if (bytes_sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytes_sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (bytes_sent <= 0) {
+            return false;
         }
-        product *= val64;
+        total_sent += bytes_sent;
     }
     
-    // Проверка выхода за пределы int32
-    if (product > INT32_MAX) {
-        return INT32_MAX;
-    } else if (product < INT32_MIN) {
-        return INT32_MIN;
+    send_buffer.erase(0, total_sent);
+    return true;
+}
+
+/**
+ * @brief Завершение сессии с ошибкой
+ * 
+ * @param error Текст ошибки
+ * 
+ * Логирует ошибку, отправляет клиенту "err\n" и завершает разбор протокола.
+ */
+void Session::fail(const std::string& error) {
+    logger.log("err: " + error);
+    parser.finish();
+    if (!send_text("err\n")) {
+        send_buffer.clear();
     }
-    
-    return static_cast<int32_t>(product);
 }
 
 /**
- * @brief Проверка аутентификации клиента
+ * @brief Поиск пароля и проверка формата учетных данных
  * 
  * @param login Логин клиента
  * @param salt Соль (16 hex символов)
  * @param received_hash Хэш от клиента (32 hex символа)
- * @return bool true если аутентификация успешна
+ * @param password Пароль из базы (в арене таблицы клиентов)
+ * @return bool true если логин найден и формат верен
  * 
  * @details
  * Выполняет следующие проверки:
  * 1. Существование логина в базе
  * 2. Формат соли и хэша (длина и hex символы)
- * 3. Сравнение MD5(salt + stored_password) с полученным хэшем
+ * 3. В режиме вызов-ответ - совпадение соли с выданной (без учета регистра)
  * 
- * @note Детально логирует все шаги проверки для отладки
+ * @note Логирует только причину отказа; пароль, соль и хэш в лог не пишутся
  */
-bool Session::verify_authentication(const std::string& login, 
-                                   const std::string& salt, 
-                                   const std::string& received_hash) {
+bool Session::find_password(const std::string& login,
+                            const std::string& salt,
+                            const std::string& received_hash,
+                            CredentialTable::View& password) {
     // Ищем пользователя в базе
-    auto it = clients.find(login);
-    if (it == clients.end()) {
+    if (!clients.find(login, password)) {
         logger.log("err: User '" + login + "' not found");
         return false;
     }
     
-    std::string stored_password = it->second;
-    
-    // Логируем для отладки
-    logger.log("=== AUTHENTICATION ===");
-    logger.log("Login: " + login);
-    logger.log("Salt: " + salt);
-    logger.log("Received hash: " + received_hash);
-    logger.log("Stored password: " + stored_password);
-    
     // Проверяем форматы
     if (salt.length() != 16) {
         logger.log("err: Salt must be 16 hex chars");
@@ -255,323 +482,319 @@ bool Session::verify_authentication(const std::string& login,
         }
     }
     
-    // ВЫЧИСЛЯЕМ MD5(СОЛЬ + ПАРОЛЬ)
-    std::string salt_plus_password = salt + stored_password;
-    std::string expected_hash = calculate_md5(salt_plus_password);
-    
-    logger.log("String for MD5 (salt+password): '" + salt_plus_password + "'");
-    
-    // Приводим к нижнему регистру
-    std::string received_lower = received_hash;
-    std::transform(received_lower.begin(), received_lower.end(), received_lower.begin(), ::tolower);
-    
-    std::string expected_lower = expected_hash;
-    std::transform(expected_lower.begin(), expected_lower.end(), expected_lower.begin(), ::tolower);
+    // Соль, выбранная клиентом, в режиме вызов-ответ не принимается
+    if (!issued_salt.empty()) {
+        for (size_t i = 0; i < salt.size(); i++) {
+            if (toupper(static_cast<unsigned char>(salt[i])) != issued_salt[i]) {
+                logger.log("err: Salt does not match the issued challenge " + issued_salt);
+                return false;
+            }
+        }
+    }
     
-    logger.log("Expected MD5: " + expected_lower);
-    logger.log("Received MD5: " + received_lower);
+    return true;
+}
+
+/**
+ * @brief Проверка аутентификации клиента
+ * 
+ * @param login Логин клиента
+ * @param salt Соль (16 hex символов)
+ * @param received_hash Хэш от клиента (32 hex символа)
+ * @return bool true если аутентификация успешна
+ * 
+ * @details
+ * После find_password() сравнивает MD5(salt + stored_password) с
+ * полученным хэшем без учета регистра: hex-запись клиента сравнивается
+ * прямо с байтами дайджеста. Соль и пароль не склеиваются, а ожидаемый
+ * хэш не форматируется: путь проверки не выделяет память.
+ */
+bool Session::verify_authentication(const std::string& login, 
+                                   const std::string& salt, 
+                                   const std::string& received_hash) {
+    CredentialTable::View password;
+    if (!find_password(login, salt, received_hash, password)) {
+        return false;
+    }
     
-    // Сравниваем
-    bool success = (received_lower == expected_lower);
+    // ВЫЧИСЛЯЕМ MD5(СОЛЬ + ПАРОЛЬ)
+    unsigned char digest[Authenticator::kDigestLength];
+    Authenticator::md5_digest(salt, password.data, password.size, digest);
     
-    if (success) {
-        logger.log("SUCCESS: Authentication passed");
-    } else {
-        logger.log("err: Authentication failed - hash mismatch");
-        logger.log("Check: 1) Password in /etc/vealc.conf is 'P@ssl@rd'");
-        logger.log("       2) MD5 calculation uses 'salt + password' order");
+    // Сравниваем без учета регистра
+    return Authenticator::digest_matches(digest, received_hash);
+}
+
+/**
+ * @brief Отправка клиенту итога проверки
+ * 
+ * @param success Результат сравнения хэшей
+ * 
+ * @details
+ * Отправляет "OK\n" или, при отказе, "err\n" и завершает разбор протокола.
+ * В лог пишется только логин и итог.
+ */
+void Session::complete_auth(bool success) {
+    if (!success) {
+        logger.log("err: Authentication failed for '" + parser.login() + "'");
+        send_text("err\n");
+        parser.finish();
+        return;
     }
     
-    return success;
+    logger.log("Authentication OK for '" + parser.login() + "'");
+    send_text("OK\n");
 }
 
 /**
- * @brief Прием 32-битного беззнакового числа
+ * @brief Постановка 32-битного знакового числа в очередь отправки
  * 
- * @return uint32_t Принятое число
+ * @param value Число для отправки
  * 
- * @note Данные ожидаются в сетевом порядке байт (big-endian)
- * @note Не использует ntohl() - предполагается что данные уже в правильном порядке
+ * @details
+ * Результаты копятся в send_buffer и уходят клиенту одним send(), когда
+ * закончатся принятые данные (см. handle() и on_event()). Интерактивный
+ * клиент, ждущий каждый результат, получает его сразу: после его вектора
+ * входных данных больше нет. Если клиент присылает много векторов подряд,
+ * буфер сбрасывается с MSG_MORE по достижении kFlushThreshold.
  */
-uint32_t Session::receive_uint32() {
-    std::string data = extract_from_buffer_exact(4);
-    uint32_t value;
-    memcpy(&value, data.c_str(), 4);
-    return value; // Не используем ntohl - данные уже в правильном порядке
+void Session::send_int32(int32_t value) {
+    send_result(reinterpret_cast<const char*>(&value), 4);
 }
 
 /**
- * @brief Прием вектора целых чисел
+ * @brief Постановка результата в очередь отправки
  * 
- * @param size Количество элементов в векторе
- * @return std::vector<int32_t> Принятый вектор
+ * @param data Результат в машинном представлении
+ * @param length Размер результата (4 или 8 байт по типу элементов,
+ *        для точного произведения - длина закодированного числа)
+ */
+void Session::send_result(const char* data, size_t length) {
+    send_buffer.append(data, length);
+    if (send_buffer.size() >= kFlushThreshold && !flush_send_buffer(true)) {
+        throw std::runtime_error("Send error");
+    }
+}
+
+/**
+ * @brief Проверка учетных данных, найденных разбором протокола
  * 
- * @note Каждый элемент - 4 байта в сетевом порядке байт
+ * @details
+ * Проверяет разобранные логин, соль и хэш и отправляет клиенту "OK\n"
+ * или "err\n". При отказе разбор протокола завершается.
+ * С пакетной проверкой MD5 ставится в AuthBatcher, а разбор
+ * приостанавливается до on_auth_verified().
  */
-std::vector<int32_t> Session::receive_vector(uint32_t size) {
-    std::vector<int32_t> result(size);
-    if (size == 0) return result;
+void Session::process_auth() {
+    const std::string& login = parser.login();
+    const std::string& client_salt = parser.salt();
+    const std::string& client_hash = parser.hash();
     
-    std::string data = extract_from_buffer_exact(size * 4);
+    // Проверяем что логин не пустой
+    if (login.empty()) {
+        logger.log("err: Empty login");
+        send_text("err\n");
+        parser.finish();
+        return;
+    }
     
-    for (uint32_t i = 0; i < size; i++) {
-        uint32_t temp;
-        memcpy(&temp, data.c_str() + i * 4, 4);
-        result[i] = static_cast<int32_t>(temp); // Не используем ntohl
+    // Проверку MD5 можно отложить до пакета из нескольких сессий
+    if (auth_batcher != nullptr) {
+        CredentialTable::View password;
+        if (!find_password(login, client_salt, client_hash, password)) {
+            complete_auth(false);
+            return;
+        }
+        auth_batcher->submit(client_socket, client_salt, password.data, password.size, client_hash);
+        auth_pending = true;
+        return;
     }
     
-    return result;
+    complete_auth(verify_authentication(login, client_salt, client_hash));
 }
 
 /**
- * @brief Отправка 32-битного беззнакового числа
+ * @brief Свертка порции элементов потокового вектора
  * 
- * @param value Число для отправки
- * 
- * @note Отправляет в сетевом порядке байт
- * @note Не использует htonl() - предполагается что данные уже в правильном порядке
+ * Добавляет элементы в операцию запроса и запоминает первые из них для лога.
+ * Как только результат известен (например, нулевое произведение или
+ * переполнение), остаток вектора отбрасывается разбором без свертки.
  */
-void Session::send_uint32(uint32_t value) {
-    send_text(std::string(reinterpret_cast<char*>(&value), 4));
+void Session::process_elements() {
+    const char* data = parser.elements();
+    size_t count = parser.element_count();
+    
+    for (size_t i = 0; reduction.type() == ElementType::Int32 && sample.size() < 5 && i < count; i++) {
+        int32_t value;
+        memcpy(&value, data + i * 4, 4);
+        sample.push_back(value);
+    }
+    reduction.add(data, count);
+    
+    if (reduction.decided()) {
+        logger.log(std::string("Result (") + reduction.kernel().name + ") decided, skipping the rest of the vector");
+        parser.skip_vector();
+    }
 }
 
 /**
- * @brief Отправка 32-битного знакового числа
+ * @brief Вычисление и отправка результата для принятого вектора
  * 
- * @param value Число для отправки
+ * @details
+ * Для потокового вектора результат операции запроса уже накоплен в
+ * reduction (он имеет тип элементов запроса), иначе произведение
+ * вычисляется по материализованному вектору int32.
  */
-void Session::send_int32(int32_t value) {
-    send_text(std::string(reinterpret_cast<char*>(&value), 4));
+void Session::process_vector() {
+    const std::vector<int32_t>& vector_data = parser.streaming() ? sample : parser.vector();
+    size_t vector_length = parser.vector_size();
+    
+    // Логируем значения
+    if (!vector_data.empty()) {
+        std::string values = "Values: ";
+        for (size_t j = 0; j < std::min((size_t)5, vector_data.size()); j++) {
+            values += std::to_string(vector_data[j]) + " ";
+        }
+        if (vector_length > 5) values += "...";
+        logger.log(values);
+    }
+    
+    // Отправляем результат
+    if (parser.streaming()) {
+        std::string result;
+        reduction.result(result);
+        if (reduction.kernel().operation == Operation::Product) {
+            logger.log("Product: " + reduction.result_string());
+        } else {
+            logger.log(std::string("Result (") + reduction.kernel().name + "): " + reduction.result_string());
+        }
+        send_result(result.data(), result.size());
+    } else {
+        int32_t product = cached_product(vector_data);
+        logger.log("Product: " + std::to_string(product));
+        send_int32(product);
+    }
+    logger.log("Result queued");
+}
+
+/**
+ * @brief Логирование завершения обработки векторов
+ */
+void Session::finish_vectors() {
+    logger.log("=== SESSION COMPLETED ===");
+    logger.log("Total vectors processed: " + std::to_string(parser.vector_count()));
+    if (cache != nullptr) {
+        ResultCache::Stats stats = cache->stats();
+        logger.log("Result cache: " + std::to_string(stats.hits) + " hits, " + std::to_string(stats.misses) +
+                   " misses, " + std::to_string(stats.evictions) + " evictions, " +
+                   std::to_string(stats.entries) + " entries");
+    }
 }
 
 /**
- * @brief Извлечение hex символов из буфера до не-hex символа
+ * @brief Произведение материализованного вектора через кэш результатов
  * 
- * @return std::string Извлеченная последовательность hex символов
+ * @param vector_data Элементы вектора
+ * @return int32_t Произведение
  * 
- * @note Используется для извлечения соли и хэша из потока данных
+ * @details
+ * Ключ вычислен разбором по мере приема элементов (vector_key()), поэтому
+ * попадание не делает отдельного прохода по вектору. Потоковые векторы
+ * кэш не проходят: они сворачиваются по мере приема, и к моменту, когда
+ * известен хэш, произведение уже вычислено.
  */
-std::string Session::extract_from_buffer_until_non_hex() {
-    size_t i = 0;
-    while (i < receive_buffer.size()) {
-        char c = receive_buffer[i];
-        if (!((c >= '0' && c <= '9') || 
-              (c >= 'A' && c <= 'F') || 
-              (c >= 'a' && c <= 'f'))) {
-            break;
-        }
-        i++;
+int32_t Session::cached_product(const std::vector<int32_t>& vector_data) {
+    ResultCache::Key key;
+    if (cache == nullptr || !parser.vector_key(key)) {
+        return VectorProcessor::calculate_product(vector_data);
     }
     
-    if (i == 0) {
-        return "";
+    int32_t product;
+    if (cache->find(key, product)) {
+        logger.log("Result cache hit");
+        return product;
     }
-    
-    std::string result = receive_buffer.substr(0, i);
-    receive_buffer.erase(0, i);
-    return result;
+    product = VectorProcessor::calculate_product(vector_data);
+    cache->insert(key, product);
+    return product;
 }
 
 /**
- * @brief Основная логика обработки векторов
+ * @brief Продвижение разбора протокола
  * 
- * Выполняет полный цикл обработки:
- * 1. Поиск и парсинг аутентификационных данных (48 hex символов)
- * 2. Проверка аутентификации
- * 3. Прием количества векторов
- * 4. Обработка каждого вектора
- * 5. Отправка результатов
+ * Забирает у ProtocolParser все события, для которых уже хватает данных:
+ * 1. Credentials - проверка аутентификационных данных (48 hex символов)
+ * 2. VectorCount - количество векторов
+ * 3. VectorSize / Vector - вычисление и отправка результата для каждого вектора;
+ *    элементы длинных векторов сворачиваются потоково (Elements)
  * 
  * @details
  * Формат входных данных:
  * [логин][16 hex соль][32 hex хэш][количество_векторов][вектор1]...[векторN]
+ * Перед количеством может стоять расширенный заголовок с типом элементов
+ * (int32, int64, float, double) и операцией (произведение, сумма, минимум,
+ * максимум, L1, L2, скалярное произведение пар); результат каждого вектора
+ * имеет тип элементов.
  * 
- * @throw std::exception при ошибках парсинга или сетевого взаимодействия
+ * @throw std::exception при ошибках выделения памяти под вектор
  */
-void Session::process_vectors() {
-    logger.log("=== NEW CLIENT CONNECTION ===");
-    
-    try {
-        // 1. Получаем данные
-        receive_to_buffer();
-        
-        // Логируем сырые данные для отладки
-        logger.log("Raw buffer (first 100 chars): " + 
-                   receive_buffer.substr(0, std::min((size_t)100, receive_buffer.size())));
-        
-        // 2. Ищем 48 HEX СИМВОЛОВ ПОДРЯД (соль+хэш)
-        // Соль (16 hex) + хэш (32 hex) = 48 hex символов
-        
-        size_t hex_start = 0;
-        bool found = false;
-        
-        // Ищем в первых 100 символах (логин обычно короткий)
-        size_t search_limit = std::min((size_t)100, receive_buffer.size());
-        
-        for (size_t i = 0; i < search_limit && !found; i++) {
-            size_t hex_count = 0;
-            size_t j = i;
-            
-            // Считаем сколько hex символов подряд начиная с позиции i
-            while (j < receive_buffer.size() && hex_count < 48) {
-                char c = receive_buffer[j];
-                if ((c >= '0' && c <= '9') || 
-                    (c >= 'A' && c <= 'F') || 
-                    (c >= 'a' && c <= 'f')) {
-                    hex_count++;
-                    j++;
-                } else {
-                    break;
-                }
-            }
-            
-            // Если нашли 48 hex символов подряд
-            if (hex_count == 48) {
-                hex_start = i;
-                found = true;
-                logger.log("Found 48 hex chars starting at position: " + std::to_string(hex_start));
-                break;
-            }
+void Session::process_input() {
+    while (!parser.finished() && !auth_pending && !output_blocked()) {
+        if (parser.stage() == ProtocolParser::Stage::Auth && parser.scanned() == 0) {
+            // Логируем сырые данные для отладки
+            logger.log("Raw buffer (first 100 chars): " + parser.preview(100));
         }
         
-        if (!found) {
-            // Получаем больше данных и пробуем снова
-            receive_to_buffer();
-            search_limit = std::min((size_t)150, receive_buffer.size());
+        switch (parser.next()) {
+        case ProtocolParser::Event::NeedMore:
+            return;
             
-            for (size_t i = 0; i < search_limit && !found; i++) {
-                size_t hex_count = 0;
-                size_t j = i;
-                
-                while (j < receive_buffer.size() && hex_count < 48) {
-                    char c = receive_buffer[j];
-                    if ((c >= '0' && c <= '9') || 
-                        (c >= 'A' && c <= 'F') || 
-                        (c >= 'a' && c <= 'f')) {
-                        hex_count++;
-                        j++;
-                    } else {
-                        break;
-                    }
-                }
-                
-                if (hex_count == 48) {
-                    hex_start = i;
-                    found = true;
-                    logger.log("Found 48 hex chars (2nd attempt) at position: " + std::to_string(hex_start));
-                    break;
-                }
-            }
-        }
-        
-        if (!found) {
+        case ProtocolParser::Event::Credentials:
+            process_auth();
+            break;
+            
+        case ProtocolParser::Event::BadCredentials:
             logger.log("err: Cannot find 48 hex characters (salt+hash)");
-            logger.log("Buffer size: " + std::to_string(receive_buffer.size()));
+            logger.log("Buffer size: " + std::to_string(parser.buffered()));
             send_text("err\n");
-            return;
-        }
-        
-        // 3. Извлекаем части
-        // Все что до hex_start - это логин
-        std::string login = receive_buffer.substr(0, hex_start);
-        
-        // Следующие 16 символов - соль
-        std::string client_salt = receive_buffer.substr(hex_start, 16);
-        
-        // Следующие 32 символа - хэш
-        std::string client_hash = receive_buffer.substr(hex_start + 16, 32);
-        
-        // Удаляем обработанные данные
-        receive_buffer.erase(0, hex_start + 48);
-        
-        logger.log("=== PARSED CREDENTIALS ===");
-        logger.log("Login: '" + login + "' (length: " + std::to_string(login.length()) + ")");
-        logger.log("Salt: " + client_salt);
-        logger.log("Hash: " + client_hash);
-        
-        // 4. Проверяем что логин не пустой
-        if (login.empty()) {
-            logger.log("err: Empty login");
-            send_text("err\n");
-            return;
-        }
-        
-        // 5. Проверяем что соль и хэш действительно hex
-        bool salt_valid = true;
-        bool hash_valid = true;
-        
-        for (char c : client_salt) {
-            if (!isxdigit(c)) {
-                salt_valid = false;
-                logger.log("err: Salt contains non-hex char: " + std::string(1, c));
-                break;
-            }
-        }
-        
-        for (char c : client_hash) {
-            if (!isxdigit(c)) {
-                hash_valid = false;
-                logger.log("err: Hash contains non-hex char: " + std::string(1, c));
-                break;
+            break;
+            
+        case ProtocolParser::Event::BadHeader:
+            if (parser.vector_count() > 0) {
+                logger.log("err: Vector size " + std::to_string(parser.vector_size()) +
+                           " is not valid for the requested operation");
+            } else {
+                logger.log("err: Unknown element type or operation in extended header");
             }
-        }
-        
-        if (!salt_valid || !hash_valid) {
-            logger.log("err: Invalid salt or hash format");
-            send_text("err\n");
-            return;
-        }
-        
-        // 6. Проверяем аутентификацию
-        if (!verify_authentication(login, client_salt, client_hash)) {
-            logger.log("err: Authentication failed");
             send_text("err\n");
-            return;
-        }
-        
-        // 7. Отправляем подтверждение
-        logger.log("SUCCESS: Authentication OK, sending OK to client");
-        send_text("OK\n");
-        
-        // 8. Получаем количество векторов
-        uint32_t vector_count = receive_uint32();
-        logger.log("Vector count: " + std::to_string(vector_count));
-        
-        // 9. Обрабатываем векторы
-        for (uint32_t i = 0; i < vector_count; i++) {
-            logger.log("--- Processing Vector " + std::to_string(i + 1) + " ---");
-            
-            // Размер вектора
-            uint32_t vector_size = receive_uint32();
-            logger.log("Vector size: " + std::to_string(vector_size));
+            break;
             
-            // Данные вектора
-            std::vector<int32_t> vector_data = receive_vector(vector_size);
+        case ProtocolParser::Event::VectorCount:
+            logger.log("Vector count: " + std::to_string(parser.vector_count()));
+            if (parser.finished()) {
+                finish_vectors();
+            }
+            break;
             
-            // Логируем значения
-            if (!vector_data.empty()) {
-                std::string values = "Values: ";
-                for (size_t j = 0; j < std::min((size_t)5, vector_data.size()); j++) {
-                    values += std::to_string(vector_data[j]) + " ";
-                }
-                if (vector_data.size() > 5) values += "...";
-                logger.log(values);
+        case ProtocolParser::Event::VectorSize:
+            logger.log("--- Processing Vector " + std::to_string(parser.vectors_parsed() + 1) + " ---");
+            logger.log("Vector size: " + std::to_string(parser.vector_size()));
+            if (parser.streaming()) {
+                reduction.reset(parser.operation(), parser.element_type());
+                sample.clear();
             }
+            break;
             
-            // Вычисляем произведение
-            int32_t product = calculate_vector_product(vector_data);
-            logger.log("Product: " + std::to_string(product));
+        case ProtocolParser::Event::Elements:
+            process_elements();
+            break;
             
-            // Отправляем результат
-            send_int32(product);
-            logger.log("Result sent");
+        case ProtocolParser::Event::Vector:
+            process_vector();
+            if (parser.finished()) {
+                finish_vectors();
+            }
+            break;
         }
-        
-        logger.log("=== SESSION COMPLETED ===");
-        logger.log("Total vectors processed: " + std::to_string(vector_count));
-        
-    } catch (const std::exception& e) {
-        logger.log("err: " + std::string(e.what()));
-        send_text("err\n");
     }
 }
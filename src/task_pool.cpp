@@ -0,0 +1,177 @@
+/**
+ * @file task_pool.cpp
+ * @brief Реализация пула потоков с перехватом задач
+ *
+ * @see task_pool.h
+ */
+
+#include "../include/task_pool.h"
+
+/**
+ * @brief Пакет задач одного вызова run()
+ *
+ * @details
+ * Счетчик уменьшается под мьютексом: вызывающий run() выходит, только
+ * увидев 0 под тем же мьютексом, поэтому исполнитель последней задачи
+ * успевает уведомить его до того, как пакет будет уничтожен.
+ */
+struct TaskPool::Batch {
+    size_t remaining;                ///< Незавершенные задачи
+    std::mutex mutex;                ///< Защищает remaining
+    std::condition_variable done;    ///< Сигнал завершения всех задач
+};
+
+/**
+ * @brief Конструктор
+ *
+ * @param threads Количество потоков пула
+ */
+TaskPool::TaskPool(size_t threads) : pending_(0), next_queue_(0), stop_(false) {
+    for (size_t i = 0; i < threads; i++) {
+        queues_.push_back(std::unique_ptr<Queue>(new Queue()));
+    }
+    for (size_t i = 0; i < threads; i++) {
+        threads_.push_back(std::thread([this, i]() { worker_loop(i); }));
+    }
+}
+
+/**
+ * @brief Деструктор
+ */
+TaskPool::~TaskPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+/**
+ * @brief Выполнение пакета задач
+ *
+ * @param tasks Задачи
+ */
+void TaskPool::run(const std::vector<std::function<void()>>& tasks) {
+    if (tasks.empty()) {
+        return;
+    }
+    if (threads_.empty()) {
+        for (const auto& task : tasks) {
+            task();
+        }
+        return;
+    }
+
+    Batch batch;
+    batch.remaining = tasks.size();
+
+    // Счетчик увеличивается до раздачи, поэтому никогда не уходит в минус
+    pending_ += tasks.size();
+    size_t home = next_queue_.fetch_add(tasks.size());
+    for (size_t i = 0; i < tasks.size(); i++) {
+        Queue& queue = *queues_[(home + i) % queues_.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(Task{&tasks[i], &batch});
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    wake_.notify_all();
+
+    // Пока пакет не завершен, помогаем выполнять задачи
+    home %= queues_.size();
+    for (;;) {
+        Task task;
+        if (take(home, task)) {
+            execute(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(batch.mutex);
+        batch.done.wait(lock, [&batch]() { return batch.remaining == 0; });
+        break;
+    }
+}
+
+/**
+ * @brief Извлечение задачи
+ *
+ * @param home Своя очередь
+ * @param task Сюда записывается задача
+ * @return bool false если все очереди пусты
+ *
+ * @details
+ * Своя очередь - с конца (последние розданные задачи еще в кэше),
+ * чужие - с начала, чтобы перехват меньше мешал их владельцам.
+ */
+bool TaskPool::take(size_t home, Task& task) {
+    if (pending_ == 0) {
+        return false;
+    }
+    size_t count = queues_.size();
+    for (size_t k = 0; k < count; k++) {
+        Queue& queue = *queues_[(home + k) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        if (k == 0) {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+        } else {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+        }
+        pending_--;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Выполнение задачи
+ *
+ * @param task Задача
+ */
+void TaskPool::execute(const Task& task) {
+    (*task.body)();
+
+    Batch* batch = task.batch;
+    std::lock_guard<std::mutex> lock(batch->mutex);
+    if (--batch->remaining == 0) {
+        batch->done.notify_all();
+    }
+}
+
+/**
+ * @brief Цикл потока пула
+ *
+ * @param index Номер своей очереди
+ */
+void TaskPool::worker_loop(size_t index) {
+    for (;;) {
+        Task task;
+        if (take(index, task)) {
+            execute(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wake_.wait(lock, [this]() { return stop_ || pending_ > 0; });
+        if (stop_) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Общий пул процесса
+ *
+ * @return TaskPool& Пул
+ */
+TaskPool& TaskPool::shared() {
+    static TaskPool pool(std::thread::hardware_concurrency() > 1
+                             ? std::thread::hardware_concurrency() - 1 : 0);
+    return pool;
+}
@@ -0,0 +1,667 @@
+/**
+ * @file uring_loop.cpp
+ * @brief Реализация транспорта на основе io_uring
+ *
+ * Содержит:
+ * - минимальную обертку над кольцами io_uring (setup/mmap/enter)
+ * - проверку поддержки нужных операций ядром
+ * - цикл обработки завершений: accept, чтение, отправка, закрытие
+ *
+ * @see uring_loop.h
+ */
+
+#include "../include/uring_loop.h"
+#include "../include/logger.h"
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+const unsigned kRingEntries = 4096;   ///< Размер очереди отправки
+const unsigned kFixedBuffers = 1024;  ///< Количество зарегистрированных буферов
+const size_t kBufferSize = 16384;     ///< Размер одного буфера приема
+const size_t kOutputHighWater = 256 * 1024; ///< Неотправленный вывод, при котором чтение приостанавливается
+
+/**
+ * @brief Тип операции, кодируется в младших битах user_data
+ */
+enum Op : uint64_t {
+    OP_ACCEPT = 1,
+    OP_RECV = 2,
+    OP_SEND = 3,
+    OP_CLOSE = 4
+};
+
+uint64_t make_tag(uint32_t id, Op op) {
+    return (static_cast<uint64_t>(id) << 3) | op;
+}
+
+} // namespace
+
+/**
+ * @brief Кольца io_uring, созданные напрямую системными вызовами
+ */
+struct UringLoop::Ring {
+    int fd;                          ///< Дескриптор io_uring
+    unsigned* sq_head;               ///< Голова очереди отправки (ядро)
+    unsigned* sq_tail;               ///< Хвост очереди отправки (мы)
+    unsigned sq_mask;                ///< Маска индексов очереди отправки
+    unsigned sq_entries;             ///< Размер очереди отправки
+    unsigned* sq_array;              ///< Массив индексов SQE
+    struct io_uring_sqe* sqes;       ///< Массив SQE
+    unsigned* cq_head;               ///< Голова очереди завершений (мы)
+    unsigned* cq_tail;               ///< Хвост очереди завершений (ядро)
+    unsigned cq_mask;                ///< Маска индексов очереди завершений
+    struct io_uring_cqe* cqes;       ///< Массив CQE
+    void* sq_ptr;                    ///< Отображение кольца отправки
+    size_t sq_len;                   ///< Размер отображения кольца отправки
+    void* cq_ptr;                    ///< Отображение кольца завершений
+    size_t cq_len;                   ///< Размер отображения кольца завершений
+    size_t sqes_len;                 ///< Размер отображения массива SQE
+    unsigned local_tail;             ///< Хвост с еще не опубликованными SQE
+    unsigned submitted;              ///< Сколько SQE уже передано ядру
+
+    /**
+     * @brief Создает кольца заданного размера
+     *
+     * @param entries Размер очереди отправки
+     * @throw std::runtime_error при ошибке io_uring_setup() или mmap()
+     */
+    explicit Ring(unsigned entries)
+        : fd(-1), sqes(static_cast<struct io_uring_sqe*>(MAP_FAILED)),
+          sq_ptr(MAP_FAILED), sq_len(0), cq_ptr(MAP_FAILED), cq_len(0), sqes_len(0),
+          local_tail(0), submitted(0) {
+        struct io_uring_params params;
+        memset(&params, 0, sizeof(params));
+
+        fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) {
+            throw std::runtime_error("io_uring_setup failed");
+        }
+
+        sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_len = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+        bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_len = cq_len = std::max(sq_len, cq_len);
+        }
+
+        sq_ptr = mmap(nullptr, sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      fd, IORING_OFF_SQ_RING);
+        if (sq_ptr == MAP_FAILED) {
+            destroy();
+            throw std::runtime_error("io_uring mmap failed");
+        }
+        if (single_mmap) {
+            cq_ptr = sq_ptr;
+        } else {
+            cq_ptr = mmap(nullptr, cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          fd, IORING_OFF_CQ_RING);
+            if (cq_ptr == MAP_FAILED) {
+                destroy();
+                throw std::runtime_error("io_uring mmap failed");
+            }
+        }
+
+        sqes_len = params.sq_entries * sizeof(struct io_uring_sqe);
+        sqes = static_cast<struct io_uring_sqe*>(
+            mmap(nullptr, sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                 fd, IORING_OFF_SQES));
+        if (sqes == MAP_FAILED) {
+            destroy();
+            throw std::runtime_error("io_uring mmap failed");
+        }
+
+        char* sq = static_cast<char*>(sq_ptr);
+        sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_entries = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_entries);
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+        char* cq = static_cast<char*>(cq_ptr);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        local_tail = submitted = *sq_tail;
+    }
+
+    ~Ring() {
+        destroy();
+    }
+
+    /**
+     * @brief Освобождает отображения и закрывает дескриптор
+     */
+    void destroy() {
+        if (sqes != MAP_FAILED) {
+            munmap(sqes, sqes_len);
+        }
+        if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) {
+            munmap(cq_ptr, cq_len);
+        }
+        if (sq_ptr != MAP_FAILED) {
+            munmap(sq_ptr, sq_len);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    /**
+     * @brief Гарантирует count свободных SQE, при нехватке сначала отправляет очередь
+     *
+     * @note Связанные SQE (IOSQE_IO_LINK) резервируются заранее: отправка
+     *       очереди между ними разорвала бы цепочку
+     */
+    void reserve(unsigned count) {
+        unsigned head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+        if (local_tail - head > sq_entries - count) {
+            submit_and_wait(0);
+        }
+    }
+
+    /**
+     * @brief Возвращает обнуленный SQE, при заполненной очереди сначала отправляет ее
+     */
+    struct io_uring_sqe* get_sqe() {
+        reserve(1);
+
+        unsigned index = local_tail & sq_mask;
+        struct io_uring_sqe* sqe = &sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sq_array[index] = index;
+        local_tail++;
+        return sqe;
+    }
+
+    /**
+     * @brief Публикует подготовленные SQE и ждет не менее wait_nr завершений
+     *
+     * @throw std::runtime_error при ошибке io_uring_enter()
+     */
+    void submit_and_wait(unsigned wait_nr) {
+        __atomic_store_n(sq_tail, local_tail, __ATOMIC_RELEASE);
+
+        while (true) {
+            unsigned to_submit = local_tail - submitted;
+            unsigned flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+            long ret = syscall(__NR_io_uring_enter, fd, to_submit, wait_nr, flags, nullptr, 0);
+            if (ret < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error("io_uring_enter failed");
+            }
+            submitted += static_cast<unsigned>(ret);
+            return;
+        }
+    }
+};
+
+/**
+ * @brief Состояние одного подключения
+ */
+struct UringLoop::Connection {
+    uint32_t id;                     ///< Индекс в connections_ (кодируется в user_data)
+    int fd;                          ///< Сокет клиента
+    std::unique_ptr<Session> session; ///< Сессия во внешнем режиме ввода-вывода
+    int buffer_index;                ///< Зарегистрированный буфер (-1 - heap_buffer)
+    std::vector<char> heap_buffer;   ///< Буфер приема, если зарегистрированные закончились
+    std::string pending;             ///< Вывод сессии, еще не переданный ядру
+    std::string sending;             ///< Вывод, отправка которого выполняется
+    size_t sent;                     ///< Сколько байт sending уже отправлено
+    int inflight;                    ///< Незавершенные операции в кольце
+    bool closing;                    ///< Закрытие поставлено в очередь
+    bool broken;                     ///< Отправка завершилась ошибкой
+    bool recv_paused;                ///< Чтение приостановлено до отправки вывода
+
+    /**
+     * @brief Вывод, еще не принятый ядром
+     */
+    size_t unsent() const {
+        return pending.size() + sending.size() - sent;
+    }
+};
+
+/**
+ * @brief Создает кольца и регистрирует буферы
+ *
+ * @param clients База данных клиентов
+ * @param logger Логгер
+ * @param cache Кэш результатов или nullptr
+ * @param issue_salt Выдавать клиентам соль
+ */
+UringLoop::UringLoop(const CredentialTable& clients, Logger& logger,
+                     ResultCache* cache, bool issue_salt)
+    : clients_(clients), logger_(logger), cache_(cache), issue_salt_(issue_salt), ring_(new Ring(kRingEntries)),
+      listen_fd_(-1), multishot_accept_(true), fixed_buffers_(nullptr) {
+    size_t total = kFixedBuffers * kBufferSize;
+    void* memory = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        logger_.log_error("Cannot allocate io_uring buffers, using plain recv", false);
+        return;
+    }
+
+    std::vector<struct iovec> iovecs(kFixedBuffers);
+    for (unsigned i = 0; i < kFixedBuffers; i++) {
+        iovecs[i].iov_base = static_cast<char*>(memory) + i * kBufferSize;
+        iovecs[i].iov_len = kBufferSize;
+    }
+    if (syscall(__NR_io_uring_register, ring_->fd, IORING_REGISTER_BUFFERS,
+                iovecs.data(), kFixedBuffers) < 0) {
+        logger_.log_error("Cannot register io_uring buffers, using plain recv", false);
+        munmap(memory, total);
+        return;
+    }
+
+    fixed_buffers_ = static_cast<char*>(memory);
+    for (unsigned i = kFixedBuffers; i > 0; i--) {
+        free_buffers_.push_back(static_cast<int>(i - 1));
+    }
+}
+
+/**
+ * @brief Закрывает оставшиеся подключения и освобождает ресурсы
+ */
+UringLoop::~UringLoop() {
+    for (size_t i = 0; i < connections_.size(); i++) {
+        if (connections_[i] && connections_[i]->fd >= 0) {
+            close(connections_[i]->fd);
+        }
+    }
+    ring_.reset();
+    if (fixed_buffers_) {
+        munmap(fixed_buffers_, kFixedBuffers * kBufferSize);
+    }
+}
+
+/**
+ * @brief Проверяет поддержку io_uring
+ *
+ * @return bool true если кольцо создается и ядро поддерживает нужные операции
+ */
+bool UringLoop::supported() {
+    try {
+        Ring ring(8);
+
+        const unsigned ops = 256;
+        size_t size = sizeof(struct io_uring_probe) + ops * sizeof(struct io_uring_probe_op);
+        struct io_uring_probe* probe = static_cast<struct io_uring_probe*>(calloc(1, size));
+        if (!probe) {
+            return false;
+        }
+
+        bool ok = syscall(__NR_io_uring_register, ring.fd, IORING_REGISTER_PROBE, probe, ops) >= 0;
+        const int required[] = {IORING_OP_ACCEPT, IORING_OP_READ_FIXED, IORING_OP_RECV,
+                                IORING_OP_SEND, IORING_OP_CLOSE};
+        for (size_t i = 0; ok && i < sizeof(required) / sizeof(required[0]); i++) {
+            ok = required[i] <= probe->last_op &&
+                 (probe->ops[required[i]].flags & IO_URING_OP_SUPPORTED);
+        }
+
+        free(probe);
+        return ok;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+/**
+ * @brief Цикл обработки завершений
+ *
+ * @param listen_fd Слушающий сокет
+ *
+ * @details
+ * 1. Ставит в очередь accept на слушающем сокете
+ * 2. Отправляет накопленные SQE и ждет хотя бы одно завершение
+ * 3. Разбирает все готовые CQE по типу операции из user_data
+ *
+ * @note Слушающий сокет переводится в блокирующий режим: ожиданием
+ *       готовности занимается io_uring
+ */
+void UringLoop::run(int listen_fd) {
+    listen_fd_ = listen_fd;
+    int flags = fcntl(listen_fd_, F_GETFL, 0);
+    if (flags >= 0) {
+        fcntl(listen_fd_, F_SETFL, flags & ~O_NONBLOCK);
+    }
+
+    submit_accept();
+
+    while (true) {
+        ring_->submit_and_wait(1);
+
+        unsigned head = *ring_->cq_head;
+        unsigned tail = __atomic_load_n(ring_->cq_tail, __ATOMIC_ACQUIRE);
+
+        while (head != tail) {
+            struct io_uring_cqe cqe = ring_->cqes[head & ring_->cq_mask];
+            head++;
+            __atomic_store_n(ring_->cq_head, head, __ATOMIC_RELEASE);
+
+            uint64_t op = cqe.user_data & 7;
+            uint32_t id = static_cast<uint32_t>(cqe.user_data >> 3);
+
+            if (op == OP_ACCEPT) {
+                on_accept(cqe.res, cqe.flags);
+                continue;
+            }
+            if (id >= connections_.size() || !connections_[id]) {
+                continue;
+            }
+
+            Connection& conn = *connections_[id];
+            if (op == OP_RECV) {
+                on_recv(conn, cqe.res);
+            } else if (op == OP_SEND) {
+                on_send(conn, cqe.res);
+            } else if (op == OP_CLOSE) {
+                on_close(conn, cqe.res);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Ставит в очередь accept (многоразовый, если поддерживается)
+ */
+void UringLoop::submit_accept() {
+    struct io_uring_sqe* sqe = ring_->get_sqe();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listen_fd_;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    if (multishot_accept_) {
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    }
+    sqe->user_data = make_tag(0, OP_ACCEPT);
+}
+
+/**
+ * @brief Ставит в очередь чтение в буфер подключения
+ *
+ * @param conn Подключение
+ *
+ * @note Использует IORING_OP_READ_FIXED для зарегистрированных буферов
+ *       и IORING_OP_RECV для остальных
+ */
+void UringLoop::submit_recv(Connection& conn) {
+    struct io_uring_sqe* sqe = ring_->get_sqe();
+    if (conn.buffer_index >= 0) {
+        sqe->opcode = IORING_OP_READ_FIXED;
+        sqe->buf_index = static_cast<uint16_t>(conn.buffer_index);
+    } else {
+        sqe->opcode = IORING_OP_RECV;
+    }
+    sqe->fd = conn.fd;
+    sqe->addr = reinterpret_cast<uint64_t>(buffer_of(conn));
+    sqe->len = static_cast<uint32_t>(kBufferSize);
+    sqe->user_data = make_tag(conn.id, OP_RECV);
+    conn.inflight++;
+}
+
+/**
+ * @brief Отправляет накопленный вывод или закрывает завершенное подключение
+ *
+ * @param conn Подключение
+ *
+ * @details
+ * Одновременно выполняется не более одной отправки на подключение: вывод,
+ * появившийся во время отправки, копится в pending. Если сессия завершена,
+ * последняя отправка связывается (IOSQE_IO_LINK) с закрытием сокета, и оба
+ * действия уходят в ядро одной парой SQE. Оба SQE резервируются до
+ * заполнения первого: иначе отправка переполненной очереди между ними
+ * разорвала бы связь.
+ */
+void UringLoop::flush(Connection& conn) {
+    if (conn.closing || !conn.sending.empty()) {
+        return;
+    }
+    if (conn.broken) {
+        conn.pending.clear();
+    }
+
+    bool done = conn.broken || conn.session->finished();
+
+    if (!conn.pending.empty()) {
+        conn.sending.swap(conn.pending);
+        conn.sent = 0;
+
+        ring_->reserve(done ? 2 : 1);
+        struct io_uring_sqe* sqe = ring_->get_sqe();
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = conn.fd;
+        sqe->addr = reinterpret_cast<uint64_t>(conn.sending.data());
+        sqe->len = static_cast<uint32_t>(conn.sending.size());
+        sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+        sqe->user_data = make_tag(conn.id, OP_SEND);
+        conn.inflight++;
+
+        if (!done) {
+            return;
+        }
+        sqe->flags |= IOSQE_IO_LINK;
+    } else if (!done || conn.inflight > 0) {
+        return;
+    }
+
+    struct io_uring_sqe* sqe = ring_->get_sqe();
+    sqe->opcode = IORING_OP_CLOSE;
+    sqe->fd = conn.fd;
+    sqe->user_data = make_tag(conn.id, OP_CLOSE);
+    conn.inflight++;
+    conn.closing = true;
+}
+
+/**
+ * @brief Обработка завершения accept
+ *
+ * @param res Сокет клиента или -errno
+ * @param flags Флаги CQE (IORING_CQE_F_MORE - accept остается активным)
+ */
+void UringLoop::on_accept(int32_t res, uint32_t flags) {
+    bool rearm = !(flags & IORING_CQE_F_MORE);
+
+    if (res < 0) {
+        if (res == -EINVAL && multishot_accept_) {
+            multishot_accept_ = false;
+            logger_.log("Multishot accept is not supported, re-arming accept per connection");
+        } else if (res != -EINTR && res != -ECONNABORTED) {
+            logger_.log_error("Accept failed", false);
+        }
+    } else {
+        struct sockaddr_in address;
+        socklen_t addrlen = sizeof(address);
+        char client_ip[INET_ADDRSTRLEN] = "unknown";
+        if (getpeername(res, (struct sockaddr*)&address, &addrlen) == 0) {
+            inet_ntop(AF_INET, &address.sin_addr, client_ip, INET_ADDRSTRLEN);
+        }
+        logger_.log("New connection from " + std::string(client_ip));
+
+        // Сессия создается до выделения буфера и номера: ее конструктор
+        // может бросить исключение (нет случайных байт для соли)
+        std::unique_ptr<Session> session;
+        try {
+            session.reset(new Session(res, clients_, logger_, false, cache_, nullptr, issue_salt_));
+        } catch (const std::exception& e) {
+            logger_.log_error(std::string("Cannot start session: ") + e.what(), false);
+            close(res);
+        }
+
+        if (session) {
+            std::unique_ptr<Connection> conn(new Connection());
+            conn->fd = res;
+            conn->sent = 0;
+            conn->inflight = 0;
+            conn->closing = false;
+            conn->broken = false;
+            conn->recv_paused = false;
+            if (!free_buffers_.empty()) {
+                conn->buffer_index = free_buffers_.back();
+                free_buffers_.pop_back();
+            } else {
+                conn->buffer_index = -1;
+                conn->heap_buffer.resize(kBufferSize);
+            }
+
+            if (free_ids_.empty()) {
+                conn->id = static_cast<uint32_t>(connections_.size());
+                connections_.push_back(std::unique_ptr<Connection>());
+            } else {
+                conn->id = free_ids_.back();
+                free_ids_.pop_back();
+            }
+
+            conn->session = std::move(session);
+            Connection& ref = *conn;
+            connections_[ref.id] = std::move(conn);
+            submit_recv(ref);
+            // Выданная сессией соль
+            ref.session->take_output(ref.pending);
+            flush(ref);
+        }
+    }
+
+    if (rearm) {
+        submit_accept();
+    }
+}
+
+/**
+ * @brief Обработка завершения чтения
+ *
+ * @param conn Подключение
+ * @param res Количество принятых байт, 0 при закрытии клиентом или -errno
+ *
+ * @note Если клиент не читает результаты и неотправленный вывод достиг
+ *       kOutputHighWater, следующее чтение не ставится: его возобновит
+ *       on_send(), когда вывод уйдет
+ */
+void UringLoop::on_recv(Connection& conn, int32_t res) {
+    conn.inflight--;
+
+    if (res > 0) {
+        conn.session->feed(buffer_of(conn), static_cast<size_t>(res));
+    } else if (res == 0) {
+        conn.session->on_receive_closed("Connection closed by client");
+    } else {
+        conn.session->on_receive_closed("Receive error");
+    }
+    conn.session->take_output(conn.pending);
+
+    if (!conn.broken && !conn.session->finished()) {
+        if (conn.unsent() < kOutputHighWater) {
+            submit_recv(conn);
+        } else {
+            conn.recv_paused = true;
+        }
+    }
+    flush(conn);
+}
+
+/**
+ * @brief Обработка завершения отправки
+ *
+ * @param conn Подключение
+ * @param res Количество отправленных байт или -errno
+ *
+ * @note Короткая отправка дописывается отдельной SQE; связанное с ней
+ *       закрытие в этом случае отменяется ядром (-ECANCELED) и
+ *       переставляется в on_close()
+ */
+void UringLoop::on_send(Connection& conn, int32_t res) {
+    conn.inflight--;
+
+    if (res < 0) {
+        conn.broken = true;
+        conn.sending.clear();
+        conn.sent = 0;
+        flush(conn);
+        return;
+    }
+
+    conn.sent += static_cast<size_t>(res);
+    if (conn.sent < conn.sending.size()) {
+        struct io_uring_sqe* sqe = ring_->get_sqe();
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = conn.fd;
+        sqe->addr = reinterpret_cast<uint64_t>(conn.sending.data() + conn.sent);
+        sqe->len = static_cast<uint32_t>(conn.sending.size() - conn.sent);
+        sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+        sqe->user_data = make_tag(conn.id, OP_SEND);
+        conn.inflight++;
+        return;
+    }
+
+    conn.sending.clear();
+    conn.sent = 0;
+    if (conn.recv_paused && conn.unsent() < kOutputHighWater) {
+        conn.recv_paused = false;
+        if (!conn.broken && !conn.closing && !conn.session->finished()) {
+            submit_recv(conn);
+        }
+    }
+    flush(conn);
+}
+
+/**
+ * @brief Обработка завершения закрытия
+ *
+ * @param conn Подключение
+ * @param res 0 или -errno (-ECANCELED если связанная отправка была короткой)
+ */
+void UringLoop::on_close(Connection& conn, int32_t res) {
+    conn.inflight--;
+    conn.closing = false;
+
+    if (res == -ECANCELED) {
+        flush(conn);
+        return;
+    }
+
+    conn.fd = -1;
+    if (conn.inflight == 0) {
+        release(conn);
+    }
+}
+
+/**
+ * @brief Освобождает буфер и идентификатор подключения
+ *
+ * @param conn Подключение (после вызова недействительно)
+ */
+void UringLoop::release(Connection& conn) {
+    if (conn.buffer_index >= 0) {
+        free_buffers_.push_back(conn.buffer_index);
+    }
+    uint32_t id = conn.id;
+    free_ids_.push_back(id);
+    connections_[id].reset();
+}
+
+/**
+ * @brief Возвращает буфер приема подключения
+ *
+ * @param conn Подключение
+ * @return char* Зарегистрированный буфер или heap_buffer
+ */
+char* UringLoop::buffer_of(Connection& conn) {
+    if (conn.buffer_index >= 0) {
+        return fixed_buffers_ + static_cast<size_t>(conn.buffer_index) * kBufferSize;
+    }
+    return conn.heap_buffer.data();
+}
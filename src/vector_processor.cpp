@@ -1,26 +1,689 @@
 /**
  * @file vector_processor.cpp
  * @brief Реализация векторных вычислений
- * 
+ *
  * Содержит реализацию методов класса VectorProcessor:
+ * - вычислительные ядра произведения и их выбор
  * - вычисление произведения элементов вектора с контролем переполнения
- * - пакетная обработка коллекции векторов
- * 
+ * - пакетная обработка коллекции векторов (последовательная и параллельная)
+ * - потоковое вычисление произведения (ProductAccumulator)
+ * - реестр операций над векторами (ReductionKernel)
+ *
  * @see vector_processor.h
  */
 
 #include "../include/vector_processor.h"
+#include "../include/task_pool.h"
+#include <algorithm>
+#include <functional>
 #include <climits>
 #include <stdexcept>
 #include <iostream>
 #include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <new>
+#include <sstream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VECTOR_PROCESSOR_X86 1
+#endif
+
+namespace {
+
+/**
+ * @brief Один шаг эталонной свертки
+ *
+ * @param state Состояние
+ * @param value Элемент
+ * @return bool false если произошло переполнение (state.saturated установлен)
+ *
+ * @details
+ * Перед умножением проверяет 64-битное переполнение; при нем результат
+ * фиксируется как INT32_MAX или INT32_MIN по знакам сомножителей.
+ */
+inline bool fold_step(ProductState& state, int32_t value) {
+    int64_t val64 = static_cast<int64_t>(value);
+
+    if (val64 != 0 && llabs(state.product) > INT64_MAX / llabs(val64)) {
+        state.saturated = true;
+        state.saturation = ((state.product > 0 && val64 > 0) || (state.product < 0 && val64 < 0))
+                               ? INT32_MAX : INT32_MIN;
+        return false;
+    }
+    state.product *= val64;
+    return true;
+}
+
+/**
+ * @brief Результат свертки уже не зависит от оставшихся элементов
+ *
+ * @details
+ * После переполнения остальные элементы игнорируются, а нулевое
+ * произведение не меняется и переполниться не может.
+ */
+inline bool is_decided(const ProductState& state) {
+    return state.saturated || state.product == 0;
+}
+
+/**
+ * @brief Читает элемент без требований к выравниванию
+ */
+inline int32_t load_element(const char* bytes, size_t index) {
+    int32_t value;
+    memcpy(&value, bytes + index * 4, 4); // Не используем ntohl
+    return value;
+}
+
+/**
+ * @brief Эталонное ядро: по одному элементу с проверкой
+ */
+void fold_scalar(ProductState& state, const void* data, size_t count) {
+    const char* bytes = static_cast<const char*>(data);
+    for (size_t i = 0; i < count; i++) {
+        if (!fold_step(state, load_element(bytes, i)) || state.product == 0) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Битовая длина модуля произведения
+ *
+ * @param product Произведение (не INT64_MIN)
+ * @return int Количество значащих бит |product|; для нуля 1, чтобы
+ *         бюджет 63 - magnitude_bits() ограничивал и само произведение блока
+ */
+inline int magnitude_bits(int64_t product) {
+    return 64 - __builtin_clzll(static_cast<uint64_t>(llabs(product)) | 1u);
+}
+
+/**
+ * @brief Верхняя оценка прироста битовой длины от умножения на элемент
+ *
+ * @param value Элемент
+ * @return int ceil(log2 |value|): 0 для 0 и ±1, 31 для INT32_MIN
+ */
+inline int element_bits(int32_t value) {
+    uint32_t magnitude = value < 0 ? 0u - static_cast<uint32_t>(value) : static_cast<uint32_t>(value);
+    uint64_t reduced = magnitude - (magnitude != 0);
+    return 63 - __builtin_clzll((reduced << 1) | 1u); // битовая длина |value| - 1 без ветвлений
+}
+
+/**
+ * @brief Развернутое ядро: блоки по 8 элементов с битовым бюджетом
+ *
+ * @details
+ * Если |p| < 2^b, а сумма ceil(log2 |v|) по блоку равна s, то модуль любого
+ * префиксного произведения блока меньше 2^(b + s). Пока b + s <= 63,
+ * переполнение невозможно, и блок умножается без проверок (и без деления).
+ * Элементы из {-1, 0, 1} бюджет не расходуют. Блок, который может
+ * переполниться, проходит эталонными шагами, поэтому момент и знак
+ * насыщения совпадают с fold_scalar().
+ */
+void fold_unrolled(ProductState& state, const void* data, size_t count) {
+    const char* bytes = static_cast<const char*>(data);
+    int budget = 63 - magnitude_bits(state.product);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        int32_t v[8];
+        memcpy(v, bytes + i * 4, sizeof(v));
+
+        int bits = element_bits(v[0]) + element_bits(v[1]) + element_bits(v[2]) + element_bits(v[3]) +
+                   element_bits(v[4]) + element_bits(v[5]) + element_bits(v[6]) + element_bits(v[7]);
+        if (bits <= budget) {
+            // И префиксы, и произведение блока по отдельности меньше 2^63,
+            // поэтому порядок умножений можно выбрать деревом
+            int64_t low = (static_cast<int64_t>(v[0]) * v[1]) * (static_cast<int64_t>(v[2]) * v[3]);
+            int64_t high = (static_cast<int64_t>(v[4]) * v[5]) * (static_cast<int64_t>(v[6]) * v[7]);
+            state.product *= low * high;
+            if (state.product == 0) {
+                return;
+            }
+            budget -= bits;
+            continue;
+        }
+
+        fold_scalar(state, v, 8);
+        if (is_decided(state)) {
+            return;
+        }
+        budget = 63 - magnitude_bits(state.product);
+    }
+    fold_scalar(state, bytes + i * 4, count - i);
+}
+
+bool always_supported() {
+    return true;
+}
+
+#ifdef VECTOR_PROCESSOR_X86
+
+bool sse2_supported() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+}
+
+/**
+ * @brief SIMD-ядро (SSE2): блоки по 8 элементов
+ *
+ * @details
+ * Быстрый путь для блоков из {-1, 0, 1}; проверка блока выполняется
+ * векторно: v + 1 должно лежать в [0, 2] для всех элементов.
+ * Для такого блока результат определяется масками:
+ * - есть ноль -> произведение становится 0;
+ * - нечетное число -1 -> меняется знак.
+ * Остальные блоки сворачиваются fold_unrolled() по битовому бюджету.
+ */
+__attribute__((target("sse2")))
+void fold_sse2(ProductState& state, const void* data, size_t count) {
+    const char* bytes = static_cast<const char*>(data);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i two = _mm_set1_epi32(2);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i * 4));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i * 4 + 16));
+
+        __m128i ua = _mm_add_epi32(a, one);
+        __m128i ub = _mm_add_epi32(b, one);
+        __m128i bad = _mm_or_si128(_mm_or_si128(_mm_cmpgt_epi32(ua, two), _mm_cmplt_epi32(ua, zero)),
+                                   _mm_or_si128(_mm_cmpgt_epi32(ub, two), _mm_cmplt_epi32(ub, zero)));
+
+        if (_mm_movemask_epi8(bad) != 0) {
+            fold_unrolled(state, bytes + i * 4, 8);
+            if (is_decided(state)) {
+                return;
+            }
+            continue;
+        }
+
+        __m128i zeros = _mm_or_si128(_mm_cmpeq_epi32(a, zero), _mm_cmpeq_epi32(b, zero));
+        if (_mm_movemask_epi8(zeros) != 0) {
+            state.product = 0;
+            return;
+        }
+
+        int negatives = _mm_movemask_ps(_mm_castsi128_ps(a)) ^ _mm_movemask_ps(_mm_castsi128_ps(b));
+        if (__builtin_parity(negatives)) {
+            state.product = -state.product;
+        }
+    }
+    fold_scalar(state, bytes + i * 4, count - i);
+}
+
+/**
+ * @brief Переносит частичные произведения дорожек в state
+ *
+ * @param state Состояние
+ * @param lanes Модули частичных произведений
+ * @param lane_count Количество дорожек
+ * @param negative Нечетное ли число отрицательных элементов в дорожках
+ *
+ * @note Вызывающая сторона гарантирует |state.product| * (произведение дорожек) < 2^63,
+ *       поэтому умножение точное и проверки не нужны
+ */
+inline void flush_lanes(ProductState& state, const uint64_t* lanes, size_t lane_count, bool negative) {
+    uint64_t magnitude = static_cast<uint64_t>(llabs(state.product));
+    for (size_t k = 0; k < lane_count; k++) {
+        magnitude *= lanes[k];
+    }
+    bool sign = (state.product < 0) != negative;
+    state.product = sign ? -static_cast<int64_t>(magnitude) : static_cast<int64_t>(magnitude);
+}
+
+bool avx2_supported() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+/**
+ * @brief Умножает 64-битные модули на младшие 32 бита каждой дорожки x
+ *
+ * @note Точно, пока произведение меньше 2^64
+ */
+__attribute__((target("avx2")))
+inline __m256i mul_lanes_avx2(__m256i lanes, __m256i x) {
+    __m256i lo = _mm256_mul_epu32(lanes, x);
+    __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(lanes, 32), x);
+    return _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+}
+
+/**
+ * @brief Сумма верхних оценок ceil(log2 |v|) для блока из 8 модулей
+ *
+ * @details
+ * ceil(log2 |v|) - битовая длина |v| - 1 (0 для элементов 0 и ±1). Длина
+ * берется из порядка float: округление при преобразовании может только
+ * завысить ее на 1, что для оценки безопасно.
+ */
+__attribute__((target("avx2")))
+inline int block_bits_avx2(__m256i magnitude) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i reduced = _mm256_max_epi32(_mm256_sub_epi32(magnitude, _mm256_set1_epi32(1)), zero);
+    __m256i exponent = _mm256_srli_epi32(_mm256_castps_si256(_mm256_cvtepi32_ps(reduced)), 23);
+    __m256i bits = _mm256_max_epi32(_mm256_sub_epi32(exponent, _mm256_set1_epi32(126)), zero);
+
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(bits), _mm256_extracti128_si256(bits, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+
+/**
+ * @brief AVX2-ядро: частичные произведения в 4 дорожках, блоки по 8 элементов
+ *
+ * @details
+ * Дорожки хранят модули частичных произведений, знак учитывается четностью
+ * числа отрицательных элементов. Для каждого блока оценивается, на сколько
+ * бит он может увеличить модуль; пока |state.product| * (дорожки) заведомо
+ * меньше 2^63, ни один префикс не переполняется и блок умножается в дорожки
+ * без проверок. Иначе дорожки сворачиваются в state, и если бюджета все
+ * равно не хватает, блок проходит эталонными шагами - так момент и знак
+ * переполнения совпадают с fold_scalar().
+ */
+__attribute__((target("avx2")))
+void fold_avx2(ProductState& state, const void* data, size_t count) {
+    const char* bytes = static_cast<const char*>(data);
+    const __m256i one = _mm256_set1_epi64x(1);
+    __m256i lanes = one;
+    int negatives = 0;
+    int budget = 63 - magnitude_bits(state.product);
+    uint64_t partial[4];
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i * 4));
+        __m256i magnitude = _mm256_abs_epi32(v);
+        int bits = block_bits_avx2(magnitude);
+
+        if (bits > budget) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(partial), lanes);
+            flush_lanes(state, partial, 4, __builtin_parity(negatives));
+            lanes = one;
+            negatives = 0;
+            budget = 63 - magnitude_bits(state.product);
+
+            if (bits > budget) {
+                fold_scalar(state, bytes + i * 4, 8);
+                if (is_decided(state)) {
+                    return;
+                }
+                budget = 63 - magnitude_bits(state.product);
+                continue;
+            }
+        }
+
+        budget -= bits;
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(v, _mm256_setzero_si256())) != 0) {
+            state.product = 0; // Префиксы блока не переполняются, значит результат 0
+            return;
+        }
+        lanes = mul_lanes_avx2(lanes, magnitude);                         // четные элементы
+        lanes = mul_lanes_avx2(lanes, _mm256_srli_epi64(magnitude, 32));  // нечетные
+        negatives ^= _mm256_movemask_ps(_mm256_castsi256_ps(v));
+    }
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(partial), lanes);
+    flush_lanes(state, partial, 4, __builtin_parity(negatives));
+    fold_scalar(state, bytes + i * 4, count - i);
+}
+
+bool avx512_supported() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f");
+}
+
+/**
+ * @brief AVX-512-ядро: то же, что fold_avx2(), с 8 дорожками и блоками по 16
+ */
+__attribute__((target("avx512f")))
+void fold_avx512(ProductState& state, const void* data, size_t count) {
+    const char* bytes = static_cast<const char*>(data);
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i one = _mm512_set1_epi64(1);
+    __m512i lanes = one;
+    unsigned negatives = 0;
+    int budget = 63 - magnitude_bits(state.product);
+    uint64_t partial[8];
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        __m512i v = _mm512_loadu_si512(bytes + i * 4);
+        __m512i magnitude = _mm512_abs_epi32(v);
+
+        // Оценка ceil(log2 |v|), как в block_bits_avx2()
+        __m512i reduced = _mm512_max_epi32(_mm512_sub_epi32(magnitude, _mm512_set1_epi32(1)), zero);
+        __m512i exponent = _mm512_srli_epi32(_mm512_castps_si512(_mm512_cvtepi32_ps(reduced)), 23);
+        int bits = _mm512_reduce_add_epi32(
+            _mm512_max_epi32(_mm512_sub_epi32(exponent, _mm512_set1_epi32(126)), zero));
+
+        if (bits > budget) {
+            _mm512_storeu_si512(partial, lanes);
+            flush_lanes(state, partial, 8, __builtin_parity(negatives));
+            lanes = one;
+            negatives = 0;
+            budget = 63 - magnitude_bits(state.product);
+
+            if (bits > budget) {
+                fold_scalar(state, bytes + i * 4, 16);
+                if (is_decided(state)) {
+                    return;
+                }
+                budget = 63 - magnitude_bits(state.product);
+                continue;
+            }
+        }
+
+        budget -= bits;
+        if (_mm512_cmpeq_epi32_mask(v, zero) != 0) {
+            state.product = 0; // Префиксы блока не переполняются, значит результат 0
+            return;
+        }
+        __m512i odd = _mm512_srli_epi64(magnitude, 32);
+        __m512i lo = _mm512_mul_epu32(lanes, magnitude);
+        __m512i hi = _mm512_mul_epu32(_mm512_srli_epi64(lanes, 32), magnitude);
+        lanes = _mm512_add_epi64(lo, _mm512_slli_epi64(hi, 32));
+        lo = _mm512_mul_epu32(lanes, odd);
+        hi = _mm512_mul_epu32(_mm512_srli_epi64(lanes, 32), odd);
+        lanes = _mm512_add_epi64(lo, _mm512_slli_epi64(hi, 32));
+        negatives ^= _mm512_cmplt_epi32_mask(v, zero);
+    }
+
+    _mm512_storeu_si512(partial, lanes);
+    flush_lanes(state, partial, 8, __builtin_parity(negatives));
+    fold_scalar(state, bytes + i * 4, count - i);
+}
+
+#endif // VECTOR_PROCESSOR_X86
+
+/**
+ * @brief Все ядра, от эталонного к самому быстрому
+ */
+const ProductKernel kKernels[] = {
+    {"scalar", always_supported, fold_scalar},
+    {"unrolled", always_supported, fold_unrolled},
+#ifdef VECTOR_PROCESSOR_X86
+    {"simd", sse2_supported, fold_sse2},
+    {"avx2", avx2_supported, fold_avx2},
+    {"avx512", avx512_supported, fold_avx512},
+#endif
+};
+
+const size_t kKernelCount = sizeof(kKernels) / sizeof(kKernels[0]);
+
+/**
+ * @brief Лучшее ядро, поддерживаемое процессором
+ */
+const ProductKernel* best_kernel() {
+    for (size_t i = kKernelCount; i > 0; i--) {
+        if (kKernels[i - 1].supported()) {
+            return &kKernels[i - 1];
+        }
+    }
+    return &kKernels[0];
+}
+
+/**
+ * @brief Активное ядро
+ */
+const ProductKernel*& active_kernel() {
+    static const ProductKernel* kernel = best_kernel();
+    return kernel;
+}
+
+/**
+ * @brief Порог параллельной обработки по умолчанию (в элементах)
+ *
+ * Меньшие коллекции считаются быстрее, чем задачи раздаются по потокам.
+ */
+const size_t kDefaultParallelThreshold = 1 << 16;
+
+/**
+ * @brief Текущий порог параллельной обработки
+ */
+size_t& parallel_threshold_value() {
+    static size_t threshold = kDefaultParallelThreshold;
+    return threshold;
+}
+
+/**
+ * @brief Обработка коллекции векторов диапазонами на пуле
+ *
+ * @param count Количество векторов
+ * @param size_of Размер i-го вектора
+ * @param process Обработка векторов [begin, end)
+ * @param workers Пул потоков или nullptr - общий пул
+ *
+ * @details
+ * Вес вектора - количество элементов плюс 1 (накладные расходы на сам
+ * вектор), чтобы коллекция из множества пустых векторов тоже делилась.
+ * Коллекция делится на непрерывные диапазоны примерно равного веса,
+ * по 4 на исполнителя (потоки пула и вызывающий поток).
+ *
+ * @note Общий пул запрашивается только для коллекций не меньше порога,
+ *       поэтому малые пакеты не запускают его потоки
+ */
+template <typename SizeOf, typename Process>
+void process_batch(size_t count, SizeOf size_of, Process process, TaskPool* workers) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += size_of(i) + 1;
+    }
+
+    if (total < parallel_threshold_value()) {
+        process(0, count);
+        return;
+    }
+    TaskPool& pool = workers != nullptr ? *workers : TaskPool::shared();
+    if (pool.size() == 0) {
+        process(0, count);
+        return;
+    }
+
+    size_t target = total / ((pool.size() + 1) * 4) + 1;
+    std::vector<std::function<void()>> tasks;
+    size_t begin = 0;
+    size_t weight = 0;
+    for (size_t i = 0; i < count; i++) {
+        weight += size_of(i) + 1;
+        if (weight >= target || i + 1 == count) {
+            size_t end = i + 1;
+            tasks.push_back([&process, begin, end]() { process(begin, end); });
+            begin = end;
+            weight = 0;
+        }
+    }
+    pool.run(tasks);
+}
+
+/**
+ * @brief Порог параллельной свертки одного вектора по умолчанию (в элементах)
+ */
+const size_t kDefaultReductionThreshold = 1 << 22;
+
+/**
+ * @brief Текущий порог параллельной свертки одного вектора
+ */
+size_t& reduction_threshold_value() {
+    static size_t threshold = kDefaultReductionThreshold;
+    return threshold;
+}
+
+/**
+ * @brief Параллельная свертка длинного массива
+ *
+ * @param state Продолжаемое состояние
+ * @param bytes Элементы
+ * @param count Количество элементов
+ * @param pool Пул потоков
+ *
+ * @details
+ * 1. Массив делится на части по числу исполнителей (с запасом для
+ *    перехвата); каждая часть независимо сворачивается активным ядром,
+ *    начиная с 1.
+ * 2. Частичные результаты объединяются слева направо. Если часть не дошла
+ *    до нуля и переполнения, ее произведение P точное и все ее префиксы по
+ *    модулю не больше |P|; тогда при |p| * |P| <= INT64_MAX ни один префикс
+ *    не переполняется и p *= P - ровно то, что дала бы последовательная
+ *    свертка.
+ * 3. Иначе (часть содержит 0, переполнилась сама или переполняется вместе
+ *    с p) момент насыщения зависит от p, и эта часть сворачивается заново
+ *    от p. После этого результат известен (0 или насыщение), поэтому
+ *    повторно сворачивается не больше одной части.
+ */
+void fold_parallel(ProductState& state, const char* bytes, size_t count, TaskPool& pool) {
+    const ProductKernel& kernel = VectorProcessor::kernel();
+    size_t parts = (pool.size() + 1) * 4;
+    size_t chunk = (count + parts - 1) / parts;
+    parts = (count + chunk - 1) / chunk;
+
+    std::vector<ProductState> partial(parts);
+    std::vector<std::function<void()>> tasks;
+    for (size_t c = 0; c < parts; c++) {
+        tasks.push_back([&partial, &kernel, bytes, count, chunk, c]() {
+            size_t begin = c * chunk;
+            ProductState part = {1, false, 0};
+            kernel.fold(part, bytes + begin * 4, std::min(chunk, count - begin));
+            partial[c] = part;
+        });
+    }
+    pool.run(tasks);
+
+    for (size_t c = 0; c < parts && !is_decided(state); c++) {
+        const ProductState& part = partial[c];
+        if (!is_decided(part) && llabs(state.product) <= INT64_MAX / llabs(part.product)) {
+            state.product *= part.product;
+            continue;
+        }
+        size_t begin = c * chunk;
+        kernel.fold(state, bytes + begin * 4, std::min(chunk, count - begin));
+    }
+}
+
+/**
+ * @brief Максимум типа накопления (numeric_limits для __int128 в -std=c++11 нет)
+ */
+inline __int128 accumulator_max(__int128) {
+    return static_cast<__int128>(~static_cast<unsigned __int128>(0) >> 1);
+}
+
+/**
+ * @brief Битовая длина модуля 128-битного произведения
+ *
+ * @return int Количество значащих бит |product|; для нуля 1 (см. magnitude_bits())
+ */
+inline int magnitude_bits(__int128 product) {
+    unsigned __int128 magnitude = static_cast<unsigned __int128>(product < 0 ? -product : product) | 1u;
+    uint64_t high = static_cast<uint64_t>(magnitude >> 64);
+    return high != 0 ? 128 - __builtin_clzll(high)
+                     : 64 - __builtin_clzll(static_cast<uint64_t>(magnitude));
+}
+
+/**
+ * @brief ceil(log2 |value|) для int64: 0 для 0 и ±1, 63 для INT64_MIN
+ */
+inline int element_bits(int64_t value) {
+    uint64_t magnitude = value < 0 ? 0u - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    uint64_t reduced = magnitude - (magnitude != 0);
+    return 63 - __builtin_clzll((reduced << 1) | 1u);
+}
+
+/**
+ * @brief Умножение 8 дорожек на блок из 8 элементов
+ *
+ * @details
+ * lanes[j] *= block[j] для блоков подряд. Элементы float переводятся в
+ * double точно, поэтому скалярная и AVX-версии выполняют одни и те же
+ * умножения IEEE 754 и дают одинаковые дорожки.
+ */
+template <typename T>
+void fold_lanes_scalar(double* lanes, const char* bytes, size_t blocks) {
+    for (size_t b = 0; b < blocks; b++) {
+        T v[8];
+        memcpy(v, bytes + b * sizeof(v), sizeof(v));
+        for (size_t j = 0; j < 8; j++) {
+            lanes[j] *= static_cast<double>(v[j]);
+        }
+    }
+}
+
+#ifdef VECTOR_PROCESSOR_X86
+
+bool avx_supported() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx");
+}
+
+__attribute__((target("avx")))
+void fold_lanes_avx_float(double* lanes, const char* bytes, size_t blocks) {
+    __m256d low = _mm256_loadu_pd(lanes);
+    __m256d high = _mm256_loadu_pd(lanes + 4);
+    for (size_t b = 0; b < blocks; b++) {
+        __m256 v = _mm256_loadu_ps(reinterpret_cast<const float*>(bytes + b * 32));
+        low = _mm256_mul_pd(low, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+        high = _mm256_mul_pd(high, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+    }
+    _mm256_storeu_pd(lanes, low);
+    _mm256_storeu_pd(lanes + 4, high);
+}
+
+__attribute__((target("avx")))
+void fold_lanes_avx_double(double* lanes, const char* bytes, size_t blocks) {
+    __m256d low = _mm256_loadu_pd(lanes);
+    __m256d high = _mm256_loadu_pd(lanes + 4);
+    for (size_t b = 0; b < blocks; b++) {
+        const double* v = reinterpret_cast<const double*>(bytes + b * 64);
+        low = _mm256_mul_pd(low, _mm256_loadu_pd(v));
+        high = _mm256_mul_pd(high, _mm256_loadu_pd(v + 4));
+    }
+    _mm256_storeu_pd(lanes, low);
+    _mm256_storeu_pd(lanes + 4, high);
+}
+
+#endif // VECTOR_PROCESSOR_X86
+
+typedef void (*LaneFold)(double* lanes, const char* bytes, size_t blocks);
+
+/**
+ * @brief Реализация свертки дорожек для типа элементов (выбирается один раз)
+ */
+template <typename T>
+LaneFold select_lane_fold();
+
+template <>
+LaneFold select_lane_fold<float>() {
+#ifdef VECTOR_PROCESSOR_X86
+    if (avx_supported()) {
+        return fold_lanes_avx_float;
+    }
+#endif
+    return fold_lanes_scalar<float>;
+}
+
+template <>
+LaneFold select_lane_fold<double>() {
+#ifdef VECTOR_PROCESSOR_X86
+    if (avx_supported()) {
+        return fold_lanes_avx_double;
+    }
+#endif
+    return fold_lanes_scalar<double>;
+}
+
+} // namespace
 
 /**
  * @brief Вычисляет произведение элементов вектора
- * 
+ *
  * @param vector Входной вектор целых чисел
  * @return int32_t Произведение элементов или граничное значение при переполнении
- * 
+ *
  * @details
  * Алгоритм:
  * 1. Проверка пустого вектора -> возврат 0
@@ -30,68 +693,920 @@
  *    - Если переполнение -> возврат INT32_MAX или INT32_MIN
  *    - Иначе умножение аккумулятора на элемент
  * 4. Проверка результата на соответствие 32-битному диапазону
- * 
+ *
  * @example
  * Vector v = {1, 2, 3};
  * int32_t result = VectorProcessor::calculate_product(v); // 6
- * 
+ *
  * Vector large = {INT32_MAX, 2};
  * int32_t overflow = VectorProcessor::calculate_product(large); // INT32_MAX
  */
 int32_t VectorProcessor::calculate_product(const Vector& vector) {
-    if (vector.empty()) {
-        return 0;
-    }
-    
-    int64_t product = 1;
-    
-    for (int32_t val : vector) {
-        // Проверка переполнения при умножении
-        // Используем static_cast<int64_t> для безопасного преобразования
-        int64_t val64 = static_cast<int64_t>(val);
-        
-        if (val64 != 0 && llabs(product) > INT64_MAX / llabs(val64)) {
-            // Переполнение
-            if ((product > 0 && val64 > 0) || (product < 0 && val64 < 0)) {
-                return INT32_MAX;
-            } else {
-                return INT32_MIN;
-            }
-        }
-        product *= val64;
-    }
-    
-    // Проверка выхода за пределы int32
-    if (product > INT32_MAX) {
-        return INT32_MAX;
+    return calculate_product(vector.data(), vector.size());
+}
+
+/**
+ * @brief Вычисляет произведение элементов массива активным ядром
+ *
+ * @param data Элементы
+ * @param count Количество элементов
+ * @return int32_t Произведение
+ *
+ * @note Общий пул потоков создается только для векторов не меньше
+ *       reduction_threshold(), остальные сворачиваются в вызывающем потоке
+ */
+int32_t VectorProcessor::calculate_product(const void* data, size_t count) {
+    if (count < reduction_threshold()) {
+        ProductAccumulator accumulator;
+        accumulator.add(static_cast<const char*>(data), count);
+        return accumulator.result();
     }
-    if (product < INT32_MIN) {
-        return INT32_MIN;
+    return calculate_product(data, count, TaskPool::shared());
+}
+
+/**
+ * @brief Вычисляет произведение элементов массива на заданном пуле
+ *
+ * @param data Элементы
+ * @param count Количество элементов
+ * @param pool Пул потоков
+ * @return int32_t Произведение
+ */
+int32_t VectorProcessor::calculate_product(const void* data, size_t count, TaskPool& pool) {
+    ProductAccumulator accumulator;
+    if (pool.size() > 0 && count >= reduction_threshold()) {
+        accumulator.add_parallel(static_cast<const char*>(data), count, pool);
+    } else {
+        accumulator.add(static_cast<const char*>(data), count);
     }
-    
-    return static_cast<int32_t>(product);
+    return accumulator.result();
 }
 
 /**
  * @brief Вычисляет произведения для коллекции векторов
- * 
+ *
  * @param vectors Коллекция векторов для обработки
  * @return std::vector<int32_t> Вектор произведений для каждого входного вектора
- * 
+ *
  * @details
- * Обрабатывает векторы последовательно, применяя calculate_product() к каждому.
+ * Применяет calculate_product() к каждому вектору на общем пуле потоков.
  * Размер выходного вектора равен количеству входных векторов.
- * 
+ *
  * @note Не модифицирует входные векторы
  * @note Возвращает пустой вектор если входная коллекция пуста
  */
 std::vector<int32_t> VectorProcessor::multiply_vectors(const std::vector<Vector>& vectors) {
-    std::vector<int32_t> results;
-    results.reserve(vectors.size());
-    
-    for (const auto& vector : vectors) {
-        results.push_back(calculate_product(vector));
-    }
-    
+    return multiply_collection(vectors, nullptr);
+}
+
+/**
+ * @brief Вычисляет произведения для коллекции векторов на заданном пуле
+ *
+ * @param vectors Коллекция векторов для обработки
+ * @param pool Пул потоков
+ * @return std::vector<int32_t> Произведения в порядке входных векторов
+ */
+std::vector<int32_t> VectorProcessor::multiply_vectors(const std::vector<Vector>& vectors, TaskPool& pool) {
+    return multiply_collection(vectors, &pool);
+}
+
+/**
+ * @brief Произведения коллекции векторов
+ *
+ * @param vectors Коллекция векторов
+ * @param workers Пул потоков или nullptr - общий пул
+ * @return std::vector<int32_t> Произведения в порядке входных векторов
+ */
+std::vector<int32_t> VectorProcessor::multiply_collection(const std::vector<Vector>& vectors,
+                                                          TaskPool* workers) {
+    std::vector<int32_t> results(vectors.size());
+    process_batch(vectors.size(),
+                  [&vectors](size_t i) { return vectors[i].size(); },
+                  [&vectors, &results](size_t begin, size_t end) {
+                      for (size_t i = begin; i < end; i++) {
+                          results[i] = calculate_product(vectors[i]);
+                      }
+                  },
+                  workers);
     return results;
 }
+
+/**
+ * @brief Вычисляет произведения для пакета в плоском формате
+ *
+ * @param elements Элементы всех векторов подряд
+ * @param offsets Границы векторов (количество векторов + 1)
+ * @param results Произведения (по одному на вектор)
+ */
+void VectorProcessor::multiply_vectors(Span<const int32_t> elements, Span<const size_t> offsets,
+                                       Span<int32_t> results) {
+    multiply_flat(elements, offsets, results, nullptr);
+}
+
+/**
+ * @brief Вычисляет произведения для пакета в плоском формате на заданном пуле
+ *
+ * @param elements Элементы всех векторов подряд
+ * @param offsets Границы векторов (количество векторов + 1)
+ * @param results Произведения (по одному на вектор)
+ * @param pool Пул потоков
+ *
+ * @throw std::invalid_argument если границы не согласованы с размерами
+ */
+void VectorProcessor::multiply_vectors(Span<const int32_t> elements, Span<const size_t> offsets,
+                                       Span<int32_t> results, TaskPool& pool) {
+    multiply_flat(elements, offsets, results, &pool);
+}
+
+/**
+ * @brief Произведения пакета в плоском формате
+ *
+ * @param elements Элементы всех векторов подряд
+ * @param offsets Границы векторов (количество векторов + 1)
+ * @param results Произведения (по одному на вектор)
+ * @param workers Пул потоков или nullptr - общий пул
+ *
+ * @throw std::invalid_argument если границы не согласованы с размерами
+ */
+void VectorProcessor::multiply_flat(Span<const int32_t> elements, Span<const size_t> offsets,
+                                    Span<int32_t> results, TaskPool* workers) {
+    if (results.empty() && offsets.size() <= 1) {
+        return;
+    }
+    if (offsets.size() != results.size() + 1) {
+        throw std::invalid_argument("Batch offsets must hold one more entry than results");
+    }
+    for (size_t i = 0; i < results.size(); i++) {
+        if (offsets[i] > offsets[i + 1]) {
+            throw std::invalid_argument("Batch offsets must not decrease");
+        }
+    }
+    if (offsets[results.size()] > elements.size()) {
+        throw std::invalid_argument("Batch offsets are out of the element buffer");
+    }
+
+    process_batch(results.size(),
+                  [&offsets](size_t i) { return offsets[i + 1] - offsets[i]; },
+                  [&elements, &offsets, &results](size_t begin, size_t end) {
+                      for (size_t i = begin; i < end; i++) {
+                          results[i] = calculate_product(elements.data() + offsets[i], offsets[i + 1] - offsets[i]);
+                      }
+                  },
+                  workers);
+}
+
+/**
+ * @brief Задает порог параллельной свертки одного вектора
+ *
+ * @param elements Порог в элементах
+ */
+void VectorProcessor::set_reduction_threshold(size_t elements) {
+    reduction_threshold_value() = elements;
+}
+
+/**
+ * @brief Порог параллельной свертки одного вектора
+ *
+ * @return size_t Порог в элементах
+ */
+size_t VectorProcessor::reduction_threshold() {
+    return reduction_threshold_value();
+}
+
+/**
+ * @brief Задает порог параллельной обработки
+ *
+ * @param elements Порог в элементах
+ */
+void VectorProcessor::set_parallel_threshold(size_t elements) {
+    parallel_threshold_value() = elements;
+}
+
+/**
+ * @brief Порог параллельной обработки
+ *
+ * @return size_t Порог в элементах
+ */
+size_t VectorProcessor::parallel_threshold() {
+    return parallel_threshold_value();
+}
+
+/**
+ * @brief Активное ядро
+ *
+ * @return const ProductKernel& Ядро, которым считаются произведения
+ */
+const ProductKernel& VectorProcessor::kernel() {
+    return *active_kernel();
+}
+
+/**
+ * @brief Выбор ядра
+ *
+ * @param name Имя ядра или "auto"
+ * @return bool true если ядро выбрано
+ */
+bool VectorProcessor::select_kernel(const std::string& name) {
+    if (name == "auto") {
+        active_kernel() = best_kernel();
+        return true;
+    }
+    for (size_t i = 0; i < kKernelCount; i++) {
+        if (name == kKernels[i].name) {
+            if (!kKernels[i].supported()) {
+                return false;
+            }
+            active_kernel() = &kKernels[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Список ядер
+ *
+ * @return std::vector<const ProductKernel*> Все собранные ядра
+ */
+std::vector<const ProductKernel*> VectorProcessor::kernels() {
+    std::vector<const ProductKernel*> result;
+    for (size_t i = 0; i < kKernelCount; i++) {
+        result.push_back(&kKernels[i]);
+    }
+    return result;
+}
+
+/**
+ * @brief Сброс аккумулятора
+ */
+void ProductAccumulator::reset() {
+    state_.product = 1;
+    state_.saturated = false;
+    state_.saturation = 0;
+    empty_ = true;
+}
+
+/**
+ * @brief Добавление элемента
+ *
+ * @param value Элемент
+ */
+void ProductAccumulator::add(int32_t value) {
+    empty_ = false;
+    if (!state_.saturated) {
+        fold_step(state_, value);
+    }
+}
+
+/**
+ * @brief Добавление элементов активным ядром
+ *
+ * @param data Элементы
+ * @param count Количество элементов
+ */
+void ProductAccumulator::add(const char* data, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    empty_ = false;
+    if (!is_decided(state_)) {
+        VectorProcessor::kernel().fold(state_, data, count);
+    }
+}
+
+/**
+ * @brief Добавление элементов параллельной сверткой
+ *
+ * @param data Элементы
+ * @param count Количество элементов
+ * @param pool Пул потоков
+ */
+void ProductAccumulator::add_parallel(const char* data, size_t count, TaskPool& pool) {
+    if (count == 0) {
+        return;
+    }
+    empty_ = false;
+    if (!is_decided(state_)) {
+        fold_parallel(state_, data, count, pool);
+    }
+}
+
+/**
+ * @brief Проверка, известен ли результат окончательно
+ *
+ * @return bool true после переполнения или нулевого произведения
+ */
+bool ProductAccumulator::decided() const {
+    return !empty_ && is_decided(state_);
+}
+
+/**
+ * @brief Результат
+ *
+ * @return int32_t Произведение в диапазоне int32
+ */
+int32_t ProductAccumulator::result() const {
+    if (empty_) {
+        return 0;
+    }
+    if (state_.saturated) {
+        return state_.saturation;
+    }
+
+    // Проверка выхода за пределы int32
+    if (state_.product > INT32_MAX) {
+        return INT32_MAX;
+    }
+    if (state_.product < INT32_MIN) {
+        return INT32_MIN;
+    }
+    return static_cast<int32_t>(state_.product);
+}
+
+/**
+ * @brief Сброс аккумулятора
+ */
+template <typename T, typename Accumulator>
+void BasicProductAccumulator<T, Accumulator, false>::reset() {
+    product_ = 1;
+    saturated_ = false;
+    saturation_ = 0;
+    empty_ = true;
+}
+
+/**
+ * @brief Один шаг с проверкой переполнения (аналог fold_step() для T)
+ *
+ * @param value Элемент
+ * @return bool false если произошло переполнение
+ */
+template <typename T, typename Accumulator>
+bool BasicProductAccumulator<T, Accumulator, false>::step(T value) {
+    Accumulator wide = static_cast<Accumulator>(value);
+    Accumulator magnitude = product_ < 0 ? -product_ : product_;
+    Accumulator wide_magnitude = wide < 0 ? -wide : wide;
+
+    if (wide != 0 && magnitude > accumulator_max(product_) / wide_magnitude) {
+        saturated_ = true;
+        saturation_ = ((product_ > 0 && wide > 0) || (product_ < 0 && wide < 0))
+                          ? std::numeric_limits<T>::max() : std::numeric_limits<T>::min();
+        return false;
+    }
+    product_ *= wide;
+    return true;
+}
+
+/**
+ * @brief Добавление элемента
+ *
+ * @param value Элемент
+ */
+template <typename T, typename Accumulator>
+void BasicProductAccumulator<T, Accumulator, false>::add(T value) {
+    empty_ = false;
+    if (!saturated_) {
+        step(value);
+    }
+}
+
+/**
+ * @brief Добавление элементов
+ *
+ * @param data Элементы
+ * @param count Количество элементов
+ *
+ * @details
+ * Блоки по 4 элемента умножаются деревом без проверок, пока битовая длина
+ * |произведения| плюс сумма ceil(log2 |v|) по блоку не превышает
+ * разрядность Accumulator без знака (см. fold_unrolled()).
+ */
+template <typename T, typename Accumulator>
+void BasicProductAccumulator<T, Accumulator, false>::add(const char* data, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    empty_ = false;
+
+    const int width = static_cast<int>(sizeof(Accumulator) * CHAR_BIT) - 1;
+    size_t i = 0;
+    while (i < count && !decided()) {
+        if (i + 4 <= count) {
+            T v[4];
+            memcpy(v, data + i * sizeof(T), sizeof(v));
+            int bits = element_bits(v[0]) + element_bits(v[1]) + element_bits(v[2]) + element_bits(v[3]);
+            if (magnitude_bits(product_) + bits <= width) {
+                product_ *= (static_cast<Accumulator>(v[0]) * v[1]) * (static_cast<Accumulator>(v[2]) * v[3]);
+                i += 4;
+                continue;
+            }
+        }
+
+        T value;
+        memcpy(&value, data + i * sizeof(T), sizeof(T));
+        step(value);
+        i++;
+    }
+}
+
+/**
+ * @brief Проверка, известен ли результат окончательно
+ */
+template <typename T, typename Accumulator>
+bool BasicProductAccumulator<T, Accumulator, false>::decided() const {
+    return !empty_ && (saturated_ || product_ == 0);
+}
+
+/**
+ * @brief Результат
+ *
+ * @return T Произведение в диапазоне T
+ */
+template <typename T, typename Accumulator>
+T BasicProductAccumulator<T, Accumulator, false>::result() const {
+    if (empty_) {
+        return 0;
+    }
+    if (saturated_) {
+        return saturation_;
+    }
+    if (product_ > static_cast<Accumulator>(std::numeric_limits<T>::max())) {
+        return std::numeric_limits<T>::max();
+    }
+    if (product_ < static_cast<Accumulator>(std::numeric_limits<T>::min())) {
+        return std::numeric_limits<T>::min();
+    }
+    return static_cast<T>(product_);
+}
+
+/**
+ * @brief Сброс аккумулятора
+ */
+template <typename T, typename Accumulator>
+void BasicProductAccumulator<T, Accumulator, true>::reset() {
+    for (size_t j = 0; j < kLanes; j++) {
+        lanes_[j] = 1;
+    }
+    position_ = 0;
+    empty_ = true;
+}
+
+/**
+ * @brief Добавление элемента в очередную дорожку
+ *
+ * @param value Элемент
+ */
+template <typename T, typename Accumulator>
+void BasicProductAccumulator<T, Accumulator, true>::add(T value) {
+    empty_ = false;
+    lanes_[position_] *= static_cast<Accumulator>(value);
+    position_ = (position_ + 1) % kLanes;
+}
+
+/**
+ * @brief Добавление элементов
+ *
+ * @param data Элементы
+ * @param count Количество элементов
+ *
+ * @details
+ * Элементы до границы блока добавляются по одному, целые блоки по 8
+ * элементов - реализацией, выбранной по возможностям процессора.
+ */
+template <typename T, typename Accumulator>
+void BasicProductAccumulator<T, Accumulator, true>::add(const char* data, size_t count) {
+    static const LaneFold fold_blocks = select_lane_fold<T>();
+
+    size_t i = 0;
+    for (; i < count && position_ != 0; i++) {
+        T value;
+        memcpy(&value, data + i * sizeof(T), sizeof(T));
+        add(value);
+    }
+
+    size_t blocks = (count - i) / kLanes;
+    if (blocks > 0) {
+        empty_ = false;
+        fold_blocks(lanes_, data + i * sizeof(T), blocks);
+        i += blocks * kLanes;
+    }
+
+    for (; i < count; i++) {
+        T value;
+        memcpy(&value, data + i * sizeof(T), sizeof(T));
+        add(value);
+    }
+}
+
+/**
+ * @brief Проверка, известен ли результат окончательно
+ *
+ * @return bool true, если в какой-либо дорожке NaN
+ */
+template <typename T, typename Accumulator>
+bool BasicProductAccumulator<T, Accumulator, true>::decided() const {
+    for (size_t j = 0; j < kLanes; j++) {
+        if (lanes_[j] != lanes_[j]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Результат
+ *
+ * @return T Произведение дорожек в фиксированном порядке, приведенное к T
+ */
+template <typename T, typename Accumulator>
+T BasicProductAccumulator<T, Accumulator, true>::result() const {
+    if (empty_) {
+        return 0;
+    }
+    Accumulator low = (lanes_[0] * lanes_[1]) * (lanes_[2] * lanes_[3]);
+    Accumulator high = (lanes_[4] * lanes_[5]) * (lanes_[6] * lanes_[7]);
+    return static_cast<T>(low * high);
+}
+
+template class BasicProductAccumulator<int64_t>;
+template class BasicProductAccumulator<float>;
+template class BasicProductAccumulator<double>;
+
+namespace {
+
+/**
+ * @brief Читает элемент типа T без требований к выравниванию
+ */
+template <typename T>
+inline T load_value(const char* data, size_t index) {
+    T value;
+    memcpy(&value, data + index * sizeof(T), sizeof(T));
+    return value;
+}
+
+/**
+ * @brief Приведение целочисленного результата к диапазону T с насыщением
+ */
+template <typename T, typename W>
+typename std::enable_if<std::is_integral<T>::value, T>::type saturate(W value) {
+    if (value > static_cast<W>(std::numeric_limits<T>::max())) {
+        return std::numeric_limits<T>::max();
+    }
+    if (value < static_cast<W>(std::numeric_limits<T>::min())) {
+        return std::numeric_limits<T>::min();
+    }
+    return static_cast<T>(value);
+}
+
+template <typename T, typename W>
+typename std::enable_if<!std::is_integral<T>::value, T>::type saturate(W value) {
+    return static_cast<T>(value);
+}
+
+/**
+ * @brief Округление неотрицательной нормы до целого T с насыщением
+ */
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value, T>::type round_norm(double value) {
+    double rounded = std::round(value);
+    // (double)max для int64 равен 2^63, поэтому сравнение нестрогое
+    if (rounded >= static_cast<double>(std::numeric_limits<T>::max())) {
+        return std::numeric_limits<T>::max();
+    }
+    return static_cast<T>(rounded);
+}
+
+template <typename T>
+typename std::enable_if<!std::is_integral<T>::value, T>::type round_norm(double value) {
+    return static_cast<T>(value);
+}
+
+/**
+ * @brief Типы накопления сумм: без переполнения для 2^32 элементов
+ *
+ * int32 - int64 (|сумма| < 2^63), int64 - __int128 (< 2^95),
+ * float и double - double.
+ */
+template <typename T> struct SumTraits { typedef double Accumulator; };
+template <> struct SumTraits<int32_t> { typedef int64_t Accumulator; };
+template <> struct SumTraits<int64_t> { typedef __int128 Accumulator; };
+
+/**
+ * @brief Тип накопления скалярного произведения
+ *
+ * Для целых - __int128: произведение пары int64 занимает до 127 бит,
+ * поэтому переполнение суммы учитывается отдельно (см. DotAccumulator).
+ */
+template <typename T> struct DotTraits { typedef double Accumulator; };
+template <> struct DotTraits<int32_t> { typedef __int128 Accumulator; };
+template <> struct DotTraits<int64_t> { typedef __int128 Accumulator; };
+
+/**
+ * @brief Сложение с учетом переполнения: перенос копится в carry
+ */
+inline void accumulate(__int128& sum, int& carry, __int128 term) {
+    if (__builtin_add_overflow(sum, term, &sum)) {
+        carry += term > 0 ? 1 : -1;
+    }
+}
+
+inline void accumulate(double& sum, int&, double term) {
+    sum += term;
+}
+
+/**
+ * @brief Сумма; целочисленный результат насыщается до диапазона T
+ */
+template <typename T>
+class SumAccumulator {
+    typename SumTraits<T>::Accumulator sum_ = 0;
+
+public:
+    void add(const char* data, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            sum_ += load_value<T>(data, i);
+        }
+    }
+    bool decided() const { return false; }
+    T result() const { return saturate<T>(sum_); }
+};
+
+/**
+ * @brief Сумма модулей; целочисленный результат насыщается до максимума T
+ */
+template <typename T>
+class L1Accumulator {
+    typedef typename SumTraits<T>::Accumulator Accumulator;
+    Accumulator sum_ = 0;
+
+public:
+    void add(const char* data, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            Accumulator value = load_value<T>(data, i);
+            sum_ += value < 0 ? -value : value;
+        }
+    }
+    bool decided() const { return false; }
+    T result() const { return saturate<T>(sum_); }
+};
+
+/**
+ * @brief Евклидова норма: сумма квадратов в double, для целых - округление
+ */
+template <typename T>
+class L2Accumulator {
+    double sum_ = 0;
+
+public:
+    void add(const char* data, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            double value = static_cast<double>(load_value<T>(data, i));
+            sum_ += value * value;
+        }
+    }
+    bool decided() const { return false; }
+    T result() const { return round_norm<T>(std::sqrt(sum_)); }
+};
+
+/**
+ * @brief Минимум (Greater = false) или максимум (Greater = true)
+ *
+ * @details
+ * NaN в элементах float/double становится результатом. Результат окончателен
+ * для целых при достижении предела T, для float/double - при NaN.
+ */
+template <typename T, bool Greater>
+class ExtremeAccumulator {
+    T value_ = 0;
+    bool empty_ = true;
+
+    static bool is_final(T value, std::true_type) {
+        return value == (Greater ? std::numeric_limits<T>::max() : std::numeric_limits<T>::min());
+    }
+    static bool is_final(T value, std::false_type) { return value != value; }
+
+public:
+    void add(const char* data, size_t count) {
+        size_t i = 0;
+        if (empty_ && count > 0) {
+            value_ = load_value<T>(data, 0);
+            empty_ = false;
+            i = 1;
+        }
+        for (; i < count; i++) {
+            T value = load_value<T>(data, i);
+            if (value != value || (Greater ? value > value_ : value < value_)) {
+                value_ = value;
+            }
+        }
+    }
+    bool decided() const { return !empty_ && is_final(value_, std::is_integral<T>()); }
+    T result() const { return value_; }
+};
+
+template <typename T> using MinAccumulator = ExtremeAccumulator<T, false>;
+template <typename T> using MaxAccumulator = ExtremeAccumulator<T, true>;
+
+/**
+ * @brief Скалярное произведение пар: элементы a0 b0 a1 b1 ...
+ *
+ * @details
+ * Пара может разделиться между порциями - первый элемент ждет второго.
+ * Векторы нечетного размера отклоняет ProtocolParser; при прямом вызове
+ * непарный последний элемент не учитывается. Переносы из
+ * __int128 считаются в carry, поэтому насыщение до T точное.
+ */
+template <typename T>
+class DotAccumulator {
+    typedef typename DotTraits<T>::Accumulator Accumulator;
+    Accumulator sum_ = 0;
+    int carry_ = 0;
+    T pending_ = 0;
+    bool has_pending_ = false;
+
+    void add_pair(T a, T b) {
+        accumulate(sum_, carry_, static_cast<Accumulator>(a) * b);
+    }
+
+public:
+    void add(const char* data, size_t count) {
+        size_t i = 0;
+        if (has_pending_ && count > 0) {
+            add_pair(pending_, load_value<T>(data, 0));
+            has_pending_ = false;
+            i = 1;
+        }
+        for (; i + 2 <= count; i += 2) {
+            add_pair(load_value<T>(data, i), load_value<T>(data, i + 1));
+        }
+        if (i < count) {
+            pending_ = load_value<T>(data, i);
+            has_pending_ = true;
+        }
+    }
+    bool decided() const { return false; }
+    T result() const {
+        if (carry_ != 0) {
+            return carry_ > 0 ? std::numeric_limits<T>::max() : std::numeric_limits<T>::min();
+        }
+        return saturate<T>(sum_);
+    }
+};
+
+template <typename T> using ProductReduction = BasicProductAccumulator<T>;
+
+template <typename T> struct ElementTypeOf;
+template <> struct ElementTypeOf<int32_t> { static const ElementType value = ElementType::Int32; };
+template <> struct ElementTypeOf<int64_t> { static const ElementType value = ElementType::Int64; };
+template <> struct ElementTypeOf<float> { static const ElementType value = ElementType::Float32; };
+template <> struct ElementTypeOf<double> { static const ElementType value = ElementType::Float64; };
+
+/**
+ * @brief Результат фиксированного размера в формате протокола
+ */
+template <typename V>
+void encode_result(const V& value, std::string& out) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void encode_result(const BigInteger& value, std::string& out) {
+    value.encode(out);
+}
+
+template <typename V>
+std::string format_result(const V& value) {
+    std::ostringstream stream;
+    stream << value;
+    return stream.str();
+}
+
+/**
+ * @brief Точное произведение для лога: длинные числа - только их длина
+ */
+std::string format_result(const BigInteger& value) {
+    if (value.bit_length() <= 256) {
+        return value.to_string();
+    }
+    return std::to_string(value.bit_length()) + "-bit integer";
+}
+
+/**
+ * @brief Функции ReductionKernel для аккумулятора A, размещенного в ReductionState
+ */
+template <typename A>
+struct ReductionAdapter {
+    static A& get(ReductionState& state) { return *reinterpret_cast<A*>(state.storage); }
+    static const A& get(const ReductionState& state) { return *reinterpret_cast<const A*>(state.storage); }
+
+    static void reset(ReductionState& state) {
+        static_assert(sizeof(A) <= sizeof(state.storage), "ReductionState::storage is too small");
+        static_assert(alignof(A) <= 16, "ReductionState::storage is not aligned enough");
+        new (state.storage) A();
+    }
+    static void destroy(ReductionState& state) { get(state).~A(); }
+    static void add(ReductionState& state, const char* data, size_t count) { get(state).add(data, count); }
+    static bool decided(const ReductionState& state) { return get(state).decided(); }
+    static void result(const ReductionState& state, std::string& out) { encode_result(get(state).result(), out); }
+    static std::string format(const ReductionState& state) { return format_result(get(state).result()); }
+};
+
+template <template <typename> class A, typename T>
+ReductionKernel make_reduction(Operation operation, const char* name) {
+    typedef ReductionAdapter<A<T>> Adapter;
+    ReductionKernel kernel = {operation, ElementTypeOf<T>::value, name, Adapter::reset, Adapter::destroy,
+                              Adapter::add, Adapter::decided, Adapter::result, Adapter::format};
+    return kernel;
+}
+
+/**
+ * @brief Добавляет операцию для всех типов элементов
+ */
+template <template <typename> class A>
+void register_operation(std::vector<ReductionKernel>& registry, Operation operation, const char* name) {
+    registry.push_back(make_reduction<A, int32_t>(operation, name));
+    registry.push_back(make_reduction<A, int64_t>(operation, name));
+    registry.push_back(make_reduction<A, float>(operation, name));
+    registry.push_back(make_reduction<A, double>(operation, name));
+}
+
+/**
+ * @brief Реестр операций (строится при первом обращении)
+ */
+const std::vector<ReductionKernel>& reduction_registry() {
+    static const std::vector<ReductionKernel> registry = []() {
+        std::vector<ReductionKernel> result;
+        register_operation<ProductReduction>(result, Operation::Product, "product");
+        register_operation<SumAccumulator>(result, Operation::Sum, "sum");
+        register_operation<MinAccumulator>(result, Operation::Min, "min");
+        register_operation<MaxAccumulator>(result, Operation::Max, "max");
+        register_operation<L1Accumulator>(result, Operation::L1, "l1");
+        register_operation<L2Accumulator>(result, Operation::L2, "l2");
+        register_operation<DotAccumulator>(result, Operation::Dot, "dot");
+        result.push_back(make_reduction<ExactProductAccumulator, int32_t>(Operation::ExactProduct, "exact"));
+        result.push_back(make_reduction<ExactProductAccumulator, int64_t>(Operation::ExactProduct, "exact"));
+        return result;
+    }();
+    return registry;
+}
+
+} // namespace
+
+/**
+ * @brief Поиск операции в реестре
+ *
+ * @param operation Операция
+ * @param type Тип элементов
+ * @return const ReductionKernel* Реализация или nullptr
+ */
+const ReductionKernel* VectorProcessor::reduction(Operation operation, ElementType type) {
+    for (const ReductionKernel& kernel : reduction_registry()) {
+        if (kernel.operation == operation && kernel.type == type) {
+            return &kernel;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Все операции реестра
+ *
+ * @return std::vector<const ReductionKernel*> Операции
+ */
+std::vector<const ReductionKernel*> VectorProcessor::reductions() {
+    std::vector<const ReductionKernel*> result;
+    for (const ReductionKernel& kernel : reduction_registry()) {
+        result.push_back(&kernel);
+    }
+    return result;
+}
+
+/**
+ * @brief Точное произведение элементов вектора
+ *
+ * @param vector Вектор
+ * @return BigInteger Произведение
+ */
+BigInteger VectorProcessor::exact_product(const std::vector<int32_t>& vector) {
+    ExactProductAccumulator<int32_t> accumulator;
+    accumulator.add(reinterpret_cast<const char*>(vector.data()), vector.size());
+    return accumulator.result();
+}
+
+/**
+ * @brief Выбор операции
+ *
+ * @param operation Операция
+ * @param type Тип элементов
+ * @throw std::invalid_argument если операции нет в реестре
+ */
+void TypedReduction::reset(Operation operation, ElementType type) {
+    const ReductionKernel* kernel = VectorProcessor::reduction(operation, type);
+    if (kernel == nullptr) {
+        throw std::invalid_argument("Unknown operation " + std::to_string(static_cast<int>(operation)) +
+                                    " for element type " + std::to_string(static_cast<int>(type)));
+    }
+    if (kernel_ != nullptr) {
+        kernel_->destroy(state_);
+    }
+    kernel_ = kernel;
+    kernel_->reset(state_);
+}
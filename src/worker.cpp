@@ -0,0 +1,334 @@
+/**
+ * @file worker.cpp
+ * @brief Реализация рабочего потока с событийным циклом
+ *
+ * Содержит реализацию методов класса Worker:
+ * - прием подключений со слушающего сокета
+ * - получение сокетов от потока приема через очередь
+ * - диспетчеризация событий epoll по сессиям
+ *
+ * @see worker.h
+ */
+
+#include "../include/worker.h"
+#include "../include/logger.h"
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief Конструктор
+ *
+ * @param clients База данных клиентов
+ * @param logger Логгер
+ * @param queue_capacity Емкость очереди входящих сокетов
+ * @param cache Кэш результатов или nullptr
+ * @param auth_batch_us Срок пакетной проверки в мкс (0 - выключена)
+ * @param issue_salt Выдавать клиентам соль
+ *
+ * @details
+ * Создает eventfd и регистрирует его в цикле: запись в него из другого
+ * потока будит цикл, чтобы забрать сокеты из очереди.
+ */
+Worker::Worker(const CredentialTable& clients, Logger& logger,
+               size_t queue_capacity, ResultCache* cache, int auth_batch_us, bool issue_salt)
+    : clients_(clients), logger_(logger), cache_(cache),
+      auth_(auth_batch_us > 0 ? new AuthBatcher(std::chrono::microseconds(auth_batch_us)) : nullptr),
+      issue_salt_(issue_salt), inbox_(queue_capacity),
+      wake_fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)), listen_fd_(-1), stop_(false) {
+    if (wake_fd_ < 0) {
+        throw std::runtime_error("eventfd failed");
+    }
+    loop_.add(wake_fd_, EPOLLIN | EPOLLET);
+}
+
+/**
+ * @brief Деструктор
+ *
+ * @details
+ * Останавливает поток, закрывает сессии (их сокеты закрывает
+ * деструктор Session) и сокеты, оставшиеся в очереди.
+ */
+Worker::~Worker() {
+    stop();
+    sessions_.clear();
+
+    int client_socket;
+    while (inbox_.try_pop(client_socket)) {
+        close(client_socket);
+    }
+    close(wake_fd_);
+}
+
+/**
+ * @brief Регистрирует слушающий сокет
+ *
+ * @param listen_fd Неблокирующий слушающий сокет
+ * @param handoff Обработчик принятых сокетов
+ */
+void Worker::listen_on(int listen_fd, std::function<void(int)> handoff) {
+    listen_fd_ = listen_fd;
+    handoff_ = handoff;
+    loop_.add(listen_fd_, EPOLLIN | EPOLLET);
+}
+
+/**
+ * @brief Передает сокет в очередь
+ *
+ * @param client_socket Сокет клиента
+ * @param wait Ждать освобождения места в очереди
+ * @return bool true если сокет поставлен в очередь
+ */
+bool Worker::submit(int client_socket, bool wait) {
+    if (wait) {
+        inbox_.push(client_socket);
+    } else if (!inbox_.try_push(client_socket)) {
+        return false;
+    }
+
+    uint64_t one = 1;
+    ssize_t written = write(wake_fd_, &one, sizeof(one));
+    (void)written; // Переполнение счетчика eventfd невозможно на практике
+    return true;
+}
+
+/**
+ * @brief Событийный цикл
+ *
+ * @details
+ * Ожидает события и распределяет их:
+ * - слушающий сокет -> accept_pending()
+ * - eventfd -> drain_inbox()
+ * - сокеты клиентов -> Session::on_event(), завершившиеся сессии закрываются
+ *
+ * Сессии, исчерпавшие бюджет чтения, обслуживаются повторно до следующего
+ * ожидания: edge-triggered epoll не сообщит об их данных снова. Пока такие
+ * сессии есть, epoll только опрашивается (нулевой таймаут).
+ *
+ * С пакетной проверкой ожидание ограничено сроком самой старой
+ * проверки, а после обработки событий готовый пакет проверяется.
+ * Так же ограничено сроком записи буферизованного логгера шарда.
+ */
+void Worker::run() {
+    const int max_events = 256;
+    std::vector<struct epoll_event> events(max_events);
+
+    while (!stop_.load()) {
+        int timeout = auth_ ? auth_->timeout_ms() : -1;
+        int log_timeout = logger_.flush_timeout_ms();
+        if (log_timeout >= 0 && (timeout < 0 || log_timeout < timeout)) {
+            timeout = log_timeout;
+        }
+        if (!ready_.empty()) {
+            timeout = 0;
+        }
+        int ready = loop_.wait(events.data(), max_events, timeout);
+
+        for (int i = 0; i < ready; i++) {
+            int fd = events[i].data.fd;
+            if (fd == listen_fd_) {
+                accept_pending();
+                continue;
+            }
+            if (fd == wake_fd_) {
+                drain_inbox();
+                continue;
+            }
+
+            auto it = sessions_.find(fd);
+            if (it != sessions_.end()) {
+                settle(fd, *it->second, it->second->on_event(events[i].events));
+            }
+        }
+
+        // Сессия могла попасть в очередь и из события выше
+        std::sort(ready_.begin(), ready_.end());
+        ready_.erase(std::unique(ready_.begin(), ready_.end()), ready_.end());
+        serving_.swap(ready_);
+        for (int fd : serving_) {
+            auto it = sessions_.find(fd);
+            if (it != sessions_.end()) {
+                settle(fd, *it->second, it->second->on_event(EPOLLIN));
+            }
+        }
+        serving_.clear();
+
+        if (auth_ && auth_->due()) {
+            verify_batch();
+        }
+        if (logger_.flush_timeout_ms() == 0) {
+            logger_.flush();
+        }
+    }
+}
+
+/**
+ * @brief Запускает цикл в отдельном потоке
+ *
+ * @param cpu Номер ядра для закрепления потока (-1 - не закреплять)
+ */
+void Worker::start(int cpu) {
+    thread_ = std::thread([this, cpu]() {
+        if (cpu >= 0 && !pin_to_cpu(cpu)) {
+            logger_.log_error("Cannot pin worker to CPU " + std::to_string(cpu), false);
+        }
+        run();
+    });
+}
+
+/**
+ * @brief Останавливает цикл
+ *
+ * Устанавливает флаг остановки и будит цикл через eventfd.
+ */
+void Worker::stop() {
+    stop_.store(true);
+    uint64_t one = 1;
+    ssize_t written = write(wake_fd_, &one, sizeof(one));
+    (void)written;
+
+    if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+        thread_.join();
+    }
+}
+
+/**
+ * @brief Принимает все ожидающие подключения
+ *
+ * @details
+ * Для каждого подключения:
+ * 1. Получает IP-адрес клиента для логирования
+ * 2. Передает сокет обработчику handoff_ или создает сессию здесь же
+ *
+ * @note При ошибке accept логирует ошибку и продолжает работу
+ */
+void Worker::accept_pending() {
+    while (true) {
+        struct sockaddr_in address;
+        socklen_t addrlen = sizeof(address);
+
+        int client_socket = accept4(listen_fd_, (struct sockaddr*)&address, &addrlen,
+                                    SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_socket < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return;
+            }
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            logger_.log_error("Accept failed", false);
+            return;
+        }
+
+        char client_ip[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &address.sin_addr, client_ip, INET_ADDRSTRLEN);
+        logger_.log("New connection from " + std::string(client_ip));
+
+        if (handoff_) {
+            handoff_(client_socket);
+        } else {
+            adopt(client_socket);
+        }
+    }
+}
+
+/**
+ * @brief Забирает сокеты, переданные через submit()
+ */
+void Worker::drain_inbox() {
+    uint64_t counter;
+    ssize_t drained = read(wake_fd_, &counter, sizeof(counter));
+    (void)drained;
+
+    int client_socket;
+    while (inbox_.try_pop(client_socket)) {
+        adopt(client_socket);
+    }
+}
+
+/**
+ * @brief Создает сессию и регистрирует сокет в цикле
+ *
+ * @param client_socket Неблокирующий сокет клиента
+ *
+ * @note Если сессию не удалось создать (например, нет случайных байт для
+ *       соли) или зарегистрировать, ошибка логируется, а сокет закрывается
+ */
+void Worker::adopt(int client_socket) {
+    std::unique_ptr<Session> session;
+    try {
+        session.reset(new Session(client_socket, clients_, logger_, true, cache_, auth_.get(), issue_salt_));
+        loop_.add(client_socket, EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET);
+    } catch (const std::exception& e) {
+        logger_.log_error(e.what(), false);
+        if (!session) {
+            close(client_socket); // Иначе сокет закрывает деструктор Session
+        }
+        return;
+    }
+    sessions_[client_socket] = std::move(session);
+}
+
+/**
+ * @brief Закрывает сессию
+ *
+ * @param client_socket Сокет клиента
+ *
+ * @note Сокет закрывается деструктором Session
+ */
+void Worker::close_session(int client_socket) {
+    loop_.remove(client_socket);
+    sessions_.erase(client_socket);
+}
+
+/**
+ * @brief Закрывает завершенную сессию или ставит ее в очередь готовых
+ *
+ * @param client_socket Сокет клиента
+ * @param session Сессия этого сокета
+ * @param alive Результат Session::on_event() или Session::on_auth_verified()
+ */
+void Worker::settle(int client_socket, Session& session, bool alive) {
+    if (!alive) {
+        close_session(client_socket);
+    } else if (session.input_pending()) {
+        ready_.push_back(client_socket);
+    }
+}
+
+/**
+ * @brief Проверяет пакет аутентификаций
+ *
+ * @details
+ * Результаты передаются сессиям через Session::on_auth_verified();
+ * сессии, которым больше нечего делать, закрываются.
+ */
+void Worker::verify_batch() {
+    for (const AuthBatcher::Result& result : auth_->flush()) {
+        auto it = sessions_.find(result.client);
+        if (it != sessions_.end()) {
+            settle(result.client, *it->second, it->second->on_auth_verified(result.success));
+        }
+    }
+}
+
+/**
+ * @brief Закрепляет текущий поток за ядром
+ *
+ * @param cpu Номер ядра
+ * @return bool true при успехе
+ */
+bool pin_to_cpu(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
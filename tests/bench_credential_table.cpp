@@ -0,0 +1,105 @@
+/**
+ * @file bench_credential_table.cpp
+ * @brief Замер памяти и поиска в базе клиентов: CredentialTable против std::unordered_map
+ *
+ * Для базы из миллиона логинов вида userN с паролями по 8-12 символов
+ * сравнивает:
+ * - память кучи после загрузки (mallinfo2, включая служебные поля malloc);
+ * - среднее время поиска пароля по логину в случайном порядке.
+ *
+ * Запуск: make bench
+ */
+
+#include "../include/credential_table.h"
+#include <chrono>
+#include <cstdio>
+#include <malloc.h>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Занятая память кучи в байтах (включая большие блоки через mmap)
+ */
+size_t heap_used() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+/**
+ * @brief Среднее время вызова f на одну из count операций в наносекундах
+ */
+template <typename F>
+double measure(F f, size_t count) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / count;
+}
+
+} // namespace
+
+int main() {
+    const size_t count = 1000000;
+    const size_t lookups = 4000000;
+
+    std::mt19937_64 generator(46);
+    std::vector<std::string> logins(count);
+    std::vector<std::string> passwords(count);
+    for (size_t i = 0; i < count; i++) {
+        logins[i] = "user" + std::to_string(i);
+        passwords[i] = "P@ss" + std::to_string(generator() % 100000000);
+    }
+    std::vector<size_t> order(lookups);
+    for (size_t& index : order) {
+        index = generator() % count;
+    }
+
+    size_t before = heap_used();
+    std::unordered_map<std::string, std::string> map;
+    for (size_t i = 0; i < count; i++) {
+        map[logins[i]] = passwords[i];
+    }
+    size_t map_bytes = heap_used() - before;
+
+    before = heap_used();
+    CredentialTable table;
+    for (size_t i = 0; i < count; i++) {
+        table.insert(logins[i], passwords[i]);
+    }
+    table.shrink_to_fit();
+    size_t table_bytes = heap_used() - before;
+
+    size_t found = 0;
+    double map_ns = measure([&]() {
+        for (size_t index : order) {
+            auto it = map.find(logins[index]);
+            found += it->second.size();
+        }
+    }, lookups);
+    size_t expected = found;
+
+    found = 0;
+    double table_ns = measure([&]() {
+        CredentialTable::View password;
+        for (size_t index : order) {
+            table.find(logins[index], password);
+            found += password.size;
+        }
+    }, lookups);
+    if (found != expected) {
+        std::fprintf(stderr, "credential table returned wrong passwords\n");
+        return 1;
+    }
+
+    std::printf("%zu clients, %zu random lookups\n", count, lookups);
+    std::printf("%16s %12s %12s %12s\n", "store", "heap MB", "bytes/user", "ns/lookup");
+    std::printf("%16s %12.1f %12.1f %12.1f\n", "unordered_map", map_bytes / 1048576.0,
+                static_cast<double>(map_bytes) / count, map_ns);
+    std::printf("%16s %12.1f %12.1f %12.1f\n", "CredentialTable", table_bytes / 1048576.0,
+                static_cast<double>(table_bytes) / count, table_ns);
+    return 0;
+}
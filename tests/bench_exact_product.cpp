@@ -0,0 +1,71 @@
+/**
+ * @file bench_exact_product.cpp
+ * @brief Замер точного произведения против произведения с насыщением
+ *
+ * Для векторов из случайных int32 сравнивает:
+ * - saturating - VectorProcessor::calculate_product (результат int32);
+ * - exact      - VectorProcessor::exact_product (дерево произведений);
+ * - naive      - то же точное произведение последовательным умножением
+ *                накопленного числа на каждый элемент.
+ *
+ * Запуск: make bench
+ */
+
+#include "../include/vector_processor.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Среднее время вызова f в миллисекундах
+ */
+template <typename F>
+double measure(F f, int repeats) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) {
+        f();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats;
+}
+
+BigInteger naive_product(const std::vector<int32_t>& vector) {
+    BigInteger product(1);
+    for (int32_t value : vector) {
+        product = product * BigInteger(value);
+    }
+    return product;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 generator(46);
+    std::uniform_int_distribution<int32_t> distribution(2, INT32_MAX);
+
+    std::printf("%8s %10s %14s %12s %12s\n", "elements", "bits", "saturating,ms", "exact,ms", "naive,ms");
+    for (size_t size : {1000, 4000, 16000}) {
+        std::vector<int32_t> vector(size);
+        for (int32_t& value : vector) {
+            value = (generator() & 1) ? distribution(generator) : -distribution(generator);
+        }
+
+        int repeats = size <= 4000 ? 20 : 2;
+        volatile int32_t sink = 0;
+        double saturating = measure([&]() { sink = VectorProcessor::calculate_product(vector); }, repeats);
+        BigInteger exact;
+        double tree = measure([&]() { exact = VectorProcessor::exact_product(vector); }, repeats);
+        BigInteger naive;
+        double sequential = measure([&]() { naive = naive_product(vector); }, repeats);
+
+        if (exact != naive) {
+            std::fprintf(stderr, "exact product mismatch for %zu elements\n", size);
+            return 1;
+        }
+        std::printf("%8zu %10zu %14.4f %12.3f %12.3f\n", size, exact.bit_length(), saturating, tree, sequential);
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file bench_md5_batch.cpp
+ * @brief Замер пакетной проверки аутентификации против проверки по одной
+ *
+ * Для проверок вида MD5(соль из 16 hex + пароль) сравнивает:
+ * - per-call - Authenticator::md5_digest и digest_matches для каждой
+ *              проверки, как без пакетной стадии;
+ * - lanes N  - AuthBatcher с пакетами по N проверок (многобуферный MD5
+ *              шириной N), если процессор поддерживает эту ширину.
+ *
+ * Запуск: make bench
+ */
+
+#include "../include/auth.h"
+#include "../include/auth_batch.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Среднее время вызова f в миллисекундах
+ */
+template <typename F>
+double measure(F f, int repeats) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) {
+        f();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats;
+}
+
+} // namespace
+
+int main() {
+    const size_t count = 16384;
+    const int repeats = 20;
+    const std::string password = "P@ssl@rd";
+
+    std::mt19937_64 generator(46);
+    std::vector<std::string> salts(count);
+    std::vector<std::string> hashes(count);
+    for (size_t i = 0; i < count; i++) {
+        char salt[16];
+        unsigned char bytes[8];
+        uint64_t value = generator();
+        for (size_t k = 0; k < 8; k++) {
+            bytes[k] = static_cast<unsigned char>(value >> (8 * k));
+        }
+        Authenticator::hex_encode(bytes, 8, salt);
+        salts[i].assign(salt, 16);
+        hashes[i] = Authenticator::calculate_md5_hash(salts[i], password);
+    }
+
+    size_t accepted = 0;
+    double per_call = measure([&]() {
+        unsigned char digest[Authenticator::kDigestLength];
+        for (size_t i = 0; i < count; i++) {
+            Authenticator::md5_digest(salts[i], password, digest);
+            accepted += Authenticator::digest_matches(digest, hashes[i]);
+        }
+    }, repeats);
+    if (accepted != count * repeats) {
+        std::fprintf(stderr, "per-call verification rejected valid hashes\n");
+        return 1;
+    }
+
+    std::printf("%d checks per run, supported lanes: %zu\n", static_cast<int>(count), Md5Batch::lanes());
+    std::printf("%10s %12s %14s %9s\n", "mode", "ms", "checks/sec", "speedup");
+    std::printf("%10s %12.3f %14.0f %9s\n", "per-call", per_call, count / per_call * 1000, "1.00");
+
+    for (size_t lanes : {4, 8, 16}) {
+        if (lanes > Md5Batch::lanes()) {
+            continue;
+        }
+        AuthBatcher batcher(std::chrono::microseconds(1000), lanes);
+        accepted = 0;
+        double batched = measure([&]() {
+            for (size_t i = 0; i < count; i++) {
+                // Как в событийном цикле: пакет проверяется, когда заполнен
+                batcher.submit(static_cast<int>(i), salts[i], password, hashes[i]);
+                if (batcher.pending() >= batcher.batch()) {
+                    for (const AuthBatcher::Result& result : batcher.flush()) {
+                        accepted += result.success;
+                    }
+                }
+            }
+            for (const AuthBatcher::Result& result : batcher.flush()) {
+                accepted += result.success;
+            }
+        }, repeats);
+        if (accepted != count * repeats) {
+            std::fprintf(stderr, "batched verification rejected valid hashes (lanes %zu)\n", lanes);
+            return 1;
+        }
+        char mode[16];
+        std::snprintf(mode, sizeof(mode), "lanes %zu", lanes);
+        std::printf("%10s %12.3f %14.0f %9.2f\n", mode, batched, count / batched * 1000, per_call / batched);
+    }
+    return 0;
+}
@@ -1,8 +1,14 @@
 #include "../include/auth.h"
+#include "../include/auth_batch.h"
 #include <UnitTest++/UnitTest++.h>
 #include <unordered_map>
 #include <iostream>
 #include <cstring>
+#include <algorithm>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
 
 SUITE(AuthenticatorTest) {
     TEST(SaltGenerationLength) {
@@ -25,6 +31,42 @@ SUITE(AuthenticatorTest) {
         CHECK(salt1 != salt2);
     }
     
+    TEST(SaltsAcrossPoolRefillsAndThreads) {
+        // 512 солей на буфер: несколько пополнений в каждом потоке
+        std::vector<std::vector<std::string>> salts(4);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < salts.size(); t++) {
+            threads.push_back(std::thread([&salts, t]() {
+                for (int i = 0; i < 2000; i++) {
+                    salts[t].push_back(Authenticator::generate_salt_16());
+                }
+            }));
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        
+        std::set<std::string> unique;
+        for (const auto& list : salts) {
+            for (const std::string& salt : list) {
+                CHECK_EQUAL(16u, salt.size());
+                for (char c : salt) {
+                    CHECK(isdigit(c) || (c >= 'A' && c <= 'F'));
+                }
+                unique.insert(salt);
+            }
+        }
+        CHECK_EQUAL(8000u, unique.size());
+    }
+    
+    TEST(RandomBytesLongRequest) {
+        // Запрос длиннее буфера потока
+        std::vector<unsigned char> bytes(10000, 0);
+        Authenticator::random_bytes(bytes.data(), bytes.size());
+        size_t zeros = std::count(bytes.begin(), bytes.end(), 0);
+        CHECK(zeros < 200);
+    }
+    
     TEST(MD5HashCalculation) {
         std::string salt = "4F9C429F5C6884DB";
         std::string password = "testpass123";
@@ -53,7 +95,7 @@ SUITE(AuthenticatorTest) {
         
         std::string calculated_hash = Authenticator::calculate_md5_hash(salt, password);
         
-        bool result = Authenticator::verify_client("user1", calculated_hash, salt, clients);
+        bool result = Authenticator::verify_client("user1", calculated_hash, salt, CredentialTable(clients));
         CHECK(result);
     }
     
@@ -65,7 +107,7 @@ SUITE(AuthenticatorTest) {
         std::string salt = "4F9C429F5C6884DB";
         std::string wrong_hash = "1234567890ABCDEF1234567890ABCDEF";
         
-        bool result = Authenticator::verify_client("user1", wrong_hash, salt, clients);
+        bool result = Authenticator::verify_client("user1", wrong_hash, salt, CredentialTable(clients));
         CHECK(!result);
     }
     
@@ -77,9 +119,137 @@ SUITE(AuthenticatorTest) {
         std::string salt = "4F9C429F5C6884DB";
         std::string hash = "1234567890ABCDEF1234567890ABCDEF";
         
-        bool result = Authenticator::verify_client("nonexistent", hash, salt, clients);
+        bool result = Authenticator::verify_client("nonexistent", hash, salt, CredentialTable(clients));
         CHECK(!result);
     }
+    
+    TEST(DigestHexEncoding) {
+        unsigned char digest[Authenticator::kDigestLength];
+        Authenticator::md5_digest("", "", digest);
+        char hex[32];
+        Authenticator::hex_encode(digest, sizeof(digest), hex, false);
+        CHECK_EQUAL("d41d8cd98f00b204e9800998ecf8427e", std::string(hex, 32));
+        Authenticator::hex_encode(digest, sizeof(digest), hex);
+        CHECK_EQUAL("D41D8CD98F00B204E9800998ECF8427E", std::string(hex, 32));
+        
+        // Соль и пароль хэшируются как одна строка
+        CHECK_EQUAL(Authenticator::calculate_md5_hash("", "4F9C429F5C6884DBpass1"),
+                    Authenticator::calculate_md5_hash("4F9C429F5C6884DB", "pass1"));
+    }
+    
+    TEST(DigestMatchesIgnoresCase) {
+        unsigned char digest[Authenticator::kDigestLength];
+        Authenticator::md5_digest("", "", digest);
+        CHECK(Authenticator::digest_matches(digest, "d41d8cd98f00b204e9800998ecf8427e"));
+        CHECK(Authenticator::digest_matches(digest, "D41D8cd98F00B204E9800998ECF8427e"));
+        CHECK(!Authenticator::digest_matches(digest, "d41d8cd98f00b204e9800998ecf8427f"));
+        CHECK(!Authenticator::digest_matches(digest, "d41d8cd98f00b204e9800998ecf8427"));
+        CHECK(!Authenticator::digest_matches(digest, "g41d8cd98f00b204e9800998ecf8427e"));
+        // ':' следует сразу за '9', но hex-цифрой не является
+        CHECK(!Authenticator::digest_matches(digest, "d41d8cd98f00b204e9800998ecf842:e"));
+        
+        std::unordered_map<std::string, std::string> clients = {{"user1", "pass1"}};
+        std::string hash = Authenticator::calculate_md5_hash("4F9C429F5C6884DB", "pass1");
+        for (char& c : hash) {
+            c = static_cast<char>(tolower(c));
+        }
+        CHECK(Authenticator::verify_client("user1", hash, "4F9C429F5C6884DB", CredentialTable(clients)));
+    }
+}
+
+SUITE(AuthBatchTest) {
+    TEST(MultiBufferMatchesOpenSsl) {
+        // Длины вокруг границ блоков (55/56/64 байта), группы с остатком
+        std::mt19937 generator(46);
+        std::vector<std::string> salts(37);
+        std::vector<std::string> passwords(37);
+        std::vector<Md5Input> inputs(37);
+        for (size_t i = 0; i < inputs.size(); i++) {
+            salts[i] = std::string(i % 3 == 0 ? 0 : 16, static_cast<char>('A' + i % 6));
+            passwords[i].resize(i < 12 ? 36 + i : generator() % 200);
+            for (char& c : passwords[i]) {
+                c = static_cast<char>(generator());
+            }
+            inputs[i].salt = &salts[i];
+            inputs[i].password = passwords[i].data();
+            inputs[i].password_length = passwords[i].size();
+        }
+        
+        for (size_t lanes : {1, 4, 8, 16}) {
+            for (size_t count : {1, 2, 5, 16, 17, 37}) {
+                std::vector<unsigned char> digests(count * Authenticator::kDigestLength);
+                Md5Batch::digest(inputs.data(), count, digests.data(), lanes);
+                for (size_t i = 0; i < count; i++) {
+                    unsigned char expected[Authenticator::kDigestLength];
+                    Authenticator::md5_digest(salts[i], passwords[i], expected);
+                    CHECK(memcmp(expected, digests.data() + i * Authenticator::kDigestLength,
+                                 sizeof(expected)) == 0);
+                }
+            }
+        }
+    }
+    
+    TEST(BatcherDueWhenFull) {
+        AuthBatcher batcher(std::chrono::seconds(10), 2);
+        std::string salt = "4F9C429F5C6884DB";
+        std::string password = "pass1";
+        std::string good = Authenticator::calculate_md5_hash(salt, password);
+        std::string bad = "1234567890ABCDEF1234567890ABCDEF";
+        
+        CHECK(!batcher.due());
+        CHECK_EQUAL(-1, batcher.timeout_ms());
+        batcher.submit(7, salt, password, good);
+        CHECK(!batcher.due());
+        CHECK(batcher.timeout_ms() > 9000);
+        batcher.submit(9, salt, password, bad);
+        CHECK(batcher.due());
+        
+        const std::vector<AuthBatcher::Result>& results = batcher.flush();
+        CHECK_EQUAL(2u, results.size());
+        CHECK_EQUAL(7, results[0].client);
+        CHECK(results[0].success);
+        CHECK_EQUAL(9, results[1].client);
+        CHECK(!results[1].success);
+        CHECK_EQUAL(0u, batcher.pending());
+        CHECK_EQUAL(1u, batcher.batches());
+        CHECK_EQUAL(2u, batcher.verified());
+    }
+    
+    TEST(BatcherDueAfterDeadline) {
+        AuthBatcher batcher(std::chrono::microseconds(2000), 16);
+        std::string salt = "4F9C429F5C6884DB";
+        std::string password = "pass1";
+        std::string hash = Authenticator::calculate_md5_hash(salt, password);
+        
+        batcher.submit(3, salt, password, hash);
+        CHECK(batcher.timeout_ms() <= 2);
+        std::this_thread::sleep_for(std::chrono::milliseconds(3));
+        CHECK(batcher.due());
+        CHECK_EQUAL(0, batcher.timeout_ms());
+        
+        const std::vector<AuthBatcher::Result>& results = batcher.flush();
+        CHECK_EQUAL(1u, results.size());
+        CHECK(results[0].success);
+    }
+    
+    TEST(BatcherCancel) {
+        AuthBatcher batcher(std::chrono::seconds(10), 4);
+        std::string salt = "4F9C429F5C6884DB";
+        std::string password = "pass1";
+        std::string hash = Authenticator::calculate_md5_hash(salt, password);
+        
+        batcher.submit(1, salt, password, hash);
+        batcher.submit(2, salt, password, hash);
+        batcher.cancel(1);
+        batcher.cancel(5);
+        CHECK_EQUAL(1u, batcher.pending());
+        
+        const std::vector<AuthBatcher::Result>& results = batcher.flush();
+        CHECK_EQUAL(1u, results.size());
+        CHECK_EQUAL(2, results[0].client);
+        CHECK(results[0].success);
+        CHECK_EQUAL(-1, batcher.timeout_ms());
+    }
 }
 
 int main() {
@@ -0,0 +1,80 @@
+#include "../include/byte_buffer.h"
+#include <UnitTest++/UnitTest++.h>
+#include <string>
+#include <cstring>
+
+SUITE(ByteBufferTest) {
+    TEST(EmptyBuffer) {
+        ByteBuffer buffer;
+        CHECK(buffer.empty());
+        CHECK_EQUAL(0u, buffer.size());
+        CHECK_EQUAL(0u, buffer.writable());
+    }
+
+    TEST(PrepareAndCommit) {
+        ByteBuffer buffer;
+        char* area = buffer.prepare(10);
+        CHECK(buffer.writable() >= 10);
+        memcpy(area, "hello", 5);
+        buffer.commit(5);
+
+        CHECK_EQUAL(5u, buffer.size());
+        CHECK_EQUAL("hello", std::string(buffer.data(), buffer.size()));
+    }
+
+    TEST(ConsumeAdvancesWithoutCopy) {
+        ByteBuffer buffer;
+        buffer.append("abcdef", 6);
+        const char* before = buffer.data();
+
+        buffer.consume(2);
+        CHECK_EQUAL(4u, buffer.size());
+        CHECK(buffer.data() == before + 2);
+        CHECK_EQUAL("cdef", std::string(buffer.data(), buffer.size()));
+
+        buffer.consume(4);
+        CHECK(buffer.empty());
+    }
+
+    TEST(CompactsInsteadOfGrowing) {
+        ByteBuffer buffer;
+        buffer.prepare(1);
+        size_t capacity = buffer.writable();
+
+        std::string fill(capacity, 'x');
+        buffer.append(fill.data(), fill.size());
+        buffer.consume(capacity - 3);
+        CHECK_EQUAL(0u, buffer.writable());
+
+        // Для 3 оставшихся байт места достаточно после переноса в начало
+        buffer.prepare(capacity - 3);
+        CHECK_EQUAL(capacity - 3, buffer.writable());
+        CHECK_EQUAL("xxx", std::string(buffer.data(), buffer.size()));
+    }
+
+    TEST(GrowsKeepingData) {
+        ByteBuffer buffer;
+        buffer.append("0123456789", 10);
+        buffer.consume(4);
+
+        std::string big(100000, 'y');
+        buffer.append(big.data(), big.size());
+
+        CHECK_EQUAL(6u + big.size(), buffer.size());
+        CHECK_EQUAL("456789", std::string(buffer.data(), 6));
+        CHECK_EQUAL('y', buffer.data()[buffer.size() - 1]);
+    }
+
+    TEST(ClearResetsPositions) {
+        ByteBuffer buffer;
+        buffer.append("abc", 3);
+        buffer.clear();
+        CHECK(buffer.empty());
+        buffer.append("d", 1);
+        CHECK_EQUAL("d", std::string(buffer.data(), buffer.size()));
+    }
+}
+
+int main() {
+    return UnitTest::RunAllTests();
+}
@@ -65,6 +65,73 @@ SUITE(ConfigTest) {
         CHECK_EQUAL("./server.log", config.log_file);
     }
     
+    TEST(ThreadCount) {
+        char* argv1[] = {(char*)"program", nullptr};
+        ServerConfig config1 = ServerConfig::parse_args(1, argv1);
+        CHECK_EQUAL(0, config1.threads); // по умолчанию все в основном потоке
+        
+        char* argv2[] = {(char*)"program", (char*)"-t", (char*)"16", (char*)"-p", (char*)"44444", nullptr};
+        ServerConfig config2 = ServerConfig::parse_args(5, argv2);
+        CHECK_EQUAL(16, config2.threads);
+        CHECK_EQUAL(44444, config2.port);
+    }
+    
+    TEST(ShardCount) {
+        char* argv[] = {(char*)"program", (char*)"-s", (char*)"8", nullptr};
+        ServerConfig config = ServerConfig::parse_args(3, argv);
+        CHECK_EQUAL(8, config.shards);
+        CHECK_EQUAL(0, config.threads);
+    }
+    
+    TEST(IoBackend) {
+        char* argv[] = {(char*)"program", (char*)"-b", (char*)"uring", nullptr};
+        ServerConfig config = ServerConfig::parse_args(3, argv);
+        CHECK_EQUAL("uring", config.io_backend);
+        CHECK_EQUAL(33333, config.port);
+    }
+    
+    TEST(KernelOption) {
+        char* argv1[] = {(char*)"program", nullptr};
+        ServerConfig config1 = ServerConfig::parse_args(1, argv1);
+        CHECK_EQUAL("auto", config1.kernel);
+        
+        char* argv2[] = {(char*)"program", (char*)"-k", (char*)"scalar", nullptr};
+        ServerConfig config2 = ServerConfig::parse_args(3, argv2);
+        CHECK_EQUAL("scalar", config2.kernel);
+    }
+    
+    TEST(CacheOptions) {
+        char* argv1[] = {(char*)"program", nullptr};
+        ServerConfig config1 = ServerConfig::parse_args(1, argv1);
+        CHECK_EQUAL(0u, config1.cache_mb);
+        CHECK_EQUAL("worker", config1.cache_placement);
+        
+        char* argv2[] = {(char*)"program", (char*)"-r", (char*)"64", (char*)"-R", (char*)"global", nullptr};
+        ServerConfig config2 = ServerConfig::parse_args(5, argv2);
+        CHECK_EQUAL(64u, config2.cache_mb);
+        CHECK_EQUAL("global", config2.cache_placement);
+    }
+    
+    TEST(AuthBatchOption) {
+        char* argv1[] = {(char*)"program", nullptr};
+        ServerConfig config1 = ServerConfig::parse_args(1, argv1);
+        CHECK_EQUAL(0, config1.auth_batch_us);
+        
+        char* argv2[] = {(char*)"program", (char*)"-a", (char*)"500", nullptr};
+        ServerConfig config2 = ServerConfig::parse_args(3, argv2);
+        CHECK_EQUAL(500, config2.auth_batch_us);
+    }
+    
+    TEST(SaltSourceOption) {
+        char* argv1[] = {(char*)"program", nullptr};
+        ServerConfig config1 = ServerConfig::parse_args(1, argv1);
+        CHECK_EQUAL("client", config1.salt_source);
+        
+        char* argv2[] = {(char*)"program", (char*)"-S", (char*)"server", nullptr};
+        ServerConfig config2 = ServerConfig::parse_args(3, argv2);
+        CHECK_EQUAL("server", config2.salt_source);
+    }
+    
     TEST(HelpOption) {
         // Проверяем что help не вызывает ошибок
         // Временно подавляем вывод для этого теста
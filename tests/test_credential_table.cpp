@@ -0,0 +1,113 @@
+#include "../include/credential_table.h"
+#include <UnitTest++/UnitTest++.h>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+SUITE(CredentialTableTest) {
+    TEST(FindAfterInsert) {
+        CredentialTable table;
+        table.insert("user", "P@ssW0rd");
+        table.insert("alice", "P@ssl@rd");
+
+        CredentialTable::View password;
+        CHECK(table.find("user", password));
+        CHECK_EQUAL("P@ssW0rd", password.to_string());
+        CHECK(table.find("alice", password));
+        CHECK_EQUAL("P@ssl@rd", password.to_string());
+        CHECK(!table.find("bob", password));
+        CHECK(!table.find("use", password));
+        CHECK(!table.find("users", password));
+        CHECK_EQUAL(2u, table.size());
+    }
+
+    TEST(ReinsertReplacesPassword) {
+        CredentialTable table;
+        table.insert("user", "old");
+        table.insert("user", "new password");
+
+        CredentialTable::View password;
+        CHECK(table.find("user", password));
+        CHECK_EQUAL("new password", password.to_string());
+        CHECK_EQUAL(1u, table.size());
+    }
+
+    TEST(EmptyLoginAndPassword) {
+        CredentialTable table;
+        CredentialTable::View password;
+        CHECK(!table.find("", password));
+
+        table.insert("", "secret");
+        table.insert("guest", "");
+        CHECK(table.find("", password));
+        CHECK_EQUAL("secret", password.to_string());
+        CHECK(table.find("guest", password));
+        CHECK_EQUAL(0u, password.size);
+    }
+
+    TEST(GrowsToManyEntries) {
+        // Несколько удвоений слотов: каждая запись остается доступной
+        CredentialTable table;
+        const int count = 100000;
+        for (int i = 0; i < count; i++) {
+            table.insert("user" + std::to_string(i), "pw" + std::to_string(i * 7));
+        }
+        CHECK_EQUAL(static_cast<size_t>(count), table.size());
+
+        CredentialTable::View password;
+        for (int i = 0; i < count; i++) {
+            CHECK(table.find("user" + std::to_string(i), password));
+            CHECK_EQUAL("pw" + std::to_string(i * 7), password.to_string());
+        }
+        CHECK(!table.find("user" + std::to_string(count), password));
+
+        // Слоты по 8 байт и арена без отдельных строк в куче
+        table.shrink_to_fit();
+        CHECK(table.memory_bytes() < static_cast<size_t>(count) * 48);
+    }
+
+    TEST(BinaryPasswordLengths) {
+        // Длина хранится явно: пароли с нулевыми байтами не обрезаются
+        CredentialTable table;
+        std::string login("a\0b", 3);
+        std::string secret("x\0y\0z", 5);
+        table.insert(login, secret);
+
+        CredentialTable::View password;
+        CHECK(table.find(login, password));
+        CHECK_EQUAL(5u, password.size);
+        CHECK(password.to_string() == secret);
+        CHECK(!table.find("a", password));
+    }
+
+    TEST(RejectsTooLongFields) {
+        CredentialTable table;
+        std::string longest(CredentialTable::kMaxLength, 'x');
+        table.insert("user", longest);
+        CHECK_THROW(table.insert("user", longest + "x"), std::invalid_argument);
+        CHECK_THROW(table.insert(longest + "x", "pw"), std::invalid_argument);
+
+        CredentialTable::View password;
+        CHECK(table.find("user", password));
+        CHECK_EQUAL(CredentialTable::kMaxLength, password.size);
+    }
+
+    TEST(ConstructFromMap) {
+        std::unordered_map<std::string, std::string> clients = {
+            {"user1", "pass1"},
+            {"user2", "pass2"}
+        };
+        CredentialTable table(clients);
+
+        CredentialTable::View password;
+        CHECK_EQUAL(2u, table.size());
+        CHECK(table.find("user1", password));
+        CHECK_EQUAL("pass1", password.to_string());
+        CHECK(table.find("user2", password));
+        CHECK_EQUAL("pass2", password.to_string());
+    }
+}
+
+int main() {
+    return UnitTest::RunAllTests();
+}
@@ -0,0 +1,524 @@
+#include "../include/protocol_parser.h"
+#include <UnitTest++/UnitTest++.h>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <cstring>
+
+SUITE(ProtocolParserTest) {
+    const std::string kCredentials = "user1234567890ABCDEF0123456789abcdef0123456789abcdef";
+
+    // Двоичная часть запроса: количество векторов, затем размер и элементы каждого
+    std::string encode_vectors(const std::vector<std::vector<int32_t>>& vectors) {
+        std::string out;
+        uint32_t count = static_cast<uint32_t>(vectors.size());
+        out.append(reinterpret_cast<const char*>(&count), 4);
+        for (const auto& v : vectors) {
+            uint32_t size = static_cast<uint32_t>(v.size());
+            out.append(reinterpret_cast<const char*>(&size), 4);
+            if (!v.empty()) {
+                out.append(reinterpret_cast<const char*>(v.data()), v.size() * 4);
+            }
+        }
+        return out;
+    }
+
+    TEST(ParsesCredentials) {
+        ProtocolParser parser;
+        parser.feed(kCredentials.data(), kCredentials.size());
+
+        CHECK(parser.next() == ProtocolParser::Event::Credentials);
+        CHECK_EQUAL("user", parser.login());
+        CHECK_EQUAL("1234567890ABCDEF", parser.salt());
+        CHECK_EQUAL("0123456789abcdef0123456789abcdef", parser.hash());
+        CHECK_EQUAL(4u, parser.credentials_offset());
+        CHECK(parser.stage() == ProtocolParser::Stage::VectorCount);
+        CHECK(parser.next() == ProtocolParser::Event::NeedMore);
+    }
+
+    TEST(FullRequestInOneChunk) {
+        std::string request = kCredentials + encode_vectors({{2, 3}, {}, {-1, 5, 7}});
+        ProtocolParser parser;
+        parser.feed(request.data(), request.size());
+
+        CHECK(parser.next() == ProtocolParser::Event::Credentials);
+        CHECK(parser.next() == ProtocolParser::Event::VectorCount);
+        CHECK_EQUAL(3u, parser.vector_count());
+
+        CHECK(parser.next() == ProtocolParser::Event::VectorSize);
+        CHECK_EQUAL(2u, parser.vector_size());
+        CHECK(parser.next() == ProtocolParser::Event::Vector);
+        CHECK_EQUAL(2u, parser.vector().size());
+        CHECK_EQUAL(3, parser.vector()[1]);
+
+        CHECK(parser.next() == ProtocolParser::Event::VectorSize);
+        CHECK(parser.next() == ProtocolParser::Event::Vector);
+        CHECK(parser.vector().empty());
+
+        CHECK(parser.next() == ProtocolParser::Event::VectorSize);
+        CHECK(parser.next() == ProtocolParser::Event::Vector);
+        CHECK_EQUAL(-1, parser.vector()[0]);
+        CHECK_EQUAL(7, parser.vector()[2]);
+
+        CHECK(parser.finished());
+        CHECK_EQUAL(3u, parser.vectors_parsed());
+        CHECK(parser.next() == ProtocolParser::Event::NeedMore);
+    }
+
+    TEST(ByteByByte) {
+        std::string request = kCredentials + encode_vectors({{4, 5, 6}});
+        ProtocolParser parser;
+        std::vector<ProtocolParser::Event> events;
+
+        // Соль и хэш целиком попадают в буфер только с последним байтом учетных
+        // данных, поэтому первые попытки поиска не должны исчерпать лимит
+        size_t fed = kCredentials.size() - 1;
+        parser.feed(request.data(), fed);
+        while (fed < request.size()) {
+            parser.feed(request.data() + fed, 1);
+            fed++;
+            ProtocolParser::Event event;
+            while ((event = parser.next()) != ProtocolParser::Event::NeedMore) {
+                events.push_back(event);
+            }
+        }
+
+        CHECK_EQUAL(4u, events.size());
+        CHECK(events[0] == ProtocolParser::Event::Credentials);
+        CHECK(events[3] == ProtocolParser::Event::Vector);
+        CHECK_EQUAL(6, parser.vector()[2]);
+        CHECK(parser.finished());
+    }
+
+    TEST(VectorWaitsForAllElements) {
+        std::string request = kCredentials + encode_vectors({{1, 2, 3, 4}});
+        ProtocolParser parser;
+        parser.feed(request.data(), request.size() - 1);
+
+        CHECK(parser.next() == ProtocolParser::Event::Credentials);
+        CHECK(parser.next() == ProtocolParser::Event::VectorCount);
+        CHECK(parser.next() == ProtocolParser::Event::VectorSize);
+        CHECK(parser.next() == ProtocolParser::Event::NeedMore);
+        CHECK(parser.stage() == ProtocolParser::Stage::VectorData);
+
+        parser.feed(request.data() + request.size() - 1, 1);
+        CHECK(parser.next() == ProtocolParser::Event::Vector);
+        CHECK_EQUAL(4, parser.vector()[3]);
+    }
+
+    TEST(DirectReceiveIntoVector) {
+        std::vector<int32_t> elements = {10, -20, 30, -40};
+        std::string request = kCredentials + encode_vectors({elements, {7}});
+        size_t header = kCredentials.size() + 8;
+        ProtocolParser parser;
+
+        // Учетные данные, количество, размер и первый элемент - через буфер
+        parser.feed(request.data(), header + 4);
+        CHECK(parser.next() == ProtocolParser::Event::Credentials);
+        CHECK(parser.next() == ProtocolParser::Event::VectorCount);
+        CHECK(parser.next() == ProtocolParser::Event::VectorSize);
+        CHECK_EQUAL(0u, parser.direct_capacity());
+        CHECK(parser.next() == ProtocolParser::Event::NeedMore);
+
+        // Остальные элементы - прямо в память вектора
+        CHECK_EQUAL(12u, parser.direct_capacity());
+        memcpy(parser.direct_area(), request.data() + header + 4, 12);
+        parser.commit_direct(12);
+        CHECK_EQUAL(0u, parser.buffered());
+        CHECK(parser.next() == ProtocolParser::Event::Vector);
+        CHECK(parser.vector() == elements);
+
+        // Следующий вектор снова начинается с размера в буфере
+        CHECK_EQUAL(0u, parser.direct_capacity());
+        parser.feed(request.data() + header + 16, request.size() - header - 16);
+        CHECK(parser.next() == ProtocolParser::Event::VectorSize);
+        CHECK(parser.next() == ProtocolParser::Event::Vector);
+        CHECK_EQUAL(7, parser.vector()[0]);
+        CHECK(parser.finished());
+    }
+
+    TEST(StreamingVectorIsNotMaterialized) {
+        std::vector<int32_t> elements = {1, 2, 3, 4, 5, 6, 7};
+        std::string request = kCredentials + encode_vectors({elements, {9}});
+        size_t header = kCredentials.size() + 8;
+        ProtocolParser parser(4);
+
+        // Элементы приходят порциями, не кратными 4 байтам
+        parser.feed(request.data(), header + 6);
+        CHECK(parser.next() == ProtocolParser::Event::Credentials);
+        CHECK(parser.next() == ProtocolParser::Event::VectorCount);
+        CHECK(parser.next() == ProtocolParser::Event::VectorSize);
+        CHECK(parser.streaming());
+        CHECK_EQUAL(0u, parser.direct_capacity());
+
+        std::vector<int32_t> seen;
+        auto collect = [&]() {
+            ProtocolParser::Event event;
+            while ((event = parser.next()) == ProtocolParser::Event::Elements) {
+                for (size_t i = 0; i < parser.element_count(); i++) {
+                    int32_t value;
+                    memcpy(&value, parser.elements() + i * 4, 4);
+                    seen.push_back(value);
+                }
+            }
+            return event;
+        };
+
+        CHECK(collect() == ProtocolParser::Event::NeedMore);
+        CHECK_EQUAL(1u, seen.size());
+
+        parser.feed(request.data() + header + 6, 20);
+        CHECK(collect() == ProtocolParser::Event::NeedMore);
+        parser.feed(request.data() + header + 26, request.size() - header - 26);
+        CHECK(collect() == ProtocolParser::Event::Vector);
+        CHECK(seen == elements);
+        CHECK(parser.vector().empty());
+
+        // Короткий вектор снова материализуется
+        CHECK(parser.next() == ProtocolParser::Event::VectorSize);
+        CHECK(!parser.streaming());
+        CHECK(parser.next() == ProtocolParser::Event::Vector);
+        CHECK_EQUAL(9, parser.vector()[0]);
+        CHECK(parser.finished());
+    }
+
+    TEST(SkipRestOfStreamingVector) {
+        std::vector<int32_t> elements(100, 0);
+        std::string request = kCredentials + encode_vectors({elements, {9}});
+        size_t header = kCredentials.size() + 8;
+        ProtocolParser parser(4);
+
+        parser.feed(request.data(), header + 40);
+        CHECK(parser.next() == ProtocolParser::Event::Credentials);
+        CHECK(parser.next() == ProtocolParser::Event::VectorCount);
+        CHECK(parser.next() == ProtocolParser::Event::VectorSize);
+        CHECK(parser.next() == ProtocolParser::Event::Elements);
+        CHECK_EQUAL(10u, parser.element_count());
+
+        // Остаток вектора отбрасывается без порций Elements, в том числе
+        // байты, пришедшие не кратно размеру элемента
+        parser.skip_vector();
+        CHECK(parser.skipping());
+        CHECK(parser.next() == ProtocolParser::Event::NeedMore);
+        parser.feed(request.data() + header + 40, 201);
+        CHECK(parser.next() == ProtocolParser::Event::NeedMore);
+        CHECK_EQUAL(0u, parser.buffered());
+
+        parser.feed(request.data() + header + 241, request.size() - header - 241);
+        CHECK(parser.next() == ProtocolParser::Event::Vector);
+        CHECK(parser.next() == ProtocolParser::Event::VectorSize);
+        CHECK(!parser.skipping());
+        CHECK(parser.next() == ProtocolParser::Event::Vector);
+        CHECK_EQUAL(9, parser.vector()[0]);
+        CHECK(parser.finished());
+    }
+
+    TEST(ZeroVectorsFinishes) {
+        std::string request = kCredentials + encode_vectors({});
+        ProtocolParser parser;
+        parser.feed(request.data(), request.size());
+
+        CHECK(parser.next() == ProtocolParser::Event::Credentials);
+        CHECK(parser.next() == ProtocolParser::Event::VectorCount);
+        CHECK_EQUAL(0u, parser.vector_count());
+        CHECK(parser.finished());
+    }
+
+    TEST(BadCredentialsPastSearchLimit) {
+        std::string junk(60, 'x');
+        ProtocolParser parser;
+        parser.feed(junk.data(), junk.size());
+        CHECK(parser.next() == ProtocolParser::Event::NeedMore);
+        CHECK_EQUAL(60u, parser.scanned());
+
+        // Без новых данных ничего не просматривается повторно
+        CHECK(parser.next() == ProtocolParser::Event::NeedMore);
+        CHECK_EQUAL(60u, parser.scanned());
+
+        parser.feed(junk.data(), junk.size());
+        CHECK(parser.next() == ProtocolParser::Event::NeedMore);
+
+        // Серия hex, начавшаяся до ограничения, еще может оказаться солью
+        std::string hex(40, 'a');
+        parser.feed(hex.data(), hex.size());
+        CHECK(parser.next() == ProtocolParser::Event::NeedMore);
+        parser.feed(junk.data(), 1);
+        CHECK(parser.next() == ProtocolParser::Event::BadCredentials);
+        CHECK(parser.finished());
+    }
+
+    TEST(LongLoginAcrossChunks) {
+        // Логин длиннее 100 символов, соль+хэш приходят частями
+        std::string login(120, 'z');
+        std::string request = login + kCredentials.substr(4);
+        ProtocolParser parser;
+        parser.feed(request.data(), 110);
+        CHECK(parser.next() == ProtocolParser::Event::NeedMore);
+        parser.feed(request.data() + 110, 30);
+        CHECK(parser.next() == ProtocolParser::Event::NeedMore);
+
+        parser.feed(request.data() + 140, request.size() - 140);
+        CHECK(parser.next() == ProtocolParser::Event::Credentials);
+        CHECK_EQUAL(120u, parser.login().size());
+        CHECK_EQUAL("1234567890ABCDEF", parser.salt());
+    }
+
+    TEST(CredentialsFedByteByByte) {
+        // Логин оканчивается hex-цифрами: соль начинается с первой позиции,
+        // после которой идут 48 hex символов подряд
+        std::string request = "ab-cd:f00" + std::string(20, 'e') + "0123456789abcdef0123456789abcdef" + "!";
+        ProtocolParser parser;
+        size_t i = 0;
+        ProtocolParser::Event event = ProtocolParser::Event::NeedMore;
+        for (; i < request.size() && event == ProtocolParser::Event::NeedMore; i++) {
+            parser.feed(request.data() + i, 1);
+            event = parser.next();
+        }
+        CHECK(event == ProtocolParser::Event::Credentials);
+        CHECK_EQUAL(6u + 48u, i); // найдено на последнем символе хэша
+        CHECK_EQUAL("ab-cd:", parser.login());
+        CHECK_EQUAL("f00eeeeeeeeeeeee", parser.salt());
+        CHECK_EQUAL("eeeeeee0123456789abcdef012345678", parser.hash());
+    }
+
+    TEST(HexRunAcrossBlocks) {
+        // Серия пересекает границы блоков по 16 и 64 байта; символы вокруг
+        // диапазонов hex-цифр ('/', ':', '@', 'G', '`', 'g') ее прерывают
+        for (size_t offset = 0; offset < ProtocolParser::kCredentialsSearchLimit; offset++) {
+            std::string request;
+            const char separators[] = "/:@G`g";
+            for (size_t i = 0; i < offset; i++) {
+                request += (i % 7 == 6) ? separators[i % 6] : "0aF"[i % 3];
+            }
+            if (offset > 0) {
+                request[offset - 1] = 'G';
+            }
+            request += std::string(48, 'C') + "G";
+            ProtocolParser parser;
+            parser.feed(request.data(), request.size());
+            ProtocolParser::Event event = parser.next();
+            CHECK(event == ProtocolParser::Event::Credentials);
+            if (event == ProtocolParser::Event::Credentials) {
+                CHECK_EQUAL(offset, parser.credentials_offset());
+                CHECK_EQUAL(std::string(16, 'C'), parser.salt());
+            }
+        }
+    }
+
+    TEST(FinishDropsInput) {
+        ProtocolParser parser;
+        parser.feed(kCredentials.data(), kCredentials.size());
+        CHECK(parser.next() == ProtocolParser::Event::Credentials);
+
+        parser.finish();
+        CHECK(parser.finished());
+        parser.feed("abcd", 4);
+        CHECK_EQUAL(0u, parser.buffered());
+        CHECK(parser.next() == ProtocolParser::Event::NeedMore);
+    }
+
+    TEST(ExtendedHeaderDeclaresElementType) {
+        std::string request = kCredentials;
+        uint32_t marker = ProtocolParser::kExtendedHeader;
+        uint32_t count = 1, size = 3;
+        double values[] = {1.5, -2.0, 4.0};
+        request.append(reinterpret_cast<const char*>(&marker), 4);
+        request += std::string("\x03\0\0\0", 4); // Float64
+        request.append(reinterpret_cast<const char*>(&count), 4);
+        request.append(reinterpret_cast<const char*>(&size), 4);
+        request.append(reinterpret_cast<const char*>(values), sizeof(values));
+
+        ProtocolParser parser;
+        parser.feed(request.data(), kCredentials.size() + 11);
+        CHECK(parser.next() == ProtocolParser::Event::Credentials);
+        CHECK(parser.next() == ProtocolParser::Event::NeedMore); // заголовок неполный
+        CHECK_EQUAL(11u, parser.buffered());
+
+        // Элементы по 8 байт: неполный элемент не выдается
+        parser.feed(request.data() + kCredentials.size() + 11, 1 + 4 + 12);
+        CHECK(parser.next() == ProtocolParser::Event::VectorCount);
+        CHECK(parser.element_type() == ElementType::Float64);
+        CHECK_EQUAL(1u, parser.vector_count());
+        CHECK(parser.next() == ProtocolParser::Event::VectorSize);
+        CHECK(parser.streaming());
+        CHECK(parser.next() == ProtocolParser::Event::Elements);
+        CHECK_EQUAL(1u, parser.element_count());
+        CHECK(parser.next() == ProtocolParser::Event::NeedMore);
+
+        size_t fed = kCredentials.size() + 28;
+        parser.feed(request.data() + fed, request.size() - fed);
+        CHECK(parser.next() == ProtocolParser::Event::Elements);
+        CHECK_EQUAL(2u, parser.element_count());
+        double last;
+        memcpy(&last, parser.elements() + 8, 8);
+        CHECK_EQUAL(4.0, last);
+        CHECK(parser.next() == ProtocolParser::Event::Vector);
+        CHECK(parser.finished());
+    }
+
+    TEST(ExtendedHeaderRejectsUnknownType) {
+        std::string request = kCredentials;
+        uint32_t marker = ProtocolParser::kExtendedHeader;
+        request.append(reinterpret_cast<const char*>(&marker), 4);
+        request += std::string("\x09\0\0\0\1\0\0\0", 8);
+
+        ProtocolParser parser;
+        parser.feed(request.data(), request.size());
+        CHECK(parser.next() == ProtocolParser::Event::Credentials);
+        CHECK(parser.next() == ProtocolParser::Event::BadHeader);
+        CHECK(parser.finished());
+        CHECK(parser.element_type() == ElementType::Int32);
+    }
+
+    TEST(ExtendedHeaderDeclaresOperation) {
+        std::string request = kCredentials;
+        uint32_t marker = ProtocolParser::kExtendedHeader;
+        request.append(reinterpret_cast<const char*>(&marker), 4);
+        request += std::string("\0\x01\0\0\1\0\0\0\2\0\0\0", 12); // Int32, Sum, 1 вектор из 2
+        int32_t values[] = {5, 6};
+        request.append(reinterpret_cast<const char*>(values), sizeof(values));
+
+        // Даже короткий int32-вектор разбирается потоково
+        ProtocolParser parser;
+        parser.feed(request.data(), request.size());
+        CHECK(parser.next() == ProtocolParser::Event::Credentials);
+        CHECK(parser.next() == ProtocolParser::Event::VectorCount);
+        CHECK(parser.operation() == Operation::Sum);
+        CHECK(parser.next() == ProtocolParser::Event::VectorSize);
+        CHECK(parser.streaming());
+        CHECK(parser.next() == ProtocolParser::Event::Elements);
+        CHECK_EQUAL(2u, parser.element_count());
+
+        std::string bad = kCredentials;
+        bad.append(reinterpret_cast<const char*>(&marker), 4);
+        bad += std::string("\0\x08\0\0\1\0\0\0", 8);
+        ProtocolParser rejected;
+        rejected.feed(bad.data(), bad.size());
+        CHECK(rejected.next() == ProtocolParser::Event::Credentials);
+        CHECK(rejected.next() == ProtocolParser::Event::BadHeader);
+    }
+
+    TEST(ExactProductOnlyForIntegers) {
+        uint32_t marker = ProtocolParser::kExtendedHeader;
+        std::string request = kCredentials;
+        request.append(reinterpret_cast<const char*>(&marker), 4);
+        request += std::string("\x01\x07\0\0\1\0\0\0", 8); // Int64, ExactProduct
+        ProtocolParser parser;
+        parser.feed(request.data(), request.size());
+        CHECK(parser.next() == ProtocolParser::Event::Credentials);
+        CHECK(parser.next() == ProtocolParser::Event::VectorCount);
+        CHECK(parser.operation() == Operation::ExactProduct);
+
+        std::string floating = kCredentials;
+        floating.append(reinterpret_cast<const char*>(&marker), 4);
+        floating += std::string("\x03\x07\0\0\1\0\0\0", 8); // Float64, ExactProduct
+        ProtocolParser rejected;
+        rejected.feed(floating.data(), floating.size());
+        CHECK(rejected.next() == ProtocolParser::Event::Credentials);
+        CHECK(rejected.next() == ProtocolParser::Event::BadHeader);
+    }
+
+    TEST(DotRejectsOddVectorSize) {
+        uint32_t marker = ProtocolParser::kExtendedHeader;
+        std::string request = kCredentials;
+        request.append(reinterpret_cast<const char*>(&marker), 4);
+        request += std::string("\0\x06\0\0\2\0\0\0\2\0\0\0", 12); // Int32, Dot, 2 вектора, первый из 2
+        int32_t pair[] = {3, 4};
+        request.append(reinterpret_cast<const char*>(pair), sizeof(pair));
+        request += std::string("\3\0\0\0", 4); // Второй из 3 - непарный элемент
+        int32_t odd[] = {1, 2, 5};
+        request.append(reinterpret_cast<const char*>(odd), sizeof(odd));
+
+        ProtocolParser parser;
+        parser.feed(request.data(), request.size());
+        CHECK(parser.next() == ProtocolParser::Event::Credentials);
+        CHECK(parser.next() == ProtocolParser::Event::VectorCount);
+        CHECK(parser.next() == ProtocolParser::Event::VectorSize);
+        CHECK(parser.next() == ProtocolParser::Event::Elements);
+        CHECK(parser.next() == ProtocolParser::Event::Vector);
+        CHECK(parser.next() == ProtocolParser::Event::BadHeader);
+        CHECK_EQUAL(3u, parser.vector_size());
+        CHECK(parser.finished());
+    }
+
+    TEST(ExactProductRejectsTooLongVector) {
+        // Int64: не больше kMaxExactProductBytes / 8 элементов
+        uint32_t marker = ProtocolParser::kExtendedHeader;
+        uint32_t longest = static_cast<uint32_t>(ProtocolParser::kMaxExactProductBytes / 8);
+        std::string request = kCredentials;
+        request.append(reinterpret_cast<const char*>(&marker), 4);
+        request += std::string("\x01\x07\0\0\2\0\0\0", 8); // Int64, ExactProduct, 2 вектора
+        request.append(reinterpret_cast<const char*>(&longest), 4);
+
+        ProtocolParser parser;
+        parser.feed(request.data(), request.size());
+        CHECK(parser.next() == ProtocolParser::Event::Credentials);
+        CHECK(parser.next() == ProtocolParser::Event::VectorCount);
+        CHECK(parser.next() == ProtocolParser::Event::VectorSize);
+        CHECK(!parser.finished());
+
+        uint32_t too_long = longest + 1;
+        std::string rejected_request = kCredentials;
+        rejected_request.append(reinterpret_cast<const char*>(&marker), 4);
+        rejected_request += std::string("\x01\x07\0\0\2\0\0\0", 8);
+        rejected_request.append(reinterpret_cast<const char*>(&too_long), 4);
+
+        ProtocolParser rejected;
+        rejected.feed(rejected_request.data(), rejected_request.size());
+        CHECK(rejected.next() == ProtocolParser::Event::Credentials);
+        CHECK(rejected.next() == ProtocolParser::Event::VectorCount);
+        CHECK(rejected.next() == ProtocolParser::Event::BadHeader);
+        CHECK(rejected.finished());
+    }
+
+    TEST(VectorKeyAccumulatedWhileReceiving) {
+        // Вектор длиннее 64-байтного блока хэша, порции не кратны блоку
+        std::vector<int32_t> elements(300);
+        for (size_t i = 0; i < elements.size(); i++) {
+            elements[i] = static_cast<int32_t>(i * 7919 - 1000);
+        }
+        std::string request = kCredentials + encode_vectors({elements, {1, 2}});
+        size_t header = kCredentials.size() + 8;
+        ProtocolParser parser(UINT32_MAX, 100);
+
+        // Часть элементов через буфер разными порциями, остаток - прямо в вектор
+        parser.feed(request.data(), header + 37);
+        CHECK(parser.next() == ProtocolParser::Event::Credentials);
+        CHECK(parser.next() == ProtocolParser::Event::VectorCount);
+        CHECK(parser.next() == ProtocolParser::Event::VectorSize);
+        CHECK(parser.next() == ProtocolParser::Event::NeedMore);
+        parser.feed(request.data() + header + 37, 101);
+        CHECK(parser.next() == ProtocolParser::Event::NeedMore);
+        size_t received = 138;
+        while (parser.direct_capacity() > 0) {
+            size_t length = std::min<size_t>(parser.direct_capacity(), 77);
+            memcpy(parser.direct_area(), request.data() + header + received, length);
+            parser.commit_direct(length);
+            received += length;
+        }
+        CHECK(parser.next() == ProtocolParser::Event::Vector);
+
+        ResultCache::Key key;
+        CHECK(parser.vector_key(key));
+        CHECK(key == ResultCache::make_key(elements.data(), elements.size()));
+
+        // Вектор короче порога ключа не получает
+        parser.feed(request.data() + header + received, request.size() - header - received);
+        CHECK(parser.next() == ProtocolParser::Event::VectorSize);
+        CHECK(parser.next() == ProtocolParser::Event::Vector);
+        CHECK(!parser.vector_key(key));
+
+        // Без порога ключи не вычисляются
+        ProtocolParser plain;
+        plain.feed(request.data(), request.size());
+        CHECK(plain.next() == ProtocolParser::Event::Credentials);
+        CHECK(plain.next() == ProtocolParser::Event::VectorCount);
+        CHECK(plain.next() == ProtocolParser::Event::VectorSize);
+        CHECK(plain.next() == ProtocolParser::Event::Vector);
+        CHECK(!plain.vector_key(key));
+    }
+}
+
+int main() {
+    return UnitTest::RunAllTests();
+}
@@ -0,0 +1,134 @@
+#include "../include/result_cache.h"
+#include <UnitTest++/UnitTest++.h>
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+SUITE(ResultCacheTest) {
+    ResultCache::Key key_of(const std::vector<int32_t>& vector) {
+        return ResultCache::make_key(vector.data(), vector.size());
+    }
+
+    TEST(HitAfterInsert) {
+        ResultCache cache(1 << 20);
+        std::vector<int32_t> vector = {1, 2, 3, 4};
+        int32_t result = 0;
+
+        CHECK(!cache.find(key_of(vector), result));
+        cache.insert(key_of(vector), 24);
+        CHECK(cache.find(key_of(vector), result));
+        CHECK_EQUAL(24, result);
+
+        ResultCache::Stats stats = cache.stats();
+        CHECK_EQUAL(1u, stats.hits);
+        CHECK_EQUAL(1u, stats.misses);
+        CHECK_EQUAL(1u, stats.entries);
+    }
+
+    TEST(KeyDependsOnContentAndLength) {
+        std::vector<int32_t> a = {1, 2, 3, 4};
+        std::vector<int32_t> b = {1, 2, 3, 5};
+        std::vector<int32_t> zeros(16, 0);
+        CHECK(key_of(a) == key_of(std::vector<int32_t>(a)));
+        CHECK(!(key_of(a) == key_of(b)));
+        CHECK(!(ResultCache::make_key(zeros.data(), 15) == ResultCache::make_key(zeros.data(), 16)));
+
+        // Каждый байт на любой позиции (блоки по 64, 16 и хвост) меняет хэш
+        std::vector<char> bytes(200, 0);
+        uint64_t base = ResultCache::hash(bytes.data(), bytes.size());
+        for (size_t i = 0; i < bytes.size(); i++) {
+            bytes[i] = 1;
+            CHECK(ResultCache::hash(bytes.data(), bytes.size()) != base);
+            bytes[i] = 0;
+        }
+    }
+
+    TEST(KeyHasherMatchesMakeKey) {
+        // Любое разбиение на порции дает тот же ключ, что и весь вектор сразу
+        std::vector<int32_t> vector(131);
+        for (size_t i = 0; i < vector.size(); i++) {
+            vector[i] = static_cast<int32_t>(i * 2654435761u);
+        }
+        const char* bytes = reinterpret_cast<const char*>(vector.data());
+        size_t length = vector.size() * 4;
+        for (size_t count : {0u, 3u, 16u, 17u, 64u, 131u}) {
+            ResultCache::Key expected = ResultCache::make_key(vector.data(), count);
+            for (size_t step : {1u, 4u, 13u, 64u, 100u, 1000u}) {
+                ResultCache::KeyHasher hasher;
+                for (size_t i = 0; i < count * 4; i += step) {
+                    hasher.update(bytes + i, std::min(step, count * 4 - i));
+                }
+                CHECK(hasher.key() == expected);
+            }
+        }
+
+        ResultCache::KeyHasher hasher;
+        hasher.update(bytes, length);
+        hasher.reset();
+        CHECK(hasher.key() == ResultCache::make_key(vector.data(), 0));
+    }
+
+    TEST(EvictsLeastRecentlyUsed) {
+        // Три записи в одном шарде
+        ResultCache cache(3 * ResultCache::kEntryBytes);
+        std::vector<std::vector<int32_t>> vectors = {{1}, {2}, {3}, {4}};
+        for (int i = 0; i < 3; i++) {
+            cache.insert(key_of(vectors[i]), i);
+        }
+        int32_t result;
+        CHECK(cache.find(key_of(vectors[0]), result)); // {1} становится недавним
+
+        cache.insert(key_of(vectors[3]), 3);           // вытесняет {2}
+        CHECK(!cache.find(key_of(vectors[1]), result));
+        CHECK(cache.find(key_of(vectors[0]), result));
+        CHECK(cache.find(key_of(vectors[2]), result));
+        CHECK(cache.find(key_of(vectors[3]), result));
+        CHECK_EQUAL(1u, cache.stats().evictions);
+        CHECK_EQUAL(3u, cache.stats().entries);
+    }
+
+    TEST(MemoryCapSplitBetweenShards) {
+        ResultCache cache(64 * ResultCache::kEntryBytes, 5);
+        CHECK_EQUAL(8u, cache.shard_count());
+        for (int32_t i = 0; i < 1000; i++) {
+            std::vector<int32_t> vector = {i};
+            cache.insert(key_of(vector), i);
+        }
+        CHECK(cache.stats().entries <= 64u);
+        CHECK_EQUAL(1000u - cache.stats().entries, cache.stats().evictions);
+    }
+
+    TEST(ConcurrentAccess) {
+        ResultCache cache(1 << 20, 16);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++) {
+            threads.push_back(std::thread([&cache]() {
+                for (int32_t i = 0; i < 2000; i++) {
+                    std::vector<int32_t> vector = {i % 300};
+                    int32_t result;
+                    if (!cache.find(key_of(vector), result)) {
+                        cache.insert(key_of(vector), i % 300);
+                    } else if (result != i % 300) {
+                        cache.insert(key_of(vector), -1); // сюда не попадаем
+                    }
+                }
+            }));
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        ResultCache::Stats stats = cache.stats();
+        CHECK_EQUAL(8000u, stats.hits + stats.misses);
+        CHECK_EQUAL(300u, stats.entries);
+        for (int32_t i = 0; i < 300; i++) {
+            int32_t result = -2;
+            CHECK(cache.find(key_of(std::vector<int32_t>{i}), result));
+            CHECK_EQUAL(i, result);
+        }
+    }
+}
+
+int main() {
+    return UnitTest::RunAllTests();
+}
@@ -10,6 +10,14 @@
 #include <stdexcept>
 #include <algorithm>
 #include <cstdlib>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../include/session.h"
+#include "../include/credential_table.h"
+#include "../include/logger.h"
+#include "../include/auth.h"
 
 SUITE(SessionFunctionsTest) {
     // Функция расчета MD5 (копия из session.cpp)
@@ -260,6 +268,85 @@ SUITE(SessionFunctionsTest) {
     }
 }
 
+SUITE(SessionEventTest) {
+    // Запрос: аутентификация и count векторов из одного элемента int32
+    std::string one_element_request(uint32_t count) {
+        std::string salt = "1234567890ABCDEF";
+        std::string request = "user" + salt + Authenticator::calculate_md5_hash(salt, "P@ssW0rd");
+        request.append(reinterpret_cast<const char*>(&count), 4);
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t size = 1;
+            int32_t value = static_cast<int32_t>(i % 1000) - 500;
+            request.append(reinterpret_cast<const char*>(&size), 4);
+            request.append(reinterpret_cast<const char*>(&value), 4);
+        }
+        return request;
+    }
+
+    TEST(StopsReadingWhilePeerDoesNotRead) {
+        int fds[2];
+        CHECK_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+        fcntl(fds[0], F_SETFL, O_NONBLOCK);
+        fcntl(fds[1], F_SETFL, O_NONBLOCK);
+
+        CredentialTable clients;
+        clients.insert("user", "P@ssW0rd");
+        Logger logger("/dev/null", true);
+        Session session(fds[0], clients, logger);
+
+        const uint32_t count = 1 << 18;
+        std::string request = one_element_request(count);
+
+        // Клиент только пишет: сервер должен перестать читать, а не копить результаты
+        size_t written = 0;
+        for (int idle = 0; idle < 3 && written < request.size();) {
+            ssize_t n = send(fds[1], request.data() + written, request.size() - written, MSG_NOSIGNAL);
+            if (n > 0) {
+                written += static_cast<size_t>(n);
+                idle = 0;
+            } else {
+                idle++;
+            }
+            CHECK(session.on_event(EPOLLIN));
+        }
+        CHECK(written < request.size());
+
+        // Клиент читает: EPOLLOUT возобновляет разбор, все результаты доходят
+        std::string output;
+        char chunk[65536];
+        bool alive = true;
+        for (int idle = 0; idle < 100 && (alive || output.size() < 3 + 4 * count);) {
+            bool progress = false;
+            ssize_t n;
+            while ((n = recv(fds[1], chunk, sizeof(chunk), 0)) > 0) {
+                output.append(chunk, static_cast<size_t>(n));
+                progress = true;
+            }
+            if (written < request.size()) {
+                n = send(fds[1], request.data() + written, request.size() - written, MSG_NOSIGNAL);
+                if (n > 0) {
+                    written += static_cast<size_t>(n);
+                    progress = true;
+                }
+            }
+            alive = session.on_event(EPOLLIN | EPOLLOUT);
+            idle = progress ? 0 : idle + 1;
+        }
+        close(fds[1]);
+
+        CHECK(!alive);
+        CHECK_EQUAL(3 + 4 * static_cast<size_t>(count), output.size());
+        CHECK_EQUAL("OK\n", output.substr(0, 3));
+        bool all_match = output.size() == 3 + 4 * static_cast<size_t>(count);
+        for (uint32_t i = 0; all_match && i < count; i++) {
+            int32_t value;
+            std::memcpy(&value, output.data() + 3 + 4 * i, 4);
+            all_match = value == static_cast<int32_t>(i % 1000) - 500;
+        }
+        CHECK(all_match);
+    }
+}
+
 int main() {
     return UnitTest::RunAllTests();
 }
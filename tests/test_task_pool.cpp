@@ -0,0 +1,82 @@
+#include "../include/task_pool.h"
+#include <UnitTest++/UnitTest++.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+SUITE(TaskPoolTest) {
+    TEST(RunsEveryTaskOnce) {
+        TaskPool pool(3);
+        CHECK_EQUAL(3u, pool.size());
+
+        std::vector<int> hits(200, 0);
+        std::vector<std::function<void()>> tasks;
+        for (size_t i = 0; i < hits.size(); i++) {
+            tasks.push_back([&hits, i]() { hits[i]++; });
+        }
+        pool.run(tasks);
+
+        for (int hit : hits) {
+            CHECK_EQUAL(1, hit);
+        }
+    }
+
+    TEST(WithoutThreadsRunsInCaller) {
+        TaskPool pool(0);
+        std::thread::id caller = std::this_thread::get_id();
+        bool same_thread = false;
+        std::vector<std::function<void()>> tasks;
+        tasks.push_back([&]() { same_thread = std::this_thread::get_id() == caller; });
+        pool.run(tasks);
+        CHECK(same_thread);
+    }
+
+    TEST(EmptyBatch) {
+        TaskPool pool(2);
+        pool.run(std::vector<std::function<void()>>());
+        CHECK_EQUAL(2u, pool.size());
+    }
+
+    TEST(ConcurrentCallers) {
+        // Несколько потоков одновременно отдают пакеты в один пул
+        TaskPool pool(2);
+        std::atomic<int> total(0);
+        std::vector<std::thread> callers;
+        for (int c = 0; c < 4; c++) {
+            callers.push_back(std::thread([&pool, &total]() {
+                for (int round = 0; round < 50; round++) {
+                    std::vector<std::function<void()>> tasks(7, [&total]() { total++; });
+                    pool.run(tasks);
+                }
+            }));
+        }
+        for (auto& caller : callers) {
+            caller.join();
+        }
+        CHECK_EQUAL(4 * 50 * 7, total.load());
+    }
+
+    TEST(UnevenTasksAreStolen) {
+        // Все длинные задачи попадают в одну очередь; остальные потоки
+        // должны перехватить их, а не простаивать
+        TaskPool pool(3);
+        std::atomic<int> done(0);
+        std::vector<std::function<void()>> tasks;
+        for (int i = 0; i < 40; i++) {
+            tasks.push_back([&done, i]() {
+                if (i % 4 == 0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                }
+                done++;
+            });
+        }
+        pool.run(tasks);
+        CHECK_EQUAL(40, done.load());
+    }
+}
+
+int main() {
+    return UnitTest::RunAllTests();
+}
@@ -30,6 +30,32 @@ SUITE(TypesTest) {
         CHECK_EQUAL(0x7F, bytes[3]);
     }
     
+    TEST(SpanView) {
+        Vector vec = {10, 20, 30, 40};
+        Span<const int32_t> view(vec);
+        
+        CHECK_EQUAL(4u, view.size());
+        CHECK(view.data() == vec.data());
+        CHECK_EQUAL(30, view[2]);
+        
+        Span<const int32_t> middle = view.subspan(1, 2);
+        CHECK_EQUAL(2u, middle.size());
+        CHECK_EQUAL(20, middle[0]);
+        
+        int32_t sum = 0;
+        for (int32_t value : middle) {
+            sum += value;
+        }
+        CHECK_EQUAL(50, sum);
+        
+        // Изменяемое представление пишет прямо в вектор
+        Span<int32_t> writable(vec);
+        writable[0] = 7;
+        CHECK_EQUAL(7, vec[0]);
+        
+        CHECK(Span<const int32_t>().empty());
+    }
+    
     TEST(TypeAliasesCompatibility) {
         std::vector<int32_t> std_vec = {1, 2, 3};
         Vector alias_vec = std_vec;
@@ -1,8 +1,14 @@
 #include "../include/vector_processor.h"
+#include "../include/task_pool.h"
 #include <UnitTest++/UnitTest++.h>
 #include <vector>
 #include <climits>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <cstdlib>
 #include <iostream>
+#include <stdexcept>
 
 SUITE(VectorProcessorTest) {
     TEST(EmptyVector) {
@@ -159,6 +165,575 @@ SUITE(VectorProcessorTest) {
         CHECK_EQUAL(-6, results[1]);  // -1*-2*-3 = -6
         CHECK_EQUAL(6000, results[2]); // 10*20*30 = 6000
     }
+    
+    TEST(AccumulatorMatchesCalculateProduct) {
+        std::vector<std::vector<int32_t>> cases = {
+            {}, {0}, {7}, {2, 3, 4}, {-2, 3, -4}, {INT32_MAX, 2},
+            {INT32_MAX, INT32_MAX, INT32_MAX}, {INT32_MIN, INT32_MAX, 3},
+            {INT32_MAX, INT32_MAX, INT32_MAX, 0}, {0, INT32_MAX, INT32_MAX, INT32_MAX},
+            {-1, -1, -1}, {65536, 65536, 65536, -65536}
+        };
+        
+        for (const auto& vec : cases) {
+            // Поэлементно
+            ProductAccumulator single;
+            for (int32_t value : vec) {
+                single.add(value);
+            }
+            CHECK_EQUAL(VectorProcessor::calculate_product(vec), single.result());
+            
+            // Порциями из сырых байт
+            ProductAccumulator chunked;
+            const char* bytes = reinterpret_cast<const char*>(vec.data());
+            size_t half = vec.size() / 2;
+            chunked.add(bytes, half);
+            chunked.add(bytes + half * 4, vec.size() - half);
+            CHECK_EQUAL(VectorProcessor::calculate_product(vec), chunked.result());
+        }
+    }
+    
+    // Эталон: исходная поэлементная реализация
+    int32_t reference_product(const std::vector<int32_t>& vector) {
+        if (vector.empty()) {
+            return 0;
+        }
+        int64_t product = 1;
+        for (int32_t val : vector) {
+            int64_t val64 = static_cast<int64_t>(val);
+            if (val64 != 0 && llabs(product) > INT64_MAX / llabs(val64)) {
+                return ((product > 0 && val64 > 0) || (product < 0 && val64 < 0)) ? INT32_MAX : INT32_MIN;
+            }
+            product *= val64;
+        }
+        if (product > INT32_MAX) return INT32_MAX;
+        if (product < INT32_MIN) return INT32_MIN;
+        return static_cast<int32_t>(product);
+    }
+    
+    TEST(AllKernelsMatchReference) {
+        const int32_t pool[] = {1, -1, 1, -1, 0, 2, -3, 7, 65536, -65536, INT32_MAX, INT32_MIN};
+        std::vector<std::vector<int32_t>> cases;
+        unsigned seed = 12345;
+        for (int n = 0; n < 400; n++) {
+            seed = seed * 1103515245u + 12345u;
+            size_t size = (seed >> 8) % 70;
+            // Половина векторов - в основном из {-1, 1}, чтобы задействовать быстрый путь
+            size_t range = (n % 2 == 0) ? 4 : sizeof(pool) / sizeof(pool[0]);
+            std::vector<int32_t> vec;
+            for (size_t i = 0; i < size; i++) {
+                seed = seed * 1103515245u + 12345u;
+                vec.push_back(pool[(seed >> 8) % range]);
+            }
+            if (n % 7 == 0 && !vec.empty()) {
+                vec[(seed >> 4) % vec.size()] = 0;
+            }
+            cases.push_back(vec);
+        }
+        
+        for (const ProductKernel* kernel : VectorProcessor::kernels()) {
+            if (!kernel->supported()) {
+                continue;
+            }
+            CHECK(VectorProcessor::select_kernel(kernel->name));
+            for (const auto& vec : cases) {
+                CHECK_EQUAL(reference_product(vec), VectorProcessor::calculate_product(vec));
+            }
+        }
+        CHECK(VectorProcessor::select_kernel("auto"));
+        CHECK(!VectorProcessor::select_kernel("no-such-kernel"));
+    }
+
+    TEST(KernelsAtOverflowBoundary) {
+        // Длинные векторы из степеней двойки: произведение подходит вплотную
+        // к 2^63, переполнение случается в середине блока или на его границе
+        std::vector<std::vector<int32_t>> cases;
+        for (int shift = 0; shift < 40; shift++) {
+            std::vector<int32_t> vec(shift, 1);
+            for (int k = 0; k < 62; k++) {
+                vec.push_back(k % 5 == 0 ? -2 : 2);
+            }
+            cases.push_back(vec);                       // 2^62: без переполнения
+            vec.push_back(shift % 2 ? 2 : -2);
+            cases.push_back(vec);                       // 2^63: переполнение
+            vec.push_back(0);
+            cases.push_back(vec);                       // 0 после переполнения не важен
+            vec.insert(vec.begin() + shift, 0);
+            cases.push_back(vec);                       // 0 до переполнения
+
+            std::vector<int32_t> mixed(shift + 3, -1);
+            for (int k = 0; k < 30; k++) {
+                mixed.push_back(k % 3 == 0 ? 3 : (k % 3 == 1 ? -5 : 7));
+            }
+            mixed.push_back(INT32_MIN);
+            cases.push_back(mixed);
+        }
+
+        for (const ProductKernel* kernel : VectorProcessor::kernels()) {
+            if (!kernel->supported()) {
+                continue;
+            }
+            CHECK(VectorProcessor::select_kernel(kernel->name));
+            for (const auto& vec : cases) {
+                CHECK_EQUAL(reference_product(vec), VectorProcessor::calculate_product(vec));
+            }
+        }
+        CHECK(VectorProcessor::select_kernel("auto"));
+    }
+    
+    TEST(ParallelMultiplyKeepsOrder) {
+        // Векторы очень разной длины, чтобы диапазоны задач были неравными
+        std::vector<std::vector<int32_t>> vectors;
+        unsigned seed = 777;
+        for (int n = 0; n < 3000; n++) {
+            seed = seed * 1103515245u + 12345u;
+            size_t size = (n % 100 == 0) ? 5000 : (seed >> 8) % 20;
+            std::vector<int32_t> vec(size, 1);
+            for (size_t i = 0; i < size && i < 3; i++) {
+                vec[i] = static_cast<int32_t>((seed >> (4 + i)) % 7) - 3;
+            }
+            vectors.push_back(vec);
+        }
+        
+        TaskPool pool(3);
+        size_t previous = VectorProcessor::parallel_threshold();
+        VectorProcessor::set_parallel_threshold(0);
+        auto parallel = VectorProcessor::multiply_vectors(vectors, pool);
+        VectorProcessor::set_parallel_threshold(previous);
+        
+        CHECK_EQUAL(vectors.size(), parallel.size());
+        for (size_t i = 0; i < vectors.size(); i++) {
+            CHECK_EQUAL(reference_product(vectors[i]), parallel[i]);
+        }
+        CHECK(VectorProcessor::multiply_vectors(std::vector<std::vector<int32_t>>(), pool).empty());
+    }
+    
+    TEST(ParallelReductionMatchesSerial) {
+        // Части по несколько элементов: 0, переполнение и знак попадают
+        // в разные части и на их границы
+        std::vector<std::vector<int32_t>> cases;
+        unsigned seed = 4242;
+        const int32_t pool_values[] = {1, -1, 1, -1, 2, -2, 3, 0, 65536, -65536, INT32_MAX, INT32_MIN};
+        for (int n = 0; n < 300; n++) {
+            seed = seed * 1103515245u + 12345u;
+            size_t size = (seed >> 8) % 200;
+            size_t range = (n % 3 == 0) ? 12 : (n % 3 == 1 ? 7 : 4);
+            std::vector<int32_t> vec;
+            for (size_t i = 0; i < size; i++) {
+                seed = seed * 1103515245u + 12345u;
+                vec.push_back(pool_values[(seed >> 8) % range]);
+            }
+            cases.push_back(vec);
+        }
+        std::vector<int32_t> powers(100, -1);
+        for (int k = 0; k < 62; k++) {
+            powers[k + 20] = 2;
+        }
+        cases.push_back(powers);                      // 2^62 на границе 2^63
+        powers[90] = -2;
+        cases.push_back(powers);                      // переполнение в последней части
+        
+        TaskPool pool(3);
+        size_t previous = VectorProcessor::reduction_threshold();
+        VectorProcessor::set_reduction_threshold(0);
+        for (const auto& vec : cases) {
+            CHECK_EQUAL(reference_product(vec), VectorProcessor::calculate_product(vec.data(), vec.size(), pool));
+        }
+        VectorProcessor::set_reduction_threshold(previous);
+    }
+    
+    TEST(FlatBatchMatchesNestedVectors) {
+        std::vector<std::vector<int32_t>> vectors = {
+            {1, 2, 3}, {}, {-4, 5}, {INT32_MAX, 2}, {0, 7}, {INT32_MIN, -1, -1}, {9}
+        };
+        std::vector<int32_t> elements;
+        std::vector<size_t> offsets = {0};
+        for (const auto& vec : vectors) {
+            elements.insert(elements.end(), vec.begin(), vec.end());
+            offsets.push_back(elements.size());
+        }
+        
+        std::vector<int32_t> results(vectors.size(), -999);
+        VectorProcessor::multiply_vectors(elements, offsets, results);
+        CHECK(results == VectorProcessor::multiply_vectors(vectors));
+        
+        // Параллельно на пуле
+        TaskPool pool(2);
+        size_t previous = VectorProcessor::parallel_threshold();
+        VectorProcessor::set_parallel_threshold(0);
+        std::vector<int32_t> parallel(vectors.size(), -999);
+        VectorProcessor::multiply_vectors(elements, offsets, parallel, pool);
+        VectorProcessor::set_parallel_threshold(previous);
+        CHECK(parallel == results);
+        
+        // Пустой пакет
+        std::vector<int32_t> none;
+        VectorProcessor::multiply_vectors(Span<const int32_t>(), std::vector<size_t>(1, 0), none);
+    }
+    
+    TEST(FlatBatchRejectsBadOffsets) {
+        std::vector<int32_t> elements = {1, 2, 3};
+        std::vector<int32_t> results(2);
+        
+        std::vector<size_t> short_offsets = {0, 3};
+        CHECK_THROW(VectorProcessor::multiply_vectors(elements, short_offsets, results), std::invalid_argument);
+        
+        std::vector<size_t> decreasing = {0, 2, 1};
+        CHECK_THROW(VectorProcessor::multiply_vectors(elements, decreasing, results), std::invalid_argument);
+        
+        std::vector<size_t> past_end = {0, 2, 4};
+        CHECK_THROW(VectorProcessor::multiply_vectors(elements, past_end, results), std::invalid_argument);
+    }
+    
+    TEST(AccumulatorDecided) {
+        ProductAccumulator acc;
+        CHECK(!acc.decided());
+        acc.add(5);
+        CHECK(!acc.decided());
+        acc.add(0);
+        CHECK(acc.decided());
+        
+        // Переполнение: дальнейшие элементы, включая 0, не меняют результат
+        std::vector<int32_t> vec = {INT32_MAX, INT32_MAX, -INT32_MAX, 0, -1};
+        acc.reset();
+        acc.add(reinterpret_cast<const char*>(vec.data()), 3);
+        CHECK(acc.decided());
+        acc.add(reinterpret_cast<const char*>(vec.data() + 3), 2);
+        CHECK_EQUAL(INT32_MIN, acc.result());
+        CHECK_EQUAL(INT32_MIN, VectorProcessor::calculate_product(vec));
+    }
+    
+    TEST(AccumulatorReset) {
+        ProductAccumulator acc;
+        acc.add(INT32_MAX);
+        acc.add(INT32_MAX);
+        acc.add(INT32_MAX);
+        CHECK_EQUAL(INT32_MAX, acc.result());
+        
+        acc.reset();
+        CHECK_EQUAL(0, acc.result());
+        acc.add(-3);
+        CHECK_EQUAL(-3, acc.result());
+    }
+
+    TEST(Int64Accumulator) {
+        BasicProductAccumulator<int64_t> acc;
+        CHECK_EQUAL(0, acc.result());
+        
+        // Блоки под бюджетом и поэлементная проверка дают одно и то же
+        std::vector<int64_t> vec = {3000000000LL, -7, 11, 5, 2, 2, 1, -1, 9};
+        acc.add(reinterpret_cast<const char*>(vec.data()), vec.size());
+        BasicProductAccumulator<int64_t> single;
+        for (int64_t v : vec) single.add(v);
+        CHECK_EQUAL(3000000000LL * -7 * 11 * 5 * 2 * 2 * -9, acc.result());
+        CHECK_EQUAL(acc.result(), single.result());
+        
+        // Превышение int64 без переполнения __int128 - насыщение при приведении
+        std::vector<int64_t> big = {INT64_MAX, 4, -1, 1};
+        acc.reset();
+        acc.add(reinterpret_cast<const char*>(big.data()), big.size());
+        CHECK_EQUAL(INT64_MIN, acc.result());
+        CHECK(!acc.decided());
+        
+        // Переполнение __int128: знак по сомножителям, остаток игнорируется
+        std::vector<int64_t> huge = {INT64_MAX, INT64_MAX, -INT64_MAX, 0, 5};
+        acc.reset();
+        acc.add(reinterpret_cast<const char*>(huge.data()), huge.size());
+        CHECK(acc.decided());
+        CHECK_EQUAL(INT64_MIN, acc.result());
+        CHECK_EQUAL(INT64_MIN, BasicVectorProcessor<int64_t>::calculate_product(huge));
+        
+        std::vector<int64_t> zero = {5, 0, INT64_MAX, INT64_MAX, INT64_MAX};
+        CHECK_EQUAL(0, BasicVectorProcessor<int64_t>::calculate_product(zero));
+    }
+    
+    TEST(FloatingAccumulatorDoesNotDependOnChunks) {
+        std::vector<double> vec;
+        for (int i = 0; i < 1000; i++) {
+            vec.push_back(1.0 + (i % 17) * 0.013 - (i % 5) * 0.007);
+        }
+        double whole = BasicVectorProcessor<double>::calculate_product(vec);
+        
+        // Порции произвольной длины и по одному элементу - те же дорожки
+        BasicProductAccumulator<double> chunks;
+        const char* bytes = reinterpret_cast<const char*>(vec.data());
+        size_t sizes[] = {3, 1, 16, 7, 100, 873};
+        size_t offset = 0;
+        for (size_t size : sizes) {
+            chunks.add(bytes + offset * 8, size);
+            offset += size;
+        }
+        BasicProductAccumulator<double> single;
+        for (double v : vec) single.add(v);
+        CHECK_EQUAL(whole, chunks.result());
+        CHECK_EQUAL(whole, single.result());
+        CHECK_CLOSE(1.0, whole / [&]() { double p = 1; for (double v : vec) p *= v; return p; }(), 1e-12);
+        
+        std::vector<float> floats(vec.begin(), vec.end());
+        BasicProductAccumulator<float> float_single;
+        for (float v : floats) float_single.add(v);
+        CHECK_EQUAL(float_single.result(), BasicVectorProcessor<float>::calculate_product(floats));
+        CHECK_EQUAL(0.0f, BasicVectorProcessor<float>::calculate_product(std::vector<float>()));
+    }
+    
+    TEST(FloatingAccumulatorDecidedOnNaN) {
+        BasicProductAccumulator<double> acc;
+        acc.add(0.0);
+        CHECK(!acc.decided()); // 0 * inf = NaN
+        for (int i = 0; i < 7; i++) acc.add(1.0);
+        acc.add(1.0 / 0.0);    // в ту же дорожку, что и 0
+        CHECK(acc.decided());
+        acc.add(2.0);
+        CHECK(acc.result() != acc.result());
+    }
+    
+    TEST(TypedAccumulator) {
+        TypedReduction acc(Operation::Product, ElementType::Int64);
+        int64_t values[] = {-4, 1LL << 40};
+        acc.add(reinterpret_cast<const char*>(values), 2);
+        std::string out;
+        acc.result(out);
+        CHECK_EQUAL(8u, out.size());
+        int64_t product;
+        memcpy(&product, out.data(), 8);
+        CHECK_EQUAL(-(1LL << 42), product);
+        CHECK_EQUAL(std::to_string(product), acc.result_string());
+        
+        acc.reset(Operation::Product, ElementType::Float32);
+        float floats[] = {1.5f, -2.0f};
+        acc.add(reinterpret_cast<const char*>(floats), 2);
+        out.clear();
+        acc.result(out);
+        CHECK_EQUAL(4u, out.size());
+        float result;
+        memcpy(&result, out.data(), 4);
+        CHECK_EQUAL(-3.0f, result);
+        
+        acc.reset(Operation::Product, ElementType::Int32);
+        int32_t ints[] = {INT32_MAX, 2};
+        acc.add(reinterpret_cast<const char*>(ints), 2);
+        out.clear();
+        acc.result(out);
+        CHECK_EQUAL(4u, out.size());
+        int32_t clamped;
+        memcpy(&clamped, out.data(), 4);
+        CHECK_EQUAL(INT32_MAX, clamped);
+    }
+
+    ElementType type_of(int32_t) { return ElementType::Int32; }
+    ElementType type_of(int64_t) { return ElementType::Int64; }
+    ElementType type_of(float) { return ElementType::Float32; }
+    ElementType type_of(double) { return ElementType::Float64; }
+    
+    // Результат операции над всем вектором, переданным одной порцией
+    template <typename T>
+    T reduce(Operation operation, const std::vector<T>& vec) {
+        TypedReduction reduction(operation, type_of(T()));
+        reduction.add(reinterpret_cast<const char*>(vec.data()), vec.size());
+        std::string out;
+        reduction.result(out);
+        CHECK_EQUAL(sizeof(T), out.size());
+        T value;
+        memcpy(&value, out.data(), sizeof(T));
+        return value;
+    }
+    
+    TEST(RegistryHasEveryOperationForEveryType) {
+        CHECK_EQUAL(30u, VectorProcessor::reductions().size());
+        for (int op = 0; op <= static_cast<int>(Operation::Dot); op++) {
+            for (int type = 0; type <= static_cast<int>(ElementType::Float64); type++) {
+                const ReductionKernel* kernel = VectorProcessor::reduction(static_cast<Operation>(op),
+                                                                           static_cast<ElementType>(type));
+                CHECK(kernel != nullptr);
+            }
+        }
+        CHECK(VectorProcessor::reduction(Operation::ExactProduct, ElementType::Int64) != nullptr);
+        CHECK_THROW(TypedReduction(Operation::ExactProduct, ElementType::Float32), std::invalid_argument);
+        CHECK_THROW(TypedReduction(static_cast<Operation>(8)), std::invalid_argument);
+    }
+    
+    TEST(IntegerOperations) {
+        std::vector<int32_t> vec = {3, -7, 2, INT32_MIN, 5};
+        CHECK_EQUAL(reference_product(vec), reduce(Operation::Product, vec));
+        CHECK_EQUAL(INT32_MIN + 3, reduce(Operation::Sum, vec));
+        CHECK_EQUAL(INT32_MIN, reduce(Operation::Sum, std::vector<int32_t>{INT32_MIN, -1})); // насыщение
+        CHECK_EQUAL(INT32_MIN, reduce(Operation::Min, vec));
+        CHECK_EQUAL(5, reduce(Operation::Max, vec));
+        CHECK_EQUAL(INT32_MAX, reduce(Operation::L1, vec));
+        CHECK_EQUAL(INT32_MAX, reduce(Operation::L2, vec));
+        
+        std::vector<int32_t> small = {3, -4, 12};
+        CHECK_EQUAL(11, reduce(Operation::Sum, small));
+        CHECK_EQUAL(19, reduce(Operation::L1, small));
+        CHECK_EQUAL(13, reduce(Operation::L2, small));
+        CHECK_EQUAL(-12, reduce(Operation::Dot, small)); // 3 * -4, 12 без пары
+        CHECK_EQUAL(0, reduce(Operation::Max, std::vector<int32_t>()));
+        
+        // Сумма int64 за пределами int64, но в пределах __int128
+        std::vector<int64_t> wide = {INT64_MAX, INT64_MAX, -INT64_MAX};
+        CHECK_EQUAL(INT64_MAX, reduce(Operation::Sum, wide));
+        
+        // Скалярное произведение int64 переполняет __int128: насыщение точное
+        std::vector<int64_t> pairs;
+        for (int i = 0; i < 6; i++) {
+            pairs.push_back(INT64_MIN);
+            pairs.push_back(INT64_MIN);
+        }
+        CHECK_EQUAL(INT64_MAX, reduce(Operation::Dot, pairs));
+        pairs.push_back(-1);
+        pairs.push_back(INT64_MAX);
+        CHECK_EQUAL(INT64_MAX, reduce(Operation::Dot, pairs));
+    }
+    
+    TEST(FloatingOperations) {
+        std::vector<double> vec = {1.5, -2.0, 4.0, 0.25};
+        CHECK_EQUAL(3.75, reduce(Operation::Sum, vec));
+        CHECK_EQUAL(-2.0, reduce(Operation::Min, vec));
+        CHECK_EQUAL(4.0, reduce(Operation::Max, vec));
+        CHECK_EQUAL(7.75, reduce(Operation::L1, vec));
+        CHECK_CLOSE(std::sqrt(1.5 * 1.5 + 4.0 + 16.0 + 0.0625), reduce(Operation::L2, vec), 1e-12);
+        CHECK_EQUAL(-3.0 + 1.0, reduce(Operation::Dot, vec));
+        
+        std::vector<float> floats = {1.0f, std::nanf(""), -3.0f};
+        float max = reduce(Operation::Max, floats);
+        CHECK(max != max);
+    }
+    
+    TEST(DotPairsSplitBetweenChunks) {
+        std::vector<int32_t> vec = {2, 3, 4, 5, 6, 7, 8};
+        TypedReduction reduction(Operation::Dot, ElementType::Int32);
+        const char* bytes = reinterpret_cast<const char*>(vec.data());
+        reduction.add(bytes, 1);
+        reduction.add(bytes + 4, 2);
+        reduction.add(bytes + 12, 4);
+        CHECK_EQUAL("68", reduction.result_string()); // 6 + 20 + 42
+        
+        reduction.reset();
+        CHECK_EQUAL("0", reduction.result_string());
+    }
+    
+    TEST(ExtremeDecidedAtLimit) {
+        TypedReduction reduction(Operation::Min, ElementType::Int32);
+        int32_t values[] = {5, INT32_MIN};
+        reduction.add(reinterpret_cast<const char*>(values), 1);
+        CHECK(!reduction.decided());
+        reduction.add(reinterpret_cast<const char*>(values + 1), 1);
+        CHECK(reduction.decided());
+    }
+    
+    // Произведение в столбик по одному элементу - эталон для точного произведения
+    BigInteger naive_product(const std::vector<int64_t>& vec) {
+        BigInteger product(1);
+        for (int64_t value : vec) {
+            product = product * BigInteger(value);
+        }
+        return vec.empty() ? BigInteger() : product;
+    }
+    
+    TEST(BigIntegerBasics) {
+        CHECK_EQUAL("0", BigInteger().to_string());
+        CHECK_EQUAL("-9223372036854775808", BigInteger(INT64_MIN).to_string());
+        BigInteger big = BigInteger(INT64_MIN) * BigInteger(INT64_MIN);  // 2^126
+        CHECK_EQUAL("85070591730234615865843651857942052864", big.to_string());
+        CHECK_EQUAL(127u, big.bit_length());
+        CHECK_EQUAL("10000000000000000000", (BigInteger(100000) * BigInteger(100000000000000LL)).to_string());
+        CHECK(BigInteger(0) == BigInteger() * BigInteger(-5));
+        
+        std::string encoded;
+        BigInteger(-0x1234).encode(encoded);
+        CHECK_EQUAL(std::string("\xfe\xff\xff\xff\x34\x12", 6), encoded);
+        encoded.clear();
+        BigInteger().encode(encoded);
+        CHECK_EQUAL(std::string("\0\0\0\0", 4), encoded);
+    }
+    
+    TEST(KaratsubaMatchesSchoolbook) {
+        // (2^(64n) - 1)^2 = 2^(128n) - 2^(64n+1) + 1: все переносы максимальны
+        for (size_t n : {BigInteger::kKaratsubaThreshold - 1, BigInteger::kKaratsubaThreshold,
+                         3 * BigInteger::kKaratsubaThreshold + 5}) {
+            BigInteger ones(BigInteger::Limbs(n, ~0ULL), false);
+            BigInteger::Limbs expected(2 * n, 0);
+            expected[0] = 1;
+            for (size_t i = n; i < 2 * n; i++) {
+                expected[i] = ~0ULL;
+            }
+            expected[n] = ~0ULL - 1;
+            CHECK(BigInteger(expected, false) == ones * ones);
+        }
+        
+        // Нулевые младшие половины: (2^(64n))^2 = 2^(128n)
+        for (size_t n : {BigInteger::kKaratsubaThreshold, 5 * BigInteger::kKaratsubaThreshold}) {
+            BigInteger::Limbs power(n + 1, 0), square(2 * n + 1, 0);
+            power[n] = 1;
+            square[2 * n] = 1;
+            CHECK(BigInteger(square, false) == BigInteger(power, false) * BigInteger(power, false));
+        }
+        
+        // Случайные сомножители, в том числе сильно неравной длины
+        srand(46);
+        for (size_t na : {40, 97, 300}) {
+            for (size_t nb : {33, 64, 150}) {
+                BigInteger::Limbs a(na), b(nb);
+                for (uint64_t& limb : a) limb = (static_cast<uint64_t>(rand()) << 33) ^ rand();
+                for (uint64_t& limb : b) limb = (static_cast<uint64_t>(rand()) << 33) ^ rand();
+                BigInteger product = BigInteger(a, true) * BigInteger(b, false);
+                // Эталон: b умножается на a по одному слову
+                BigInteger reference;
+                for (size_t i = na; i > 0; i--) {
+                    BigInteger::Limbs shifted = reference.limbs();
+                    shifted.insert(shifted.begin(), 0);
+                    BigInteger::Limbs term = (BigInteger(b, false) *
+                                              BigInteger(BigInteger::Limbs(1, a[i - 1]), false)).limbs();
+                    BigInteger::Limbs sum(std::max(shifted.size(), term.size()) + 1, 0);
+                    unsigned __int128 carry = 0;
+                    for (size_t k = 0; k < sum.size(); k++) {
+                        carry += k < shifted.size() ? shifted[k] : 0;
+                        carry += k < term.size() ? term[k] : 0;
+                        sum[k] = static_cast<uint64_t>(carry);
+                        carry >>= 64;
+                    }
+                    reference = BigInteger(sum, false);
+                }
+                CHECK(BigInteger(reference.limbs(), true) == product);
+            }
+        }
+    }
+    
+    TEST(ExactProduct) {
+        std::vector<int32_t> vec = {INT32_MIN, INT32_MIN, -3};
+        BigInteger exact = VectorProcessor::exact_product(vec);
+        CHECK_EQUAL("-13835058055282163712", exact.to_string()); // -3 * 2^62
+        CHECK_EQUAL(0u, VectorProcessor::exact_product(std::vector<int32_t>()).bit_length());
+        
+        std::vector<int64_t> wide;
+        srand(7);
+        for (int i = 0; i < 3000; i++) {
+            int64_t value = (static_cast<int64_t>(rand()) << 31) ^ rand();
+            wide.push_back(i % 3 == 0 ? -value - 1 : value + 1);
+        }
+        wide.push_back(INT64_MIN);
+        BigInteger expected = naive_product(wide);
+        
+        // Тот же результат при любом разбиении на порции
+        TypedReduction reduction(Operation::ExactProduct, ElementType::Int64);
+        const char* bytes = reinterpret_cast<const char*>(wide.data());
+        for (size_t i = 0; i < wide.size(); i += 7) {
+            reduction.add(bytes + i * 8, std::min<size_t>(7, wide.size() - i));
+        }
+        std::string out;
+        reduction.result(out);
+        std::string encoded;
+        expected.encode(encoded);
+        CHECK(encoded == out);
+        CHECK(expected.negative());
+        CHECK_EQUAL(std::to_string(expected.bit_length()) + "-bit integer", reduction.result_string());
+        
+        // Ноль решает результат
+        reduction.reset();
+        int64_t zero[] = {5, 0, 7};
+        reduction.add(reinterpret_cast<const char*>(zero), 3);
+        CHECK(reduction.decided());
+        CHECK_EQUAL("0", reduction.result_string());
+    }
 }
 
 int main() {